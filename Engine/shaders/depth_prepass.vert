@@ -0,0 +1,23 @@
+#version 450
+
+layout(binding = 0) uniform UBO {
+    mat4 view;
+    mat4 proj;
+    vec4 cameraPos;
+} ubo;
+
+// Dados por draw (ver PushConstants em VulkanTypes.h)
+layout(push_constant) uniform PushConstants {
+    mat4 model;
+    uint materialIndex;
+} pc;
+
+// Stream só de posições (MeshComponent::positionBuffer)
+layout(location = 0) in vec3 inPosition;
+
+invariant gl_Position;
+
+void main() {
+    vec4 worldPos = pc.model * vec4(inPosition, 1.0);
+    gl_Position = ubo.proj * ubo.view * worldPos;
+}
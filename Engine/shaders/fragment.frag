@@ -30,7 +30,9 @@ layout(location = 0) out vec4 outColor;
 const float PI = 3.14159265359;
 
 vec3 getNormalFromMap() {
-    vec3 tangentNormal = texture(normalMap, fragTexCoord).xyz * 2.0 - 1.0;
+    // Só XY: mapas em BC5 não têm o canal B, Z sai do comprimento unitário
+    vec2 normalXY = texture(normalMap, fragTexCoord).xy * 2.0 - 1.0;
+    vec3 tangentNormal = vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0)));
     vec3 Q1 = dFdx(fragPos);
     vec3 Q2 = dFdy(fragPos);
     vec2 st1 = dFdx(fragTexCoord);
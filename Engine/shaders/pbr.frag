@@ -16,28 +16,41 @@ struct Light {
     int type;  // 0 = Directional, 1 = Point, 2 = Spot
 };
 
-struct Material {
-    vec4 color;
-    float metallic;
-    float roughness;
-    float ambientOcclusion;
-    float padding;
-};
-
 layout(binding = 0) uniform UBO {
-    mat4 model;
     mat4 view;
     mat4 proj;
-    vec3 cameraPos;
-    Material material;
+    vec4 cameraPos;
 } ubo;
 
+layout(push_constant) uniform PushConstants {
+    mat4 model;
+    uint materialIndex;
+} pc;
+
 layout(binding = 1) uniform sampler2D albedoMap;
 layout(binding = 2) uniform sampler2D normalMap;
 layout(binding = 3) uniform sampler2D metallicRoughnessMap;
 layout(binding = 4) uniform sampler2D aoMap;
 layout(binding = 5) uniform sampler2D emissiveMap;
 
+// Mesmo layout do GPUMaterial em VulkanTypes.h (os índices de textura só valem no bindless)
+struct Material {
+    vec4 baseColorFactor;
+    vec4 emissiveFactor;
+    float metallicFactor;
+    float roughnessFactor;
+    uint albedoTexture;
+    uint normalTexture;
+    uint metallicRoughnessTexture;
+    uint aoTexture;
+    uint emissiveTexture;
+    uint padding;
+};
+
+layout(std430, binding = 7) readonly buffer Materials {
+    Material materials[];
+};
+
 layout(std430, binding = 6) uniform LightUBO {
     Light lights[4];  // Suporte para até 4 luzes
     int numLights;
@@ -53,7 +66,9 @@ const float PI = 3.14159265359;
 
 // Funções existentes mantidas
 vec3 getNormalFromMap() {
-    vec3 tangentNormal = texture(normalMap, fragTexCoord).xyz * 2.0 - 1.0;
+    // Só XY: mapas em BC5 não têm o canal B, Z sai do comprimento unitário
+    vec2 normalXY = texture(normalMap, fragTexCoord).xy * 2.0 - 1.0;
+    vec3 tangentNormal = vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0)));
     vec3 Q1 = dFdx(fragPos);
     vec3 Q2 = dFdy(fragPos);
     vec2 st1 = dFdx(fragTexCoord);
@@ -143,18 +158,21 @@ vec3 calculateLightContribution(Light light, vec3 N, vec3 V, vec3 albedo, float
 }
 
 void main() {
-    vec3 albedo = texture(albedoMap, fragTexCoord).rgb;
-    float metallic = texture(metallicRoughnessMap, fragTexCoord).b;
-    float roughness = texture(metallicRoughnessMap, fragTexCoord).g;
+    Material material = materials[pc.materialIndex];
+
+    vec3 albedo = texture(albedoMap, fragTexCoord).rgb * material.baseColorFactor.rgb;
+    vec4 metallicRoughness = texture(metallicRoughnessMap, fragTexCoord);
+    float metallic = metallicRoughness.b * material.metallicFactor;
+    float roughness = metallicRoughness.g * material.roughnessFactor;
     float ao = texture(aoMap, fragTexCoord).r;
-    vec3 emission = texture(emissiveMap, fragTexCoord).rgb;
+    vec3 emission = texture(emissiveMap, fragTexCoord).rgb * material.emissiveFactor.rgb;
     
     vec3 N = getNormalFromMap();
     if (!gl_FrontFacing) {
         N = -N;
     }
     
-    vec3 V = normalize(ubo.cameraPos - fragPos);
+    vec3 V = normalize(ubo.cameraPos.xyz - fragPos);
     vec3 F0 = vec3(0.04);
     F0 = mix(F0, albedo, metallic);
     
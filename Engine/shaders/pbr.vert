@@ -1,20 +1,17 @@
 #version 450
 
-struct Material {
-    vec4 color;
-    float metallic;
-    float roughness;
-    float ambientOcclusion;
-    float padding;
-};
-
 layout(binding = 0) uniform UBO {
-    mat4 model;
     mat4 view;
     mat4 proj;
-    Material material;
+    vec4 cameraPos;
 } ubo;
 
+// Dados por draw (ver PushConstants em VulkanTypes.h)
+layout(push_constant) uniform PushConstants {
+    mat4 model;
+    uint materialIndex;
+} pc;
+
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inTexCoord;
@@ -23,10 +20,13 @@ layout(location = 0) out vec3 fragPos;
 layout(location = 1) out vec3 fragNormal;
 layout(location = 2) out vec2 fragTexCoord;
 
+// Mesmo cálculo do depth_prepass.vert: a profundidade tem que bater bit a bit com o prepass
+invariant gl_Position;
+
 void main() {
-    vec4 worldPos = ubo.model * vec4(inPosition, 1.0);
+    vec4 worldPos = pc.model * vec4(inPosition, 1.0);
     fragPos = worldPos.xyz;
-    fragNormal = normalize(mat3(transpose(inverse(ubo.model))) * inNormal);
+    fragNormal = normalize(mat3(transpose(inverse(pc.model))) * inNormal);
     fragTexCoord = inTexCoord;
     gl_Position = ubo.proj * ubo.view * worldPos;
 }
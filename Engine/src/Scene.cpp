@@ -4,6 +4,10 @@
 #include "core/VulkanDescriptor.h"
 #include "core/VulkanPipeline.h"
 #include "core/VulkanSwapChain.h"
+#include "core/VulkanMeshPool.h"
+#include "core/VulkanDeletionQueue.h"
+#include "ecs/components/MeshComponent.h"
+#include "ecs/components/MaterialComponent.h"
 #include <format>
 #include <iostream>
 #include <magic_enum.hpp>
@@ -21,6 +25,50 @@ void Scene::addEntity(std::shared_ptr<Entity> entity)
     registry->addEntity(entity);
 }
 
+void Scene::destroyPendingEntities()
+{
+    for (const auto &entity : pendingDestroy)
+    {
+        if (auto parent = entity->getParent())
+            parent->removeChild(entity);
+        registry->removeEntity(entity);
+
+        // Sai da cena já; mesh e material só quando o frame em voo, que ainda pode desenhá-los, terminar
+        core->getDeletionQueue()->push([this, entity]() { releaseEntityResources(entity); });
+    }
+    pendingDestroy.clear();
+}
+
+namespace
+{
+void visitHierarchy(const std::shared_ptr<Entity> &entity, const std::function<void(const std::shared_ptr<Entity> &)> &func)
+{
+    func(entity);
+    for (const auto &child : entity->getChildren())
+        visitHierarchy(child, func);
+}
+}
+
+void Scene::forEachEntity(const std::function<void(const std::shared_ptr<Entity> &)> &func) const
+{
+    for (const auto &entity : registry->getEntities())
+    {
+        if (!entity->getParent())
+            visitHierarchy(entity, func);
+    }
+}
+
+void Scene::releaseEntityResources(const std::shared_ptr<Entity> &entity)
+{
+    if (entity->hasComponent<MaterialComponent>())
+        entity->getComponent<MaterialComponent>().cleanup(core->getDevice());
+    if (entity->hasComponent<MeshComponent>())
+        entity->getComponent<MeshComponent>().Destroy(core->getDevice(), *core->getAllocator(), *core->getMeshPool());
+
+    for (const auto &child : entity->getChildren())
+        releaseEntityResources(child);
+}
+
 std::shared_ptr<Entity> Scene::createLightEntity(LightComponent::LightType lightType)
 {
     std::shared_ptr<Entity> lightEntity = createEntity();
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <vulkan/vulkan.h>
 #include "Components.h"
@@ -34,6 +35,12 @@ public:
     {
         registry->removeEntity(entity);
     }
+    // Tira a entidade da cena no início do próximo frame; mesh/material dela e dos filhos são liberados
+    // pela fila de destruição, quando a GPU já não usa mais a geometria
+    void destroyEntity(std::shared_ptr<Entity> entity) { pendingDestroy.push_back(entity); }
+    void destroyPendingEntities();
+    // Raízes do registry e todos os descendentes: nós de modelos importados só existem na hierarquia
+    void forEachEntity(const std::function<void(const std::shared_ptr<Entity> &)> &func) const;
     std::shared_ptr<Entity> createLightEntity(LightComponent::LightType lightType = LightComponent::LightType::Point);
     
     CameraComponent getActiveCamera() const
@@ -45,5 +52,8 @@ public:
     void handleMouseInput(GLFWwindow* window, double xpos, double ypos);
     void handleKeyboardInput(GLFWwindow *window);
 private:
+    void releaseEntityResources(const std::shared_ptr<Entity> &entity);
+
     VulkanCore* core;
+    std::vector<std::shared_ptr<Entity>> pendingDestroy;
 };
\ No newline at end of file
@@ -13,6 +13,8 @@ VulkanRenderer::VulkanRenderer() {
 }
 
 VulkanRenderer::~VulkanRenderer() {
+    // Antes do core: os arrays de textura e a fila de destruição ainda precisam do device
+    if (textureManager) textureManager->cleanup();
     core->cleanup();
 }
 
@@ -44,3 +46,18 @@ void VulkanRenderer::initVulkan(GLFWwindow* window) {
         throw std::runtime_error(error);
     }
 }
+
+void VulkanRenderer::initHeadless(VkExtent2D extent, bool readback) {
+    try {
+        core = std::make_unique<VulkanCore>();
+        core->initHeadless(extent, readback);
+        textureManager = std::make_unique<TextureManager>(core.get());
+        projectManager = std::make_unique<ProjectManager>(core.get());
+        modelLoader = std::make_unique<EngineModelLoader>(*this);
+    }
+    catch (const std::exception& e) {
+        std::string error = "VulkanRenderer headless initialization failed: ";
+        error += e.what();
+        throw std::runtime_error(error);
+    }
+}
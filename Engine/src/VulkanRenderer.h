@@ -9,6 +9,15 @@
 #include "core/VulkanDescriptor.h"
 #include "core/VulkanSwapChain.h"
 #include "core/VulkanImGui.h"
+#include "core/VulkanOcclusion.h"
+#include "core/VulkanBindless.h"
+#include "core/VulkanProfiler.h"
+#include "core/VulkanPipelineCache.h"
+#include "core/VulkanUploadContext.h"
+#include "core/VulkanMeshPool.h"
+#include "core/VulkanResidency.h"
+#include "core/VulkanDeletionQueue.h"
+#include "core/RenderGraph.h"
 #include "rendering/TextureManager.h"
 #include "project/projectManagment.h"
 #include "engine/loaders/ModelLoader.h"
@@ -21,6 +30,8 @@ public:
     ~VulkanRenderer();
 
     void initVulkan(GLFWwindow* window);
+    // Sem janela: ver VulkanCore::initHeadless
+    void initHeadless(VkExtent2D extent, bool readback);
     VulkanCore* getCore() { return core.get(); }
     TextureManager* getTextureManager() { return textureManager.get(); }
     ProjectManager* getProjectManager() { return projectManager.get(); }
@@ -0,0 +1,138 @@
+#include "CpuProfiler.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    // Um escritor (o próprio thread) e leitores só na captura: o escritor publica `head`
+    // com release; o leitor copia e descarta o que pode ter sido sobrescrito durante a cópia.
+    struct ThreadBuffer
+    {
+        std::vector<CpuZoneEvent> events = std::vector<CpuZoneEvent>(CpuProfiler::RING_SIZE);
+        std::atomic<uint64_t> head{0};
+        uint32_t threadId = 0;
+        std::string threadName;
+    };
+
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers; // mantidos após o fim do thread
+    };
+
+    Registry &registry()
+    {
+        static Registry instance;
+        return instance;
+    }
+
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    ThreadBuffer &threadBuffer()
+    {
+        thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+            auto created = std::make_shared<ThreadBuffer>();
+            std::lock_guard<std::mutex> lock(registry().mutex);
+            created->threadId = static_cast<uint32_t>(registry().buffers.size() + 1);
+            registry().buffers.push_back(created);
+            return created;
+        }();
+        return *buffer;
+    }
+
+    void writeEscaped(std::ofstream &out, const std::string &text)
+    {
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                out << '\\';
+            out << c;
+        }
+    }
+}
+
+int64_t CpuProfiler::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void CpuProfiler::record(const char *name, int64_t start, int64_t end)
+{
+    ThreadBuffer &buffer = threadBuffer();
+    uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    buffer.events[head % RING_SIZE] = {name, start, end};
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void CpuProfiler::setThreadName(const std::string &name)
+{
+    ThreadBuffer &buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    buffer.threadName = name;
+}
+
+size_t CpuProfiler::captureTrace(const std::string &path, double seconds)
+{
+    const int64_t from = now() - static_cast<int64_t>(seconds * 1e9);
+
+    std::ofstream out(path);
+    if (!out.is_open())
+    {
+        throw std::runtime_error("failed to open trace file: " + path);
+    }
+
+    std::lock_guard<std::mutex> lock(registry().mutex);
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+    size_t written = 0;
+
+    for (const auto &buffer : registry().buffers)
+    {
+        if (!buffer->threadName.empty())
+        {
+            out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+                << ",\"args\":{\"name\":\"";
+            writeEscaped(out, buffer->threadName);
+            out << "\"}}";
+            first = false;
+        }
+
+        uint64_t headBefore = buffer->head.load(std::memory_order_acquire);
+        uint64_t count = std::min<uint64_t>(headBefore, RING_SIZE);
+        std::vector<CpuZoneEvent> copy(count);
+        for (uint64_t i = 0; i < count; i++)
+        {
+            copy[i] = buffer->events[(headBefore - count + i) % RING_SIZE];
+        }
+
+        // Entradas que o escritor pode ter reutilizado enquanto copiávamos
+        uint64_t headAfter = buffer->head.load(std::memory_order_acquire);
+        uint64_t overwritten = std::min<uint64_t>(count, headAfter - headBefore);
+
+        for (uint64_t i = overwritten; i < count; i++)
+        {
+            const CpuZoneEvent &event = copy[i];
+            if (event.end < from)
+                continue;
+
+            out << (first ? "" : ",\n") << "{\"name\":\"";
+            writeEscaped(out, event.name);
+            out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                << ",\"ts\":" << event.start / 1000.0
+                << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+            first = false;
+            written++;
+        }
+    }
+
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return written;
+}
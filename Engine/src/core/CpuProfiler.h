@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Zonas de CPU: PROFILE_ZONE("Nome") / PROFILE_FUNCTION() no início de um escopo.
+// Cada thread grava num ring buffer próprio (sem locks no caminho quente); a captura
+// lê os últimos N segundos de todos os threads e grava um JSON do Chrome trace
+// (chrome://tracing ou ui.perfetto.dev). Sem ENGINE_PROFILING as macros somem.
+struct CpuZoneEvent
+{
+    const char *name; // literal: precisa viver até a captura
+    int64_t start;    // ns desde o início do processo
+    int64_t end;
+};
+
+class CpuProfiler
+{
+public:
+    static constexpr size_t RING_SIZE = 1 << 16; // eventos por thread
+
+    static int64_t now();
+    static void record(const char *name, int64_t start, int64_t end);
+    static void setThreadName(const std::string &name);
+
+    // Grava as zonas terminadas nos últimos `seconds` segundos; devolve quantos eventos foram escritos
+    static size_t captureTrace(const std::string &path, double seconds);
+};
+
+class CpuProfileZone
+{
+public:
+    explicit CpuProfileZone(const char *name) : name(name), start(CpuProfiler::now()) {}
+    ~CpuProfileZone() { CpuProfiler::record(name, start, CpuProfiler::now()); }
+
+    CpuProfileZone(const CpuProfileZone &) = delete;
+    CpuProfileZone &operator=(const CpuProfileZone &) = delete;
+
+private:
+    const char *name;
+    int64_t start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef ENGINE_PROFILING
+#define PROFILE_ZONE(name) CpuProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_ZONE(__FUNCTION__)
+#define PROFILE_THREAD_NAME(name) CpuProfiler::setThreadName(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_THREAD_NAME(name) ((void)0)
+#endif
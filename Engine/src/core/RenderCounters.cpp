@@ -0,0 +1,29 @@
+#include "RenderCounters.h"
+
+RenderCounters::AtomicValues &RenderCounters::current()
+{
+    static AtomicValues values{};
+    return values;
+}
+
+RenderCounterValues &RenderCounters::lastFrame()
+{
+    static RenderCounterValues values{};
+    return values;
+}
+
+RenderCounterValues &RenderCounters::totals()
+{
+    static RenderCounterValues values{};
+    return values;
+}
+
+void RenderCounters::endFrame()
+{
+    for (size_t i = 0; i < current().size(); i++)
+    {
+        uint64_t value = current()[i].exchange(0, std::memory_order_relaxed);
+        lastFrame()[i] = value;
+        totals()[i] += value;
+    }
+}
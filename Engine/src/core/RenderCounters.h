@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Contadores por frame: o que foi gravado/criado desde o último endFrame.
+// Incrementos são atômicos (relaxed) porque criações e uploads podem vir de outros threads.
+enum class RenderCounter : uint32_t
+{
+    DrawCalls,
+    Instances,
+    Triangles,
+    PipelineBinds,
+    DescriptorBinds,
+    UploadBytes,
+    BuffersCreated,
+    BuffersDestroyed,
+    ImagesCreated,
+    ImagesDestroyed,
+    MemoryAllocations,
+    MemoryFrees,
+    PipelinesCreated,
+    PipelinesDestroyed,
+    DescriptorSetsAllocated,
+    Count
+};
+
+using RenderCounterValues = std::array<uint64_t, static_cast<size_t>(RenderCounter::Count)>;
+
+class RenderCounters
+{
+public:
+    static void add(RenderCounter counter, uint64_t value = 1)
+    {
+        current()[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    static void countDraw(uint32_t indexCount, uint32_t instanceCount = 1)
+    {
+        add(RenderCounter::DrawCalls);
+        add(RenderCounter::Instances, instanceCount);
+        add(RenderCounter::Triangles, static_cast<uint64_t>(indexCount / 3) * instanceCount);
+    }
+
+    // Fecha o frame: os valores viram o "último frame" e se somam ao total
+    static void endFrame();
+
+    static uint64_t get(RenderCounter counter) { return lastFrame()[static_cast<size_t>(counter)]; }
+    static uint64_t total(RenderCounter counter) { return totals()[static_cast<size_t>(counter)]; }
+    static const RenderCounterValues &getLastFrame() { return lastFrame(); }
+    static const RenderCounterValues &getTotals() { return totals(); }
+
+private:
+    using AtomicValues = std::array<std::atomic<uint64_t>, static_cast<size_t>(RenderCounter::Count)>;
+
+    static AtomicValues &current();
+    static RenderCounterValues &lastFrame();
+    static RenderCounterValues &totals();
+};
@@ -0,0 +1,762 @@
+#include "RenderGraph.h"
+#include "VulkanProfiler.h"
+#include "RenderCounters.h"
+#include "VulkanDeletionQueue.h"
+#include <stdexcept>
+#include <algorithm>
+
+namespace
+{
+    constexpr VkAccessFlags WRITE_ACCESS_MASK = VK_ACCESS_SHADER_WRITE_BIT |
+                                                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                                VK_ACCESS_TRANSFER_WRITE_BIT |
+                                                VK_ACCESS_HOST_WRITE_BIT |
+                                                VK_ACCESS_MEMORY_WRITE_BIT;
+
+    bool isAttachment(RenderGraphAccess access)
+    {
+        return access == RenderGraphAccess::ColorAttachment || access == RenderGraphAccess::DepthAttachment;
+    }
+
+    VkAttachmentLoadOp toLoadOp(RenderGraphLoad load)
+    {
+        switch (load)
+        {
+        case RenderGraphLoad::Clear:
+            return VK_ATTACHMENT_LOAD_OP_CLEAR;
+        case RenderGraphLoad::Load:
+            return VK_ATTACHMENT_LOAD_OP_LOAD;
+        default:
+            return VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        }
+    }
+}
+
+RenderGraphPass &RenderGraphPass::writeColor(RenderGraphResource resource, RenderGraphLoad load, VkClearColorValue clear)
+{
+    VkClearValue clearValue{};
+    clearValue.color = clear;
+    accesses.push_back({resource, RenderGraphAccess::ColorAttachment, true, load, clearValue});
+    return *this;
+}
+
+RenderGraphPass &RenderGraphPass::writeDepth(RenderGraphResource resource, RenderGraphLoad load, VkClearDepthStencilValue clear)
+{
+    VkClearValue clearValue{};
+    clearValue.depthStencil = clear;
+    accesses.push_back({resource, RenderGraphAccess::DepthAttachment, true, load, clearValue});
+    return *this;
+}
+
+RenderGraphPass &RenderGraphPass::read(RenderGraphResource resource, RenderGraphAccess access)
+{
+    accesses.push_back({resource, access, false, RenderGraphLoad::Load, {}});
+    return *this;
+}
+
+RenderGraphPass &RenderGraphPass::write(RenderGraphResource resource, RenderGraphAccess access)
+{
+    // Escritas fora de attachments podem ser parciais: o conteúdo anterior continua relevante
+    accesses.push_back({resource, access, true, RenderGraphLoad::Load, {}});
+    return *this;
+}
+
+RenderGraphPass &RenderGraphPass::setSideEffects()
+{
+    sideEffects = true;
+    return *this;
+}
+
+RenderGraphPass &RenderGraphPass::setExecute(std::function<void(VkCommandBuffer)> callback)
+{
+    execute = std::move(callback);
+    return *this;
+}
+
+RenderGraph::RenderGraph(VulkanCore &core) : core(core)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+    reset();
+}
+
+RenderGraphResource RenderGraph::createImage(const std::string &name, const RenderGraphImageDesc &desc)
+{
+    if (compiled)
+    {
+        throw std::runtime_error("render graph already compiled: " + name);
+    }
+
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    resources.push_back(resource);
+    return static_cast<RenderGraphResource>(resources.size() - 1);
+}
+
+RenderGraphResource RenderGraph::importImage(const std::string &name, const RenderGraphImageDesc &desc,
+                                             VkImage image, VkImageView view,
+                                             const RenderGraphImageState &initialState,
+                                             VkImageLayout finalLayout)
+{
+    if (compiled)
+    {
+        throw std::runtime_error("render graph already compiled: " + name);
+    }
+
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    resource.imported = true;
+    resource.image = image;
+    resource.view = view;
+    resource.initialState = initialState;
+    resource.finalLayout = finalLayout;
+    resources.push_back(resource);
+    return static_cast<RenderGraphResource>(resources.size() - 1);
+}
+
+void RenderGraph::setImportedImage(RenderGraphResource resource, VkImage image, VkImageView view)
+{
+    if (!resources[resource].imported)
+    {
+        throw std::runtime_error("render graph resource is not imported: " + resources[resource].name);
+    }
+
+    resources[resource].image = image;
+    resources[resource].view = view;
+}
+
+RenderGraphPass &RenderGraph::addPass(const std::string &name, RenderGraphPassType type)
+{
+    if (compiled)
+    {
+        throw std::runtime_error("render graph already compiled: " + name);
+    }
+
+    auto pass = std::make_unique<RenderGraphPass>();
+    pass->name = name;
+    pass->type = type;
+    passes.push_back(std::move(pass));
+    return *passes.back();
+}
+
+void RenderGraph::compile()
+{
+    if (compiled)
+        return;
+
+    cullPasses();
+    computeLifetimes();
+    createTransientImages();
+    aliasTransientMemory();
+    createRenderPasses();
+
+    stats.passCount = static_cast<uint32_t>(passes.size());
+    stats.culledPassCount = static_cast<uint32_t>(std::count_if(passes.begin(), passes.end(),
+                                                                [](const auto &pass) { return pass->culled; }));
+    compiled = true;
+}
+
+void RenderGraph::cullPasses()
+{
+    // De trás para frente: um pass sobrevive se tem efeitos colaterais, escreve um recurso importado
+    // ou escreve algo que um pass posterior (vivo) lê
+    std::vector<bool> needed(resources.size(), false);
+
+    for (int i = static_cast<int>(passes.size()) - 1; i >= 0; i--)
+    {
+        RenderGraphPass &pass = *passes[i];
+
+        bool live = pass.sideEffects;
+        for (const auto &access : pass.accesses)
+        {
+            if (access.write && (resources[access.resource].imported || needed[access.resource]))
+                live = true;
+        }
+
+        pass.culled = !live;
+        if (!live)
+            continue;
+
+        // Attachment limpo/descartado sobrescreve tudo: passes anteriores não precisam produzi-lo
+        for (const auto &access : pass.accesses)
+        {
+            if (access.write && isAttachment(access.access) && access.load != RenderGraphLoad::Load)
+                needed[access.resource] = false;
+        }
+
+        for (const auto &access : pass.accesses)
+        {
+            if (!access.write || access.load == RenderGraphLoad::Load)
+                needed[access.resource] = true;
+        }
+    }
+}
+
+void RenderGraph::computeLifetimes()
+{
+    for (size_t i = 0; i < passes.size(); i++)
+    {
+        if (passes[i]->culled)
+            continue;
+
+        for (const auto &access : passes[i]->accesses)
+        {
+            Resource &resource = resources[access.resource];
+            if (resource.firstPass < 0)
+                resource.firstPass = static_cast<int>(i);
+            resource.lastPass = static_cast<int>(i);
+            resource.usage |= getAccessUsage(access.access);
+        }
+    }
+}
+
+void RenderGraph::createTransientImages()
+{
+    for (auto &resource : resources)
+    {
+        // Imagens importadas já existem; transitórias sem pass vivo nem são criadas
+        if (resource.imported || resource.firstPass < 0)
+            continue;
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent = {resource.desc.extent.width, resource.desc.extent.height, 1};
+        imageInfo.mipLevels = resource.desc.mipLevels;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = resource.desc.format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = resource.usage;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        RenderCounters::add(RenderCounter::ImagesCreated);
+        if (vkCreateImage(core.getDevice(), &imageInfo, nullptr, &resource.image) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create render graph image: " + resource.name);
+        }
+
+        vkGetImageMemoryRequirements(core.getDevice(), resource.image, &resource.requirements);
+        stats.transientImageCount++;
+        stats.transientRequested += resource.requirements.size;
+    }
+}
+
+void RenderGraph::aliasTransientMemory()
+{
+    std::vector<RenderGraphResource> transients;
+    for (RenderGraphResource i = 0; i < resources.size(); i++)
+    {
+        if (!resources[i].imported && resources[i].image != VK_NULL_HANDLE)
+            transients.push_back(i);
+    }
+
+    // Maiores primeiro: cada bloco nasce com o tamanho do seu maior ocupante
+    std::sort(transients.begin(), transients.end(), [&](RenderGraphResource a, RenderGraphResource b) {
+        return resources[a].requirements.size > resources[b].requirements.size;
+    });
+
+    for (RenderGraphResource index : transients)
+    {
+        Resource &resource = resources[index];
+
+        int chosen = -1;
+        for (size_t b = 0; b < memoryBlocks.size() && chosen < 0; b++)
+        {
+            MemoryBlock &block = memoryBlocks[b];
+            if ((block.memoryTypeBits & resource.requirements.memoryTypeBits) == 0)
+                continue;
+
+            // Só compartilha com imagens cuja vida (intervalo de passes) não cruza a desta
+            bool overlaps = false;
+            for (RenderGraphResource user : block.users)
+            {
+                const Resource &other = resources[user];
+                if (resource.firstPass <= other.lastPass && other.firstPass <= resource.lastPass)
+                {
+                    overlaps = true;
+                    break;
+                }
+            }
+
+            if (!overlaps)
+                chosen = static_cast<int>(b);
+        }
+
+        if (chosen < 0)
+        {
+            memoryBlocks.emplace_back();
+            chosen = static_cast<int>(memoryBlocks.size() - 1);
+        }
+
+        MemoryBlock &block = memoryBlocks[chosen];
+        block.memoryTypeBits &= resource.requirements.memoryTypeBits;
+        block.size = std::max(block.size, resource.requirements.size);
+        block.users.push_back(index);
+        resource.memoryBlock = chosen;
+    }
+
+    for (auto &block : memoryBlocks)
+    {
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = block.size;
+        block.memoryType = core.findMemoryType(block.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        allocInfo.memoryTypeIndex = block.memoryType;
+
+        RenderCounters::add(RenderCounter::MemoryAllocations);
+        if (vkAllocateMemory(core.getDevice(), &allocInfo, nullptr, &block.memory) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to allocate render graph memory!");
+        }
+        // Fora do VulkanAllocator, mas entra no painel de memória e no orçamento
+        core.getAllocator()->trackExternal(GpuMemoryCategory::RenderTarget, block.memoryType,
+                                           static_cast<int64_t>(block.size));
+
+        stats.transientAllocated += block.size;
+
+        // Todas as imagens do bloco começam no offset 0, que satisfaz qualquer alinhamento
+        for (RenderGraphResource user : block.users)
+        {
+            Resource &resource = resources[user];
+            if (vkBindImageMemory(core.getDevice(), resource.image, block.memory, 0) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to bind render graph image memory: " + resource.name);
+            }
+
+            VkImageViewCreateInfo viewInfo{};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image = resource.image;
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = resource.desc.format;
+            viewInfo.subresourceRange = {getAspect(resource.desc.format, false), 0, resource.desc.mipLevels, 0, 1};
+
+            if (vkCreateImageView(core.getDevice(), &viewInfo, nullptr, &resource.view) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to create render graph image view: " + resource.name);
+            }
+        }
+    }
+
+    stats.memoryBlockCount = static_cast<uint32_t>(memoryBlocks.size());
+}
+
+void RenderGraph::createRenderPasses()
+{
+    for (size_t i = 0; i < passes.size(); i++)
+    {
+        RenderGraphPass &pass = *passes[i];
+        if (pass.culled || pass.type != RenderGraphPassType::Graphics)
+            continue;
+
+        std::vector<VkAttachmentDescription> attachments;
+        std::vector<VkAttachmentReference> colorRefs;
+        VkAttachmentReference depthRef{};
+        bool hasDepth = false;
+
+        for (const auto &access : pass.accesses)
+        {
+            if (!isAttachment(access.access))
+                continue;
+
+            const Resource &resource = resources[access.resource];
+
+            // Só guarda o conteúdo se alguém ainda vai usá-lo (pass seguinte ou dono externo)
+            bool usedLater = resource.imported || resource.lastPass > static_cast<int>(i);
+
+            RenderGraphImageState state = getAccessState(access.access, resource.desc.format);
+
+            // Layouts de entrada e saída iguais ao do subpass: as transições ficam nas barriers do grafo
+            VkAttachmentDescription attachment{};
+            attachment.format = resource.desc.format;
+            attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+            attachment.loadOp = toLoadOp(access.load);
+            attachment.storeOp = usedLater ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            attachment.initialLayout = state.layout;
+            attachment.finalLayout = state.layout;
+
+            VkAttachmentReference reference{static_cast<uint32_t>(attachments.size()), state.layout};
+            if (access.access == RenderGraphAccess::DepthAttachment)
+            {
+                depthRef = reference;
+                hasDepth = true;
+            }
+            else
+            {
+                colorRefs.push_back(reference);
+            }
+
+            attachments.push_back(attachment);
+            pass.attachments.push_back(access.resource);
+            pass.clearValues.push_back(access.clear);
+            pass.extent = resource.desc.extent;
+        }
+
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = static_cast<uint32_t>(colorRefs.size());
+        subpass.pColorAttachments = colorRefs.data();
+        subpass.pDepthStencilAttachment = hasDepth ? &depthRef : nullptr;
+
+        VkRenderPassCreateInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+        renderPassInfo.pAttachments = attachments.data();
+        renderPassInfo.subpassCount = 1;
+        renderPassInfo.pSubpasses = &subpass;
+
+        if (vkCreateRenderPass(core.getDevice(), &renderPassInfo, nullptr, &pass.renderPass) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create render graph render pass: " + pass.name);
+        }
+    }
+}
+
+VkFramebuffer RenderGraph::getFramebuffer(RenderGraphPass &pass)
+{
+    std::vector<VkImageView> views;
+    for (RenderGraphResource resource : pass.attachments)
+    {
+        views.push_back(resources[resource].view);
+    }
+
+    // A swapchain alterna entre imagens: um framebuffer por combinação de views
+    auto key = std::make_pair(pass.renderPass, views);
+    auto it = framebuffers.find(key);
+    if (it != framebuffers.end())
+        return it->second;
+
+    VkFramebufferCreateInfo framebufferInfo{};
+    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferInfo.renderPass = pass.renderPass;
+    framebufferInfo.attachmentCount = static_cast<uint32_t>(views.size());
+    framebufferInfo.pAttachments = views.data();
+    framebufferInfo.width = pass.extent.width;
+    framebufferInfo.height = pass.extent.height;
+    framebufferInfo.layers = 1;
+
+    VkFramebuffer framebuffer;
+    if (vkCreateFramebuffer(core.getDevice(), &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create render graph framebuffer: " + pass.name);
+    }
+
+    framebuffers.emplace(key, framebuffer);
+    return framebuffer;
+}
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer)
+{
+    if (!compiled)
+    {
+        throw std::runtime_error("render graph executed before compile!");
+    }
+
+    stats.barrierCount = 0;
+
+    // Estado de cada imagem ao longo do frame; transitórias começam sem conteúdo
+    std::vector<RenderGraphImageState> states(resources.size());
+    std::vector<bool> touched(resources.size(), false);
+    for (size_t r = 0; r < resources.size(); r++)
+    {
+        if (resources[r].imported)
+            states[r] = resources[r].initialState;
+    }
+
+    for (auto &block : memoryBlocks)
+    {
+        block.lastStage = 0;
+        block.lastAccess = 0;
+    }
+
+    for (auto &passPtr : passes)
+    {
+        RenderGraphPass &pass = *passPtr;
+        if (pass.culled)
+            continue;
+
+        // Um escopo de GPU por pass, incluindo as barriers dele
+        GpuProfileScope profileScope(core.getProfiler(), commandBuffer, pass.name);
+
+        std::vector<VkImageMemoryBarrier> barriers;
+        VkPipelineStageFlags srcStages = 0;
+        VkPipelineStageFlags dstStages = 0;
+
+        for (const auto &access : pass.accesses)
+        {
+            const Resource &resource = resources[access.resource];
+            RenderGraphImageState &current = states[access.resource];
+            RenderGraphImageState target = getAccessState(access.access, resource.desc.format);
+
+            // Primeiro uso de uma imagem com memória compartilhada: espera o ocupante anterior do bloco
+            if (!resource.imported && !touched[access.resource] && resource.memoryBlock >= 0)
+            {
+                const MemoryBlock &block = memoryBlocks[resource.memoryBlock];
+                if (block.lastStage != 0)
+                {
+                    current.stage = block.lastStage;
+                    current.access = block.lastAccess;
+                }
+            }
+            touched[access.resource] = true;
+
+            bool discard = isAttachment(access.access) && access.load != RenderGraphLoad::Load;
+            bool layoutChange = current.layout != target.layout;
+            bool hazard = (current.access & WRITE_ACCESS_MASK) || (target.access & WRITE_ACCESS_MASK);
+
+            if (layoutChange || hazard)
+            {
+                VkImageMemoryBarrier barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                barrier.oldLayout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : current.layout;
+                barrier.newLayout = target.layout;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.image = resource.image;
+                barrier.subresourceRange = {getAspect(resource.desc.format, true), 0, VK_REMAINING_MIP_LEVELS, 0, 1};
+                barrier.srcAccessMask = current.access & WRITE_ACCESS_MASK;
+                barrier.dstAccessMask = target.access;
+                barriers.push_back(barrier);
+
+                srcStages |= current.stage;
+                dstStages |= target.stage;
+            }
+
+            current = target;
+
+            if (resource.memoryBlock >= 0)
+            {
+                MemoryBlock &block = memoryBlocks[resource.memoryBlock];
+                block.lastStage = target.stage;
+                block.lastAccess = target.access;
+            }
+        }
+
+        if (!barriers.empty())
+        {
+            vkCmdPipelineBarrier(commandBuffer,
+                                 srcStages ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dstStages,
+                                 0, 0, nullptr, 0, nullptr,
+                                 static_cast<uint32_t>(barriers.size()), barriers.data());
+            stats.barrierCount += static_cast<uint32_t>(barriers.size());
+        }
+
+        if (pass.type == RenderGraphPassType::Graphics)
+        {
+            VkRenderPassBeginInfo renderPassInfo{};
+            renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            renderPassInfo.renderPass = pass.renderPass;
+            renderPassInfo.framebuffer = getFramebuffer(pass);
+            renderPassInfo.renderArea = {{0, 0}, pass.extent};
+            renderPassInfo.clearValueCount = static_cast<uint32_t>(pass.clearValues.size());
+            renderPassInfo.pClearValues = pass.clearValues.data();
+
+            vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+            if (pass.execute)
+                pass.execute(commandBuffer);
+            vkCmdEndRenderPass(commandBuffer);
+        }
+        else if (pass.execute)
+        {
+            pass.execute(commandBuffer);
+        }
+    }
+
+    // Imagens importadas saem no layout que o dono espera (ex.: PRESENT_SRC para a swapchain)
+    std::vector<VkImageMemoryBarrier> finalBarriers;
+    VkPipelineStageFlags srcStages = 0;
+    for (size_t r = 0; r < resources.size(); r++)
+    {
+        const Resource &resource = resources[r];
+        if (!resource.imported || resource.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED ||
+            states[r].layout == resource.finalLayout)
+            continue;
+
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = states[r].layout;
+        barrier.newLayout = resource.finalLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = resource.image;
+        barrier.subresourceRange = {getAspect(resource.desc.format, true), 0, VK_REMAINING_MIP_LEVELS, 0, 1};
+        barrier.srcAccessMask = states[r].access & WRITE_ACCESS_MASK;
+        barrier.dstAccessMask = 0;
+        finalBarriers.push_back(barrier);
+
+        srcStages |= states[r].stage;
+    }
+
+    if (!finalBarriers.empty())
+    {
+        vkCmdPipelineBarrier(commandBuffer, srcStages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, nullptr, 0, nullptr,
+                             static_cast<uint32_t>(finalBarriers.size()), finalBarriers.data());
+        stats.barrierCount += static_cast<uint32_t>(finalBarriers.size());
+    }
+}
+
+void RenderGraph::reset()
+{
+    VkDevice device = core.getDevice();
+    if (device == VK_NULL_HANDLE)
+        return;
+
+    // O frame em voo ainda usa imagens, framebuffers e render passes: a destruição vai para a fila
+    // e o grafo pode ser recompilado já neste frame
+    std::vector<VkFramebuffer> oldFramebuffers;
+    for (auto &[key, framebuffer] : framebuffers)
+        oldFramebuffers.push_back(framebuffer);
+    framebuffers.clear();
+
+    std::vector<VkRenderPass> oldRenderPasses;
+    for (auto &pass : passes)
+    {
+        if (pass->renderPass != VK_NULL_HANDLE)
+            oldRenderPasses.push_back(pass->renderPass);
+    }
+    passes.clear();
+
+    std::vector<std::pair<VkImage, VkImageView>> oldImages;
+    for (auto &resource : resources)
+    {
+        if (!resource.imported)
+            oldImages.emplace_back(resource.image, resource.view);
+    }
+    resources.clear();
+
+    std::vector<MemoryBlock> oldBlocks;
+    for (auto &block : memoryBlocks)
+    {
+        if (block.memory != VK_NULL_HANDLE)
+            oldBlocks.push_back(std::move(block));
+    }
+    memoryBlocks.clear();
+
+    stats = {};
+    compiled = false;
+
+    if (oldFramebuffers.empty() && oldRenderPasses.empty() && oldImages.empty() && oldBlocks.empty())
+        return;
+
+    // O grafo pode ser destruído antes da fila rodar: nada de this na captura
+    core.getDeletionQueue()->push(
+        [&core = core, device, oldFramebuffers = std::move(oldFramebuffers), oldRenderPasses = std::move(oldRenderPasses),
+         oldImages = std::move(oldImages), oldBlocks = std::move(oldBlocks)]()
+        {
+            for (VkFramebuffer framebuffer : oldFramebuffers)
+                vkDestroyFramebuffer(device, framebuffer, nullptr);
+
+            for (VkRenderPass renderPass : oldRenderPasses)
+                vkDestroyRenderPass(device, renderPass, nullptr);
+
+            for (const auto &[image, view] : oldImages)
+            {
+                if (view != VK_NULL_HANDLE)
+                    vkDestroyImageView(device, view, nullptr);
+                if (image != VK_NULL_HANDLE)
+                {
+                    RenderCounters::add(RenderCounter::ImagesDestroyed);
+                    vkDestroyImage(device, image, nullptr);
+                }
+            }
+
+            for (const MemoryBlock &block : oldBlocks)
+            {
+                RenderCounters::add(RenderCounter::MemoryFrees);
+                vkFreeMemory(device, block.memory, nullptr);
+                core.getAllocator()->trackExternal(GpuMemoryCategory::RenderTarget, block.memoryType,
+                                                   -static_cast<int64_t>(block.size));
+            }
+        });
+}
+
+RenderGraphImageState RenderGraph::getAccessState(RenderGraphAccess access, VkFormat format) const
+{
+    // Profundidade amostrada fica em DEPTH_STENCIL_READ_ONLY, cor em SHADER_READ_ONLY
+    VkImageLayout sampledLayout = isDepthFormat(format) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+                                                        : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    switch (access)
+    {
+    case RenderGraphAccess::ColorAttachment:
+        return {VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT};
+    case RenderGraphAccess::DepthAttachment:
+        return {VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT};
+    case RenderGraphAccess::SampledFragment:
+        return {sampledLayout, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT};
+    case RenderGraphAccess::SampledCompute:
+        return {sampledLayout, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT};
+    case RenderGraphAccess::StorageCompute:
+        return {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT};
+    case RenderGraphAccess::TransferSrc:
+        return {VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT};
+    case RenderGraphAccess::TransferDst:
+        return {VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT};
+    }
+
+    throw std::runtime_error("unsupported render graph access!");
+}
+
+VkImageUsageFlags RenderGraph::getAccessUsage(RenderGraphAccess access) const
+{
+    switch (access)
+    {
+    case RenderGraphAccess::ColorAttachment:
+        return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    case RenderGraphAccess::DepthAttachment:
+        return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    case RenderGraphAccess::SampledFragment:
+    case RenderGraphAccess::SampledCompute:
+        return VK_IMAGE_USAGE_SAMPLED_BIT;
+    case RenderGraphAccess::StorageCompute:
+        return VK_IMAGE_USAGE_STORAGE_BIT;
+    case RenderGraphAccess::TransferSrc:
+        return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    case RenderGraphAccess::TransferDst:
+        return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    }
+
+    return 0;
+}
+
+VkImageAspectFlags RenderGraph::getAspect(VkFormat format, bool barrier) const
+{
+    if (!isDepthFormat(format))
+        return VK_IMAGE_ASPECT_COLOR_BIT;
+
+    // Views só leem o depth; transições de layout em formatos combinados incluem o stencil
+    bool hasStencil = format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT ||
+                      format == VK_FORMAT_D16_UNORM_S8_UINT;
+    if (barrier && hasStencil)
+        return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    return VK_IMAGE_ASPECT_DEPTH_BIT;
+}
+
+bool RenderGraph::isDepthFormat(VkFormat format) const
+{
+    switch (format)
+    {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+    case VK_FORMAT_D32_SFLOAT:
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        return true;
+    default:
+        return false;
+    }
+}
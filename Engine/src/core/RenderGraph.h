@@ -0,0 +1,190 @@
+#pragma once
+#include "VulkanCore.h"
+#include "VulkanTypes.h"
+#include <functional>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+using RenderGraphResource = uint32_t;
+constexpr RenderGraphResource RENDER_GRAPH_INVALID_RESOURCE = UINT32_MAX;
+
+enum class RenderGraphPassType
+{
+    Graphics, // abre um render pass com os attachments declarados
+    Compute   // só barriers + callback (compute, cópias)
+};
+
+enum class RenderGraphLoad
+{
+    Clear,
+    Load,
+    DontCare
+};
+
+// Como um pass usa uma imagem; define layout, estágio, acesso e usage
+enum class RenderGraphAccess
+{
+    ColorAttachment,
+    DepthAttachment,
+    SampledFragment,
+    SampledCompute,
+    StorageCompute,
+    TransferSrc,
+    TransferDst
+};
+
+struct RenderGraphImageDesc
+{
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkExtent2D extent{};
+    uint32_t mipLevels = 1;
+};
+
+// Estado de uma imagem entre dois passes
+struct RenderGraphImageState
+{
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkPipelineStageFlags stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    VkAccessFlags access = 0;
+};
+
+struct RenderGraphStats
+{
+    uint32_t passCount = 0;
+    uint32_t culledPassCount = 0;
+    uint32_t transientImageCount = 0;
+    uint32_t memoryBlockCount = 0;
+    VkDeviceSize transientRequested = 0; // soma dos tamanhos sem aliasing
+    VkDeviceSize transientAllocated = 0; // memória realmente alocada
+    uint32_t barrierCount = 0;           // barriers emitidas no último execute
+};
+
+class RenderGraph;
+
+class RenderGraphPass
+{
+public:
+    RenderGraphPass &writeColor(RenderGraphResource resource, RenderGraphLoad load = RenderGraphLoad::Clear,
+                                VkClearColorValue clear = {{0.0f, 0.0f, 0.0f, 1.0f}});
+    RenderGraphPass &writeDepth(RenderGraphResource resource, RenderGraphLoad load = RenderGraphLoad::Clear,
+                                VkClearDepthStencilValue clear = {1.0f, 0});
+    RenderGraphPass &read(RenderGraphResource resource, RenderGraphAccess access);
+    RenderGraphPass &write(RenderGraphResource resource, RenderGraphAccess access);
+
+    // Passes com efeitos fora do grafo (readback, apresentação) nunca são descartados
+    RenderGraphPass &setSideEffects();
+    RenderGraphPass &setExecute(std::function<void(VkCommandBuffer)> callback);
+
+    const std::string &getName() const { return name; }
+    bool isCulled() const { return culled; }
+
+private:
+    friend class RenderGraph;
+
+    struct Access
+    {
+        RenderGraphResource resource;
+        RenderGraphAccess access;
+        bool write;
+        RenderGraphLoad load;
+        VkClearValue clear;
+    };
+
+    std::string name;
+    RenderGraphPassType type = RenderGraphPassType::Graphics;
+    std::vector<Access> accesses;
+    std::function<void(VkCommandBuffer)> execute;
+    bool sideEffects = false;
+    bool culled = false;
+
+    // Gerados no compile (só passes gráficos)
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    VkExtent2D extent{};
+    std::vector<RenderGraphResource> attachments;
+    std::vector<VkClearValue> clearValues;
+};
+
+class RenderGraph
+{
+public:
+    RenderGraph(VulkanCore &core);
+    ~RenderGraph();
+
+    // Imagem criada pelo grafo; a memória pode ser compartilhada com outras de vida disjunta
+    RenderGraphResource createImage(const std::string &name, const RenderGraphImageDesc &desc);
+
+    // Imagem externa (swapchain, recursos persistentes); o grafo só cuida das transições
+    RenderGraphResource importImage(const std::string &name, const RenderGraphImageDesc &desc,
+                                    VkImage image, VkImageView view,
+                                    const RenderGraphImageState &initialState,
+                                    VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED);
+    void setImportedImage(RenderGraphResource resource, VkImage image, VkImageView view);
+
+    RenderGraphPass &addPass(const std::string &name, RenderGraphPassType type);
+
+    // Descarta passes sem uso, cria imagens transitórias (com aliasing) e render passes
+    void compile();
+    void execute(VkCommandBuffer commandBuffer);
+
+    // Destrói tudo; o grafo pode ser montado de novo
+    void reset();
+
+    VkImage getImage(RenderGraphResource resource) const { return resources[resource].image; }
+    VkImageView getImageView(RenderGraphResource resource) const { return resources[resource].view; }
+    const std::vector<std::unique_ptr<RenderGraphPass>> &getPasses() const { return passes; }
+    const RenderGraphStats &getStats() const { return stats; }
+
+private:
+    struct Resource
+    {
+        std::string name;
+        RenderGraphImageDesc desc;
+        bool imported = false;
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkImageUsageFlags usage = 0;
+        RenderGraphImageState initialState;
+        VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        // Transitórias
+        int firstPass = -1;
+        int lastPass = -1;
+        int memoryBlock = -1;
+        VkMemoryRequirements requirements{};
+    };
+
+    struct MemoryBlock
+    {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize size = 0;
+        uint32_t memoryTypeBits = ~0u;
+        uint32_t memoryType = 0;
+        std::vector<RenderGraphResource> users;
+
+        // Último uso no frame atual: a primeira barrier do próximo ocupante espera por ele
+        VkPipelineStageFlags lastStage = 0;
+        VkAccessFlags lastAccess = 0;
+    };
+
+    void cullPasses();
+    void computeLifetimes();
+    void createTransientImages();
+    void aliasTransientMemory();
+    void createRenderPasses();
+    VkFramebuffer getFramebuffer(RenderGraphPass &pass);
+
+    RenderGraphImageState getAccessState(RenderGraphAccess access, VkFormat format) const;
+    VkImageUsageFlags getAccessUsage(RenderGraphAccess access) const;
+    VkImageAspectFlags getAspect(VkFormat format, bool barrier) const;
+    bool isDepthFormat(VkFormat format) const;
+
+    VulkanCore &core;
+    std::vector<Resource> resources;
+    std::vector<std::unique_ptr<RenderGraphPass>> passes;
+    std::vector<MemoryBlock> memoryBlocks;
+    std::map<std::pair<VkRenderPass, std::vector<VkImageView>>, VkFramebuffer> framebuffers;
+    RenderGraphStats stats;
+    bool compiled = false;
+};
@@ -0,0 +1,275 @@
+#include "TlsfAllocator.h"
+#include <stdexcept>
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    uint32_t lowestBit(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<uint32_t>(index);
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+    }
+
+    uint32_t highestBit(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<uint32_t>(index);
+#else
+        return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+    }
+}
+
+TlsfAllocator::TlsfAllocator(uint64_t size) : size(size)
+{
+    if (size == 0)
+    {
+        throw std::runtime_error("TLSF allocator needs a non-empty range!");
+    }
+
+    for (auto &lists : freeLists)
+        std::fill(std::begin(lists), std::end(lists), INVALID_NODE);
+
+    uint32_t node = newNode();
+    nodes[node].offset = 0;
+    nodes[node].size = size;
+    nodes[node].free = true;
+    insertFree(node);
+}
+
+void TlsfAllocator::mapping(uint64_t size, uint32_t &fl, uint32_t &sl)
+{
+    if (size < SL_COUNT)
+    {
+        // Tamanhos pequenos: uma lista por tamanho no primeiro nível
+        fl = 0;
+        sl = static_cast<uint32_t>(size);
+        return;
+    }
+
+    uint32_t msb = highestBit(size);
+    sl = static_cast<uint32_t>(size >> (msb - SL_BITS)) - SL_COUNT;
+    fl = msb - SL_BITS + 1;
+}
+
+uint32_t TlsfAllocator::newNode()
+{
+    if (!unusedNodes.empty())
+    {
+        uint32_t node = unusedNodes.back();
+        unusedNodes.pop_back();
+        nodes[node] = Node{};
+        return node;
+    }
+
+    nodes.emplace_back();
+    return static_cast<uint32_t>(nodes.size() - 1);
+}
+
+void TlsfAllocator::releaseNode(uint32_t node)
+{
+    nodes[node] = Node{};
+    unusedNodes.push_back(node);
+}
+
+void TlsfAllocator::insertFree(uint32_t node)
+{
+    uint32_t fl, sl;
+    mapping(nodes[node].size, fl, sl);
+
+    uint32_t head = freeLists[fl][sl];
+    nodes[node].prevFree = INVALID_NODE;
+    nodes[node].nextFree = head;
+    if (head != INVALID_NODE)
+        nodes[head].prevFree = node;
+
+    freeLists[fl][sl] = node;
+    flBitmap |= 1ull << fl;
+    slBitmap[fl] |= 1u << sl;
+}
+
+void TlsfAllocator::removeFree(uint32_t node)
+{
+    Node &n = nodes[node];
+    if (n.prevFree != INVALID_NODE)
+        nodes[n.prevFree].nextFree = n.nextFree;
+    if (n.nextFree != INVALID_NODE)
+        nodes[n.nextFree].prevFree = n.prevFree;
+
+    uint32_t fl, sl;
+    mapping(n.size, fl, sl);
+    if (freeLists[fl][sl] == node)
+    {
+        freeLists[fl][sl] = n.nextFree;
+        if (n.nextFree == INVALID_NODE)
+        {
+            slBitmap[fl] &= ~(1u << sl);
+            if (slBitmap[fl] == 0)
+                flBitmap &= ~(1ull << fl);
+        }
+    }
+
+    n.prevFree = INVALID_NODE;
+    n.nextFree = INVALID_NODE;
+}
+
+uint32_t TlsfAllocator::findFree(uint64_t size) const
+{
+    // Arredonda para o início da próxima faixa: qualquer nó da lista encontrada comporta o pedido
+    if (size >= SL_COUNT)
+        size += (1ull << (highestBit(size) - SL_BITS)) - 1;
+
+    uint32_t fl, sl;
+    mapping(size, fl, sl);
+    if (fl >= FL_COUNT)
+        return INVALID_NODE;
+
+    uint32_t slMap = sl < 32 ? slBitmap[fl] & (~0u << sl) : 0;
+    if (slMap == 0)
+    {
+        uint64_t flMap = fl + 1 < 64 ? flBitmap & (~0ull << (fl + 1)) : 0;
+        if (flMap == 0)
+            return INVALID_NODE;
+
+        fl = lowestBit(flMap);
+        slMap = slBitmap[fl];
+    }
+
+    return freeLists[fl][lowestBit(slMap)];
+}
+
+void TlsfAllocator::mergeWithNext(uint32_t node)
+{
+    uint32_t next = nodes[node].nextPhysical;
+    nodes[node].size += nodes[next].size;
+    nodes[node].nextPhysical = nodes[next].nextPhysical;
+    if (nodes[next].nextPhysical != INVALID_NODE)
+        nodes[nodes[next].nextPhysical].prevPhysical = node;
+
+    releaseNode(next);
+}
+
+uint32_t TlsfAllocator::allocate(uint64_t requestSize, uint64_t alignment, uint64_t &offset)
+{
+    requestSize = std::max<uint64_t>(requestSize, 1);
+    alignment = std::max<uint64_t>(alignment, 1);
+
+    // Pior caso do alinhamento incluído na busca, para não precisar testar vários nós
+    uint32_t node = findFree(requestSize + alignment - 1);
+    if (node == INVALID_NODE)
+        return INVALID_NODE;
+
+    removeFree(node);
+
+    uint64_t aligned = (nodes[node].offset + alignment - 1) & ~(alignment - 1);
+    uint64_t padding = aligned - nodes[node].offset;
+    if (padding > 0)
+    {
+        uint32_t prev = nodes[node].prevPhysical;
+        if (prev != INVALID_NODE && nodes[prev].free)
+        {
+            removeFree(prev);
+            nodes[prev].size += padding;
+            insertFree(prev);
+        }
+        else
+        {
+            uint32_t pad = newNode();
+            nodes[pad].offset = nodes[node].offset;
+            nodes[pad].size = padding;
+            nodes[pad].free = true;
+            nodes[pad].prevPhysical = prev;
+            nodes[pad].nextPhysical = node;
+            if (prev != INVALID_NODE)
+                nodes[prev].nextPhysical = pad;
+            nodes[node].prevPhysical = pad;
+            insertFree(pad);
+        }
+
+        nodes[node].offset = aligned;
+        nodes[node].size -= padding;
+    }
+
+    uint64_t remaining = nodes[node].size - requestSize;
+    if (remaining >= MIN_SPLIT_SIZE)
+    {
+        uint32_t tail = newNode();
+        nodes[tail].offset = nodes[node].offset + requestSize;
+        nodes[tail].size = remaining;
+        nodes[tail].free = true;
+        nodes[tail].prevPhysical = node;
+        nodes[tail].nextPhysical = nodes[node].nextPhysical;
+        if (nodes[node].nextPhysical != INVALID_NODE)
+            nodes[nodes[node].nextPhysical].prevPhysical = tail;
+        nodes[node].nextPhysical = tail;
+        nodes[node].size = requestSize;
+        insertFree(tail);
+    }
+
+    nodes[node].free = false;
+    allocationCount++;
+    usedBytes += nodes[node].size;
+
+    offset = nodes[node].offset;
+    return node;
+}
+
+void TlsfAllocator::free(uint32_t node)
+{
+    if (node >= nodes.size() || nodes[node].free || nodes[node].size == 0)
+    {
+        throw std::runtime_error("TLSF free of an invalid node!");
+    }
+
+    nodes[node].free = true;
+    allocationCount--;
+    usedBytes -= nodes[node].size;
+
+    uint32_t next = nodes[node].nextPhysical;
+    if (next != INVALID_NODE && nodes[next].free)
+    {
+        removeFree(next);
+        mergeWithNext(node);
+    }
+
+    uint32_t prev = nodes[node].prevPhysical;
+    if (prev != INVALID_NODE && nodes[prev].free)
+    {
+        removeFree(prev);
+        mergeWithNext(prev);
+        node = prev;
+    }
+
+    insertFree(node);
+}
+
+TlsfAllocator::Stats TlsfAllocator::getStats() const
+{
+    Stats stats;
+    stats.size = size;
+    stats.usedBytes = usedBytes;
+    stats.freeBytes = size - usedBytes;
+    stats.allocationCount = allocationCount;
+
+    // Nós descartados ficam com size 0; nós livres sempre têm tamanho
+    for (const Node &node : nodes)
+    {
+        if (!node.free || node.size == 0)
+            continue;
+
+        stats.freeRangeCount++;
+        stats.largestFreeRange = std::max(stats.largestFreeRange, node.size);
+    }
+
+    return stats;
+}
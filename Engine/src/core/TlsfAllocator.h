@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Two-Level Segregated Fit sobre um intervalo [0, size): só faz a contabilidade de offsets,
+// a memória em si é do chamador (um VkDeviceMemory no VulkanAllocator).
+// Alocação e liberação são O(1): o primeiro nível é a potência de 2 do tamanho, o segundo
+// divide cada potência em SL_COUNT faixas lineares; um bitmap por nível acha a lista livre.
+class TlsfAllocator
+{
+public:
+    static constexpr uint32_t INVALID_NODE = UINT32_MAX;
+
+    struct Stats
+    {
+        uint64_t size = 0;
+        uint64_t usedBytes = 0;
+        uint64_t freeBytes = 0;
+        uint64_t largestFreeRange = 0;
+        uint32_t allocationCount = 0;
+        uint32_t freeRangeCount = 0;
+    };
+
+    explicit TlsfAllocator(uint64_t size);
+
+    // Devolve o nó (para free) e o offset já alinhado; INVALID_NODE se não houver espaço
+    uint32_t allocate(uint64_t size, uint64_t alignment, uint64_t &offset);
+    void free(uint32_t node);
+
+    bool isEmpty() const { return allocationCount == 0; }
+    uint64_t getSize() const { return size; }
+    Stats getStats() const;
+
+private:
+    static constexpr uint32_t SL_BITS = 5;
+    static constexpr uint32_t SL_COUNT = 1u << SL_BITS;
+    static constexpr uint32_t FL_COUNT = 64 - SL_BITS + 1;
+    // Sobras menores que isso ficam grudadas na alocação em vez de virar um nó livre
+    static constexpr uint64_t MIN_SPLIT_SIZE = 256;
+
+    struct Node
+    {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint32_t prevPhysical = INVALID_NODE;
+        uint32_t nextPhysical = INVALID_NODE;
+        uint32_t prevFree = INVALID_NODE;
+        uint32_t nextFree = INVALID_NODE;
+        bool free = false;
+    };
+
+    static void mapping(uint64_t size, uint32_t &fl, uint32_t &sl);
+
+    uint32_t newNode();
+    void releaseNode(uint32_t node);
+    void insertFree(uint32_t node);
+    void removeFree(uint32_t node);
+    uint32_t findFree(uint64_t size) const;
+    void mergeWithNext(uint32_t node);
+
+    uint64_t size;
+    uint32_t allocationCount = 0;
+    uint64_t usedBytes = 0;
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> unusedNodes;
+
+    uint64_t flBitmap = 0;
+    uint32_t slBitmap[FL_COUNT] = {};
+    uint32_t freeLists[FL_COUNT][SL_COUNT];
+};
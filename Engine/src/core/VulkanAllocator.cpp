@@ -0,0 +1,351 @@
+#include "VulkanAllocator.h"
+#include "VulkanCore.h"
+#include "RenderCounters.h"
+#include <stdexcept>
+#include <iostream>
+#include <algorithm>
+
+VulkanAllocator::VulkanAllocator(VulkanCore &core) : core(core)
+{
+}
+
+VulkanAllocator::~VulkanAllocator()
+{
+    cleanup();
+}
+
+void VulkanAllocator::create()
+{
+    vkGetPhysicalDeviceMemoryProperties(core.getPhysicalDevice(), &memoryProperties);
+
+    if (core.isMemoryBudgetEnabled())
+    {
+        getMemoryProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceMemoryProperties2KHR>(
+            vkGetInstanceProcAddr(core.getInstance(), "vkGetPhysicalDeviceMemoryProperties2KHR"));
+    }
+}
+
+void VulkanAllocator::cleanup()
+{
+    if (core.getDevice() == VK_NULL_HANDLE)
+        return;
+
+    uint32_t leaked = 0;
+    for (Pool &pool : pools)
+    {
+        for (Block &block : pool.blocks)
+        {
+            if (block.memory == VK_NULL_HANDLE)
+                continue;
+
+            leaked += block.tlsf->getStats().allocationCount;
+            freeDeviceMemory(block.memory, pool.blockSize, pool.memoryType);
+        }
+    }
+    pools.clear();
+
+    if (leaked > 0 || dedicatedCount > 0)
+    {
+        std::cerr << "VulkanAllocator: " << leaked << " sub-allocations and " << dedicatedCount
+                  << " dedicated allocations still alive at cleanup" << std::endl;
+    }
+    dedicatedCount = 0;
+    dedicatedBytes = 0;
+    heapBytes.fill(0);
+    categoryBytes.fill(0);
+    categoryCounts.fill(0);
+}
+
+VkDeviceMemory VulkanAllocator::allocateDeviceMemory(VkDeviceSize size, uint32_t memoryType, bool hostVisible, void **mapped)
+{
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryType;
+
+    VkDeviceMemory memory;
+    *mapped = nullptr;
+    VkResult result = vkAllocateMemory(core.getDevice(), &allocInfo, nullptr, &memory);
+    if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY || result == VK_ERROR_OUT_OF_HOST_MEMORY)
+        return VK_NULL_HANDLE;
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate device memory!");
+    }
+    RenderCounters::add(RenderCounter::MemoryAllocations);
+    heapBytes[memoryProperties.memoryTypes[memoryType].heapIndex] += size;
+
+    if (hostVisible && vkMapMemory(core.getDevice(), memory, 0, VK_WHOLE_SIZE, 0, mapped) != VK_SUCCESS)
+    {
+        freeDeviceMemory(memory, size, memoryType);
+        throw std::runtime_error("failed to map device memory!");
+    }
+
+    return memory;
+}
+
+void VulkanAllocator::freeDeviceMemory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryType)
+{
+    // vkFreeMemory desfaz o mapeamento implicitamente
+    RenderCounters::add(RenderCounter::MemoryFrees);
+    vkFreeMemory(core.getDevice(), memory, nullptr);
+    heapBytes[memoryProperties.memoryTypes[memoryType].heapIndex] -= size;
+}
+
+uint32_t VulkanAllocator::getPool(uint32_t memoryType, GpuResourceKind kind)
+{
+    for (uint32_t i = 0; i < pools.size(); i++)
+    {
+        if (pools[i].memoryType == memoryType && pools[i].kind == kind)
+            return i;
+    }
+
+    Pool pool;
+    pool.memoryType = memoryType;
+    pool.kind = kind;
+    pool.hostVisible = (memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+
+    // Blocos menores em heaps pequenos (ex.: a janela BAR de 256 MB)
+    VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[memoryType].heapIndex].size;
+    pool.blockSize = pool.hostVisible ? HOST_BLOCK_SIZE : DEVICE_BLOCK_SIZE;
+    pool.blockSize = std::min(pool.blockSize, heapSize / 8);
+
+    pools.push_back(std::move(pool));
+    return static_cast<uint32_t>(pools.size() - 1);
+}
+
+bool VulkanAllocator::tryAllocate(const VkMemoryRequirements &requirements, uint32_t poolIndex, GpuAllocation &allocation)
+{
+    Pool &pool = pools[poolIndex];
+    allocation.pool = poolIndex;
+    allocation.size = requirements.size;
+
+    if (requirements.size > pool.blockSize / 2)
+    {
+        void *mapped;
+        allocation.memory = allocateDeviceMemory(requirements.size, pool.memoryType, pool.hostVisible, &mapped);
+        if (allocation.memory == VK_NULL_HANDLE)
+            return false;
+
+        allocation.mapped = mapped;
+        dedicatedCount++;
+        dedicatedBytes += requirements.size;
+        return true;
+    }
+
+    auto place = [&](uint32_t blockIndex) {
+        Block &block = pool.blocks[blockIndex];
+        VkDeviceSize offset;
+        uint32_t node = block.tlsf->allocate(requirements.size, requirements.alignment, offset);
+        if (node == TlsfAllocator::INVALID_NODE)
+            return false;
+
+        allocation.memory = block.memory;
+        allocation.offset = offset;
+        allocation.block = blockIndex;
+        allocation.node = node;
+        allocation.mapped = block.mapped ? block.mapped + offset : nullptr;
+        return true;
+    };
+
+    for (uint32_t i = 0; i < pool.blocks.size(); i++)
+    {
+        if (pool.blocks[i].memory != VK_NULL_HANDLE && place(i))
+            return true;
+    }
+
+    // Nenhum bloco comporta: abre um novo (reaproveitando uma entrada liberada)
+    uint32_t blockIndex = static_cast<uint32_t>(pool.blocks.size());
+    for (uint32_t i = 0; i < pool.blocks.size(); i++)
+    {
+        if (pool.blocks[i].memory == VK_NULL_HANDLE)
+        {
+            blockIndex = i;
+            break;
+        }
+    }
+
+    void *mapped;
+    VkDeviceMemory memory = allocateDeviceMemory(pool.blockSize, pool.memoryType, pool.hostVisible, &mapped);
+    if (memory == VK_NULL_HANDLE)
+        return false;
+
+    if (blockIndex == pool.blocks.size())
+        pool.blocks.emplace_back();
+
+    Block &block = pool.blocks[blockIndex];
+    block.memory = memory;
+    block.mapped = static_cast<char *>(mapped);
+    block.tlsf = std::make_unique<TlsfAllocator>(pool.blockSize);
+
+    if (!place(blockIndex))
+    {
+        throw std::runtime_error("failed to sub-allocate from a new memory block!");
+    }
+    return true;
+}
+
+GpuAllocation VulkanAllocator::allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties, GpuResourceKind kind,
+                                        GpuMemoryCategory category)
+{
+    uint32_t memoryType = core.findMemoryType(requirements.memoryTypeBits, properties);
+    uint32_t poolIndex = getPool(memoryType, kind);
+
+    GpuAllocation allocation;
+    allocation.category = category;
+
+    // Sem memória: o handler (residência) despeja recursos fora de vista e tentamos de novo,
+    // até ele não ter mais o que liberar
+    while (!tryAllocate(requirements, poolIndex, allocation))
+    {
+        if (!outOfMemoryHandler || !outOfMemoryHandler(requirements.size))
+        {
+            throw std::runtime_error("out of device memory!");
+        }
+    }
+
+    size_t index = static_cast<size_t>(category);
+    categoryBytes[index] += allocation.size;
+    categoryCounts[index]++;
+    return allocation;
+}
+
+void VulkanAllocator::trackExternal(GpuMemoryCategory category, uint32_t memoryType, int64_t bytes)
+{
+    size_t index = static_cast<size_t>(category);
+    uint32_t heap = memoryProperties.memoryTypes[memoryType].heapIndex;
+    if (bytes >= 0)
+    {
+        categoryBytes[index] += bytes;
+        categoryCounts[index]++;
+        heapBytes[heap] += bytes;
+    }
+    else
+    {
+        categoryBytes[index] -= -bytes;
+        categoryCounts[index]--;
+        heapBytes[heap] -= -bytes;
+    }
+}
+
+void VulkanAllocator::free(GpuAllocation &allocation)
+{
+    if (!allocation.isValid())
+        return;
+
+    size_t index = static_cast<size_t>(allocation.category);
+    categoryBytes[index] -= allocation.size;
+    categoryCounts[index]--;
+
+    if (allocation.block == UINT32_MAX)
+    {
+        freeDeviceMemory(allocation.memory, allocation.size, pools[allocation.pool].memoryType);
+        dedicatedCount--;
+        dedicatedBytes -= allocation.size;
+        allocation = GpuAllocation{};
+        return;
+    }
+
+    Pool &pool = pools[allocation.pool];
+    Block &block = pool.blocks[allocation.block];
+    block.tlsf->free(allocation.node);
+
+    // Bloco vazio volta para o driver, exceto o último vivo do pool (evita abrir/fechar a cada carga)
+    if (block.tlsf->isEmpty())
+    {
+        uint32_t liveBlocks = 0;
+        for (const Block &other : pool.blocks)
+        {
+            if (other.memory != VK_NULL_HANDLE)
+                liveBlocks++;
+        }
+
+        if (liveBlocks > 1)
+        {
+            freeDeviceMemory(block.memory, pool.blockSize, pool.memoryType);
+            block.memory = VK_NULL_HANDLE;
+            block.mapped = nullptr;
+            block.tlsf.reset();
+        }
+    }
+
+    allocation = GpuAllocation{};
+}
+
+GpuMemoryStats VulkanAllocator::getStats() const
+{
+    GpuMemoryStats stats;
+    stats.dedicatedCount = dedicatedCount;
+    stats.dedicatedBytes = dedicatedBytes;
+    stats.deviceMemoryCount = dedicatedCount;
+    stats.allocationCount = dedicatedCount;
+    stats.usedBytes = dedicatedBytes;
+    stats.reservedBytes = dedicatedBytes;
+    stats.categoryBytes = categoryBytes;
+    stats.categoryCounts = categoryCounts;
+
+    for (const Pool &pool : pools)
+    {
+        GpuMemoryPoolStats poolStats;
+        poolStats.memoryType = pool.memoryType;
+        poolStats.kind = pool.kind;
+        poolStats.hostVisible = pool.hostVisible;
+
+        uint64_t freeBytes = 0;
+        for (const Block &block : pool.blocks)
+        {
+            if (block.memory == VK_NULL_HANDLE)
+                continue;
+
+            TlsfAllocator::Stats blockStats = block.tlsf->getStats();
+            poolStats.blockCount++;
+            poolStats.blockBytes += blockStats.size;
+            poolStats.usedBytes += blockStats.usedBytes;
+            poolStats.allocationCount += blockStats.allocationCount;
+            poolStats.freeRangeCount += blockStats.freeRangeCount;
+            poolStats.largestFreeRange = std::max(poolStats.largestFreeRange, blockStats.largestFreeRange);
+            freeBytes += blockStats.freeBytes;
+        }
+
+        if (freeBytes > 0)
+            poolStats.fragmentation = 1.0f - static_cast<float>(poolStats.largestFreeRange) / static_cast<float>(freeBytes);
+
+        stats.deviceMemoryCount += poolStats.blockCount;
+        stats.allocationCount += poolStats.allocationCount;
+        stats.usedBytes += poolStats.usedBytes;
+        stats.reservedBytes += poolStats.blockBytes;
+        stats.pools.push_back(poolStats);
+    }
+
+    return stats;
+}
+
+std::vector<GpuHeapBudget> VulkanAllocator::queryBudget() const
+{
+    std::vector<GpuHeapBudget> heaps(memoryProperties.memoryHeapCount);
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++)
+    {
+        heaps[i].size = memoryProperties.memoryHeaps[i].size;
+        heaps[i].budget = heaps[i].size;
+        heaps[i].usage = heapBytes[i];
+        heaps[i].tracked = heapBytes[i];
+        heaps[i].deviceLocal = (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+    }
+
+    if (!getMemoryProperties2)
+        return heaps;
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+    budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    VkPhysicalDeviceMemoryProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    properties.pNext = &budget;
+    getMemoryProperties2(core.getPhysicalDevice(), &properties);
+
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++)
+    {
+        heaps[i].budget = budget.heapBudget[i];
+        heaps[i].usage = budget.heapUsage[i];
+    }
+    return heaps;
+}
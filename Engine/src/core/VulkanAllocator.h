@@ -0,0 +1,151 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include "TlsfAllocator.h"
+#include <array>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class VulkanCore;
+
+// Para onde vai a memória; o painel de memória e o orçamento agrupam por aqui
+enum class GpuMemoryCategory : uint32_t
+{
+    Mesh,
+    Texture,
+    Uniform,      // uniform e storage buffers de dados por frame/material
+    RenderTarget, // attachments, Hi-Z, imagens transitórias do RenderGraph
+    Staging,      // ring de upload e buffers de readback
+    Other,
+    Count
+};
+
+// Faixa de um bloco de memória do VulkanAllocator. Blocos host-visible ficam mapeados o tempo todo:
+// mapped já aponta para o offset da alocação (nunca chamar vkMapMemory na memory compartilhada).
+struct GpuAllocation
+{
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    void *mapped = nullptr;
+
+    uint32_t pool = UINT32_MAX;
+    uint32_t block = UINT32_MAX; // UINT32_MAX: alocação dedicada, dona do VkDeviceMemory
+    uint32_t node = TlsfAllocator::INVALID_NODE;
+    GpuMemoryCategory category = GpuMemoryCategory::Other;
+
+    bool isValid() const { return memory != VK_NULL_HANDLE; }
+};
+
+// Recursos lineares (buffers, imagens LINEAR) e imagens OPTIMAL nunca dividem um bloco:
+// assim bufferImageGranularity não precisa entrar no alinhamento.
+enum class GpuResourceKind : uint32_t
+{
+    Linear,
+    Optimal
+};
+
+struct GpuMemoryPoolStats
+{
+    uint32_t memoryType = 0;
+    GpuResourceKind kind = GpuResourceKind::Linear;
+    bool hostVisible = false;
+    uint32_t blockCount = 0;
+    uint64_t blockBytes = 0;
+    uint64_t usedBytes = 0;
+    uint32_t allocationCount = 0;
+    uint32_t freeRangeCount = 0;
+    uint64_t largestFreeRange = 0;
+    // 1 - maior faixa livre / total livre: 0 = todo o espaço livre é contíguo
+    float fragmentation = 0.0f;
+};
+
+using GpuCategoryValues = std::array<uint64_t, static_cast<size_t>(GpuMemoryCategory::Count)>;
+
+struct GpuMemoryStats
+{
+    std::vector<GpuMemoryPoolStats> pools;
+    GpuCategoryValues categoryBytes{}; // bytes pedidos pelos recursos, sem a sobra dos blocos
+    GpuCategoryValues categoryCounts{};
+    uint32_t deviceMemoryCount = 0; // vkAllocateMemory vivos (blocos + dedicadas)
+    uint32_t dedicatedCount = 0;
+    uint64_t dedicatedBytes = 0;
+    uint32_t allocationCount = 0;
+    uint64_t usedBytes = 0;
+    uint64_t reservedBytes = 0;
+};
+
+// Uso de um heap. Com VK_EXT_memory_budget, usage/budget vêm do driver (processo inteiro, inclui o que
+// não passa por aqui, como o backend do ImGui); sem ele, usage = tracked e budget = tamanho do heap.
+struct GpuHeapBudget
+{
+    VkDeviceSize size = 0;
+    VkDeviceSize budget = 0;
+    VkDeviceSize usage = 0;
+    VkDeviceSize tracked = 0; // vkAllocateMemory vivos contados por este allocator (+ externos)
+    bool deviceLocal = false;
+};
+
+// Sub-alocador de memória de dispositivo: blocos grandes por (tipo de memória, tipo de recurso)
+// e TLSF dentro de cada bloco. Pedidos maiores que metade do bloco recebem memória dedicada.
+class VulkanAllocator
+{
+public:
+    static constexpr VkDeviceSize DEVICE_BLOCK_SIZE = 64ull * 1024 * 1024;
+    static constexpr VkDeviceSize HOST_BLOCK_SIZE = 16ull * 1024 * 1024;
+
+    VulkanAllocator(VulkanCore &core);
+    ~VulkanAllocator();
+
+    // Chamado quando o driver recusa memória: libera o que puder e devolve true para tentar de novo
+    using OutOfMemoryHandler = std::function<bool(VkDeviceSize size)>;
+
+    void create();
+    void cleanup();
+
+    GpuAllocation allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties, GpuResourceKind kind,
+                           GpuMemoryCategory category = GpuMemoryCategory::Other);
+    void free(GpuAllocation &allocation);
+
+    void setOutOfMemoryHandler(OutOfMemoryHandler handler) { outOfMemoryHandler = std::move(handler); }
+    // Memória alocada fora do allocator (blocos de aliasing do RenderGraph); bytes negativo ao liberar
+    void trackExternal(GpuMemoryCategory category, uint32_t memoryType, int64_t bytes);
+
+    GpuMemoryStats getStats() const;
+    std::vector<GpuHeapBudget> queryBudget() const;
+
+private:
+    struct Block
+    {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        char *mapped = nullptr;
+        std::unique_ptr<TlsfAllocator> tlsf;
+    };
+
+    struct Pool
+    {
+        uint32_t memoryType = 0;
+        GpuResourceKind kind = GpuResourceKind::Linear;
+        bool hostVisible = false;
+        VkDeviceSize blockSize = 0;
+        std::vector<Block> blocks; // blocos liberados ficam com memory nulo e são reaproveitados
+    };
+
+    // VK_NULL_HANDLE se o driver ficou sem memória; outros erros viram exceção
+    VkDeviceMemory allocateDeviceMemory(VkDeviceSize size, uint32_t memoryType, bool hostVisible, void **mapped);
+    void freeDeviceMemory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryType);
+    bool tryAllocate(const VkMemoryRequirements &requirements, uint32_t poolIndex, GpuAllocation &allocation);
+    uint32_t getPool(uint32_t memoryType, GpuResourceKind kind);
+
+    VulkanCore &core;
+    VkPhysicalDeviceMemoryProperties memoryProperties{};
+    std::vector<Pool> pools;
+    OutOfMemoryHandler outOfMemoryHandler;
+    PFN_vkGetPhysicalDeviceMemoryProperties2KHR getMemoryProperties2 = nullptr; // só com VK_EXT_memory_budget
+
+    uint32_t dedicatedCount = 0;
+    uint64_t dedicatedBytes = 0;
+    std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> heapBytes{};
+    GpuCategoryValues categoryBytes{};
+    GpuCategoryValues categoryCounts{};
+};
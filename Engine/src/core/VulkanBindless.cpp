@@ -0,0 +1,302 @@
+#include "VulkanBindless.h"
+#include "VulkanDescriptor.h"
+#include "VulkanPipeline.h"
+#include "VulkanDeletionQueue.h"
+#include "RenderCounters.h"
+#include "../ecs/components/MaterialComponent.h"
+#include "../rendering/Texture.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <array>
+
+namespace
+{
+    // Bindings do set bindless (0 e 6 iguais ao layout por material, para reaproveitar o pbr.vert)
+    constexpr uint32_t UBO_BINDING = 0;
+    constexpr uint32_t LIGHT_BINDING = 6;
+    constexpr uint32_t MATERIAL_BINDING = 7;
+    constexpr uint32_t TEXTURE_BINDING = 8; // tamanho variável: tem que ser o último binding
+}
+
+VulkanBindless::VulkanBindless(VulkanCore &core) : core(core)
+{
+}
+
+VulkanBindless::~VulkanBindless()
+{
+    cleanup();
+}
+
+void VulkanBindless::create()
+{
+    enabled = core.isDescriptorIndexingEnabled();
+    if (!enabled)
+        return;
+
+    stats.textureCapacity = queryTextureCapacity();
+    stats.materialCapacity = VulkanDescriptor::MAX_MATERIALS;
+
+    createDescriptorResources();
+    writeFrameDescriptors();
+
+    pipeline = core.getPipeline()->createMaterialPipeline(
+        pipelineLayout,
+        setLayout,
+        "engine\\shaders\\pbr.vert.spv",
+        "engine\\shaders\\pbr_bindless.frag.spv");
+}
+
+void VulkanBindless::cleanup()
+{
+    VkDevice device = core.getDevice();
+
+    // Pipeline e layout pertencem ao VulkanPipelineCache
+    pipeline = VK_NULL_HANDLE;
+    pipelineLayout = VK_NULL_HANDLE;
+
+    if (descriptorPool != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+        descriptorSet = VK_NULL_HANDLE;
+    }
+
+    if (setLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+        setLayout = VK_NULL_HANDLE;
+    }
+
+    textureSlots.clear();
+    freeTextureSlots.clear();
+    stats = {};
+    enabled = false;
+}
+
+uint32_t VulkanBindless::queryTextureCapacity()
+{
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProperties{};
+    indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+
+    VkPhysicalDeviceProperties2KHR properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+    properties.pNext = &indexingProperties;
+
+    auto getProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(
+        vkGetInstanceProcAddr(core.getInstance(), "vkGetPhysicalDeviceProperties2KHR"));
+    if (!getProperties2)
+        throw std::runtime_error("vkGetPhysicalDeviceProperties2KHR not available!");
+
+    getProperties2(core.getPhysicalDevice(), &properties);
+
+    // Combined image sampler conta como sampler e como sampled image; os UBOs do set não competem com eles
+    return std::min({MAX_TEXTURES,
+                     indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                     indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers,
+                     indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+                     indexingProperties.maxDescriptorSetUpdateAfterBindSamplers});
+}
+
+void VulkanBindless::createDescriptorResources()
+{
+    VkDevice device = core.getDevice();
+
+    std::array<VkDescriptorSetLayoutBinding, 4> bindings = {{
+        {UBO_BINDING, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
+        {LIGHT_BINDING, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
+        {MATERIAL_BINDING, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
+        {TEXTURE_BINDING, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, stats.textureCapacity, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
+    }};
+
+    // Texturas novas são escritas com o set já ligado (e com o frame anterior ainda na GPU);
+    // slots nunca escritos ficam vazios sem invalidar o set
+    std::array<VkDescriptorBindingFlagsEXT, 4> bindingFlags = {
+        0u,
+        0u,
+        0u,
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+            VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT |
+            VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT_EXT,
+    };
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+    bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &bindingFlagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &setLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create bindless descriptor set layout!");
+    }
+
+    // Pool próprio com um único set: os limites fixos do pool de materiais não se aplicam aqui
+    std::array<VkDescriptorPoolSize, 3> poolSizes = {{
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, stats.textureCapacity},
+    }};
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create bindless descriptor pool!");
+    }
+
+    VkDescriptorSetVariableDescriptorCountAllocateInfoEXT variableCountInfo{};
+    variableCountInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO_EXT;
+    variableCountInfo.descriptorSetCount = 1;
+    variableCountInfo.pDescriptorCounts = &stats.textureCapacity;
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.pNext = &variableCountInfo;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &setLayout;
+
+    RenderCounters::add(RenderCounter::DescriptorSetsAllocated, allocInfo.descriptorSetCount);
+    if (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate bindless descriptor set!");
+    }
+}
+
+void VulkanBindless::writeFrameDescriptors()
+{
+    VulkanDescriptor *descriptor = core.getDescriptor();
+
+    VkDescriptorBufferInfo uboInfo = descriptor->getBufferInfo(descriptor->uniformBuffer, sizeof(UBO));
+    VkDescriptorBufferInfo lightInfo = descriptor->getBufferInfo(descriptor->lightBuffer, sizeof(LightUBO));
+    VkDescriptorBufferInfo materialInfo =
+        descriptor->getBufferInfo(descriptor->materialBuffer, sizeof(GPUMaterial) * VulkanDescriptor::MAX_MATERIALS);
+
+    std::array<VkWriteDescriptorSet, 3> writes{};
+    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[0].dstSet = descriptorSet;
+    writes[0].dstBinding = UBO_BINDING;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    writes[0].descriptorCount = 1;
+    writes[0].pBufferInfo = &uboInfo;
+
+    writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[1].dstSet = descriptorSet;
+    writes[1].dstBinding = LIGHT_BINDING;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    writes[1].descriptorCount = 1;
+    writes[1].pBufferInfo = &lightInfo;
+
+    writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[2].dstSet = descriptorSet;
+    writes[2].dstBinding = MATERIAL_BINDING;
+    writes[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[2].descriptorCount = 1;
+    writes[2].pBufferInfo = &materialInfo;
+
+    vkUpdateDescriptorSets(core.getDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+uint32_t VulkanBindless::registerTexture(const Texture &texture)
+{
+    auto it = textureSlots.find(&texture);
+    if (it != textureSlots.end())
+        return it->second;
+
+    if (freeTextureSlots.empty() && stats.textureCount >= stats.textureCapacity)
+    {
+        throw std::runtime_error("bindless texture array is full!");
+    }
+
+    uint32_t slot;
+    if (!freeTextureSlots.empty())
+    {
+        slot = freeTextureSlots.back();
+        freeTextureSlots.pop_back();
+    }
+    else
+    {
+        slot = stats.textureCount++;
+    }
+    writeTexture(slot, texture);
+
+    textureSlots.emplace(&texture, slot);
+    return slot;
+}
+
+void VulkanBindless::refreshTexture(const Texture &texture)
+{
+    // UPDATE_UNUSED_WHILE_PENDING: vale enquanto o frame em voo não amostra esta textura
+    auto it = textureSlots.find(&texture);
+    if (it != textureSlots.end())
+        writeTexture(it->second, texture);
+}
+
+void VulkanBindless::releaseTexture(const Texture &texture)
+{
+    auto it = textureSlots.find(&texture);
+    if (it == textureSlots.end())
+        return;
+
+    // O endereço pode ser reaproveitado por outra textura logo: sai do mapa agora, o slot só depois da fence
+    uint32_t slot = it->second;
+    textureSlots.erase(it);
+    core.getDeletionQueue()->push([this, slot] { freeTextureSlots.push_back(slot); });
+}
+
+void VulkanBindless::writeTexture(uint32_t slot, const Texture &texture)
+{
+    VkDescriptorImageInfo imageInfo = texture.getDescriptorInfo();
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = descriptorSet;
+    write.dstBinding = TEXTURE_BINDING;
+    write.dstArrayElement = slot;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.descriptorCount = 1;
+    write.pImageInfo = &imageInfo;
+
+    vkUpdateDescriptorSets(core.getDevice(), 1, &write, 0, nullptr);
+}
+
+void VulkanBindless::registerMaterial(MaterialComponent &material)
+{
+    material.materialIndex = core.getDescriptor()->allocateMaterial();
+    stats.materialCount = core.getDescriptor()->getMaterialCount();
+    updateMaterial(material);
+}
+
+void VulkanBindless::updateMaterial(const MaterialComponent &material)
+{
+    // Mapas ausentes apontam para as texturas padrão compartilhadas: o slot já existe, nenhuma escrita nova
+    GPUMaterial gpuMaterial = material.getGpuParameters();
+    gpuMaterial.albedoTexture = registerTexture(*material.albedoMap);
+    gpuMaterial.normalTexture = registerTexture(*material.normalMap);
+    gpuMaterial.metallicRoughnessTexture = registerTexture(*material.metallicRoughnessMap);
+    gpuMaterial.aoTexture = registerTexture(*material.aoMap);
+    gpuMaterial.emissiveTexture = registerTexture(*material.emissiveMap);
+
+    core.getDescriptor()->writeMaterial(material.materialIndex, gpuMaterial);
+}
+
+void VulkanBindless::bind(VkCommandBuffer commandBuffer)
+{
+    RenderCounters::add(RenderCounter::PipelineBinds);
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    RenderCounters::add(RenderCounter::DescriptorBinds);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+}
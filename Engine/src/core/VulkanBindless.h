@@ -0,0 +1,72 @@
+#pragma once
+#include "VulkanCore.h"
+#include "VulkanTypes.h"
+#include <unordered_map>
+
+class Texture;
+struct MaterialComponent;
+
+struct BindlessStats
+{
+    uint32_t textureCount = 0;
+    uint32_t textureCapacity = 0;
+    uint32_t materialCount = 0;
+    uint32_t materialCapacity = 0;
+};
+
+// Modo bindless (VK_EXT_descriptor_indexing): um único set com os dados do frame, o buffer de materiais
+// (do VulkanDescriptor) e um array grande de texturas, ligado uma vez por frame. O material vira só um
+// índice (push constant) para um GPUMaterial com os índices das suas texturas.
+class VulkanBindless
+{
+public:
+    VulkanBindless(VulkanCore &core);
+    ~VulkanBindless();
+
+    void create();
+    void cleanup();
+
+    // Sem suporte a descriptor indexing os materiais continuam com um set próprio cada
+    bool isEnabled() const { return enabled; }
+
+    // Uma escrita de descriptor por textura nova; texturas repetidas devolvem o mesmo slot
+    uint32_t registerTexture(const Texture &texture);
+    // A textura trocou de imagem (despejo/recarga): reescreve o slot dela, se tiver um
+    void refreshTexture(const Texture &texture);
+    // A textura saiu do cache do TextureManager: o slot volta a ficar livre depois do frame em voo
+    void releaseTexture(const Texture &texture);
+
+    // Registra as texturas do material, grava o GPUMaterial e preenche material.materialIndex
+    void registerMaterial(MaterialComponent &material);
+    void updateMaterial(const MaterialComponent &material);
+
+    // Pipeline e set compartilhados por todos os materiais
+    void bind(VkCommandBuffer commandBuffer);
+
+    VkPipeline getPipeline() const { return pipeline; }
+    VkPipelineLayout getPipelineLayout() const { return pipelineLayout; }
+    VkDescriptorSetLayout getDescriptorSetLayout() const { return setLayout; }
+    const BindlessStats &getStats() const { return stats; }
+
+private:
+    static constexpr uint32_t MAX_TEXTURES = 16384;
+
+    uint32_t queryTextureCapacity();
+    void createDescriptorResources();
+    void writeFrameDescriptors();
+    void writeTexture(uint32_t slot, const Texture &texture);
+
+    VulkanCore &core;
+    bool enabled = false;
+    BindlessStats stats;
+
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+
+    // Pela textura, não pela view: a view muda quando a textura é despejada ou recarregada
+    std::unordered_map<const Texture *, uint32_t> textureSlots;
+    std::vector<uint32_t> freeTextureSlots;
+};
@@ -5,15 +5,34 @@
 #include <string>
 #include <fstream>
 #include <cstring>
+#include <algorithm>
+#include <cmath>
 #include <magic_enum.hpp>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
 #include "VulkanSwapChain.h"
 #include "VulkanPipeline.h"
 #include "VulkanDescriptor.h"
+#include "VulkanOcclusion.h"
+#include "VulkanBindless.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanAllocator.h"
+#include "VulkanUploadContext.h"
+#include "VulkanMeshPool.h"
+#include "VulkanResidency.h"
+#include "VulkanDeletionQueue.h"
+#include "VulkanProfiler.h"
+#include "CpuProfiler.h"
+#include "RenderCounters.h"
+#include "RenderGraph.h"
 #include "VulkanRenderer.h"
+#include "Scene.h"
+#include "ecs/components/CameraComponent.h"
 #include "project/projectManagment.h"
 
 void VulkanCore::init(GLFWwindow *window)
@@ -24,35 +43,260 @@ void VulkanCore::init(GLFWwindow *window)
     createSurface();
     pickPhysicalDevice();
     createLogicalDevice();
+
+    allocator = std::make_unique<VulkanAllocator>(*this);
+    allocator->create();
+
     createCommandPool();
     createTextureSampler();
 
+    // Antes de qualquer subsistema que destrua recursos em uso pela GPU
+    deletionQueue = std::make_unique<VulkanDeletionQueue>(*this);
+    deletionQueue->create();
+
+    uploadContext = std::make_unique<VulkanUploadContext>(*this);
+    uploadContext->create();
+
+    meshPool = std::make_unique<VulkanMeshPool>(*this);
+    meshPool->create();
+
+    // Instala o handler de falta de memória do allocator
+    residency = std::make_unique<VulkanResidency>(*this);
+    residency->create();
+
+    // Antes de qualquer pipeline: todos compilam contra o VkPipelineCache carregado do disco
+    pipelineCache = std::make_unique<VulkanPipelineCache>(*this);
+    pipelineCache->create();
+
     swapChain = std::make_unique<VulkanSwapChain>(*this);
     pipeline = std::make_unique<VulkanPipeline>(*this);
     descriptor = std::make_unique<VulkanDescriptor>(*this);
 
-    createDepthResources();
     swapChain->create();
     descriptor->createDescriptorSetLayout();
     descriptor->create();
     createRenderPass();
     createSceneRenderPass();
     pipeline->create(renderPass, swapChain->getExtent());
-    createSceneResources();
     createSceneDescriptorSet();
-    createFramebuffers();
     createCommandBuffers();
     createSyncObjects();
 
+    occlusion = std::make_unique<VulkanOcclusion>(*this);
+    occlusion->create(getSceneExtent());
+
+    bindless = std::make_unique<VulkanBindless>(*this);
+    bindless->create();
+
+    profiler = std::make_unique<VulkanProfiler>(*this);
+    profiler->create();
+
     scene = std::make_unique<Scene>(this);
 
     imgui = std::make_unique<VulkanImGui>(this);
     imgui->init(renderPass);
 
-    descriptor->createUniformBuffer(device, physicalDevice, sizeof(UBO),
-                                    VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                                    descriptor->uniformBuffer, descriptor->uniformBufferMemory);
+    renderGraph = std::make_unique<RenderGraph>(*this);
+    buildRenderGraph();
+}
+
+void VulkanCore::initHeadless(VkExtent2D extent, bool readback)
+{
+    headless = true;
+    headlessExtent = extent;
+    window = nullptr;
+
+    createInstance();
+    setupDebugMessenger();
+    pickPhysicalDevice();
+    createLogicalDevice();
+
+    allocator = std::make_unique<VulkanAllocator>(*this);
+    allocator->create();
+
+    createCommandPool();
+    createTextureSampler();
+
+    // Antes de qualquer subsistema que destrua recursos em uso pela GPU
+    deletionQueue = std::make_unique<VulkanDeletionQueue>(*this);
+    deletionQueue->create();
+
+    uploadContext = std::make_unique<VulkanUploadContext>(*this);
+    uploadContext->create();
+
+    meshPool = std::make_unique<VulkanMeshPool>(*this);
+    meshPool->create();
+
+    // Instala o handler de falta de memória do allocator
+    residency = std::make_unique<VulkanResidency>(*this);
+    residency->create();
+
+    // Antes de qualquer pipeline: todos compilam contra o VkPipelineCache carregado do disco
+    pipelineCache = std::make_unique<VulkanPipelineCache>(*this);
+    pipelineCache->create();
+
+    pipeline = std::make_unique<VulkanPipeline>(*this);
+    descriptor = std::make_unique<VulkanDescriptor>(*this);
+
+    descriptor->createDescriptorSetLayout();
+    descriptor->create();
+    createRenderPass();
+    createSceneRenderPass();
+    pipeline->create(renderPass, extent);
+    createSceneDescriptorSet();
+    createCommandBuffers();
+    createSyncObjects();
+
+    if (readback)
+    {
+        createReadbackBuffer();
+    }
+
+    occlusion = std::make_unique<VulkanOcclusion>(*this);
+    occlusion->create(extent);
+
+    bindless = std::make_unique<VulkanBindless>(*this);
+    bindless->create();
+
+    profiler = std::make_unique<VulkanProfiler>(*this);
+    profiler->create();
+
+    scene = std::make_unique<Scene>(this);
+
+    // Sem ImGui: o grafo termina no pass de cena (e na cópia para o buffer de readback)
+    renderGraph = std::make_unique<RenderGraph>(*this);
+    buildRenderGraph();
+}
+
+VkExtent2D VulkanCore::getRenderExtent() const
+{
+    return headless ? headlessExtent : swapChain->getExtent();
+}
+
+VkExtent2D VulkanCore::getSceneExtent() const
+{
+    // O readback do headless tem o tamanho fixo da imagem de saída
+    if (headless)
+        return headlessExtent;
+
+    // Antes da primeira janela "Scene" ser desenhada, usa o tamanho da swapchain
+    VkExtent2D base = sceneViewportSize.width > 0 && sceneViewportSize.height > 0 ? sceneViewportSize : swapChain->getExtent();
+    return {std::max(1u, static_cast<uint32_t>(base.width * renderScale + 0.5f)),
+            std::max(1u, static_cast<uint32_t>(base.height * renderScale + 0.5f))};
+}
+
+void VulkanCore::setSceneViewportSize(VkExtent2D size)
+{
+    if (size.width == 0 || size.height == 0)
+        return;
+    if (size.width == sceneViewportSize.width && size.height == sceneViewportSize.height)
+        return;
+
+    sceneViewportSize = size;
+
+    // A projeção segue a proporção do viewport, não a da janela
+    if (scene && scene->cameraEntity)
+    {
+        scene->cameraEntity->getComponent<CameraComponent>().setAspectRatio(static_cast<float>(size.width),
+                                                                            static_cast<float>(size.height));
+    }
+}
+
+void VulkanCore::setRenderScale(float scale)
+{
+    scale = std::round(scale / RENDER_SCALE_STEP) * RENDER_SCALE_STEP;
+    renderScale = std::clamp(scale, 0.25f, 2.0f);
+}
+
+void VulkanCore::updateDynamicResolution()
+{
+    framesSinceScaleChange++;
+    if (!dynamicResolution.enabled || headless || !profiler || !profiler->isSupported())
+        return;
+
+    // Espera o histórico refletir a escala atual antes de decidir de novo
+    const std::deque<float> &history = profiler->getFrameHistory();
+    if (framesSinceScaleChange < DYNAMIC_RESOLUTION_INTERVAL || history.size() < VulkanProfiler::LATENCY + 8)
+        return;
+
+    float average = 0.0f;
+    const size_t samples = 8;
+    for (size_t i = history.size() - samples; i < history.size(); i++)
+        average += history[i];
+    average /= samples;
+
+    // Zona morta de 10% para não oscilar entre dois degraus
+    const float target = dynamicResolution.targetGpuMs;
+    if (average <= 0.0f || std::abs(average - target) < target * 0.1f)
+        return;
+
+    // O custo é aproximadamente proporcional ao número de pixels (escala ao quadrado)
+    float scale = renderScale * std::sqrt(target / average);
+    scale = std::clamp(scale, dynamicResolution.minScale, dynamicResolution.maxScale);
+
+    float previous = renderScale;
+    setRenderScale(scale);
+    if (renderScale != previous)
+        framesSinceScaleChange = 0;
+}
+
+bool VulkanCore::sceneTargetsOutdated() const
+{
+    VkExtent2D extent = getSceneExtent();
+    return extent.width != graphSceneExtent.width || extent.height != graphSceneExtent.height;
+}
+
+void VulkanCore::recreateSceneTargets()
+{
+    // Grafo e pirâmide antigos saem pela fila de destruição quando o frame em voo terminar
+    renderGraph->reset();
+    occlusion->recreate(getSceneExtent());
+    buildRenderGraph();
+}
+
+VkFormat VulkanCore::getBackbufferFormat() const
+{
+    return headless ? VK_FORMAT_B8G8R8A8_SRGB : swapChain->getImageFormat();
+}
+
+void VulkanCore::createReadbackBuffer()
+{
+    VkDeviceSize size = static_cast<VkDeviceSize>(headlessExtent.width) * headlessExtent.height * 4;
+
+    createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 readbackBuffer, readbackMemory, GpuMemoryCategory::Staging);
+
+    readbackMapped = readbackMemory.mapped;
+}
+
+void VulkanCore::saveReadbackImage(const std::string &path)
+{
+    if (!readbackMapped)
+    {
+        throw std::runtime_error("headless readback was not enabled!");
+    }
+
+    vkDeviceWaitIdle(device);
+
+    // A cor da cena é B8G8R8A8 (já em sRGB); o PNG espera RGBA
+    const uint32_t width = headlessExtent.width;
+    const uint32_t height = headlessExtent.height;
+    const uint8_t *src = static_cast<const uint8_t *>(readbackMapped);
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+
+    for (size_t i = 0; i < pixels.size(); i += 4)
+    {
+        pixels[i + 0] = src[i + 2];
+        pixels[i + 1] = src[i + 1];
+        pixels[i + 2] = src[i + 0];
+        pixels[i + 3] = src[i + 3];
+    }
+
+    if (!stbi_write_png(path.c_str(), static_cast<int>(width), static_cast<int>(height), 4, pixels.data(), static_cast<int>(width * 4)))
+    {
+        throw std::runtime_error("failed to write " + path);
+    }
 }
 
 void VulkanCore::createInstance()
@@ -128,14 +372,24 @@ void VulkanCore::pickPhysicalDevice()
     vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
 
     std::string errorMessages;
+    VkPhysicalDevice fallback = VK_NULL_HANDLE;
 
     for (const auto& device : devices)
     {
         std::string reason;
         if (isDeviceSuitable(device, &reason))
         {
-            physicalDevice = device;
-            return;
+            // Headless aceita qualquer ICD (lavapipe incluso), mas prefere uma GPU dedicada
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(device, &properties);
+            if (!headless || properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+            {
+                physicalDevice = device;
+                return;
+            }
+
+            if (fallback == VK_NULL_HANDLE)
+                fallback = device;
         }
         else
         {
@@ -143,6 +397,12 @@ void VulkanCore::pickPhysicalDevice()
         }
     }
 
+    if (fallback != VK_NULL_HANDLE)
+    {
+        physicalDevice = fallback;
+        return;
+    }
+
     throw std::runtime_error("Nenhuma GPU adequada foi encontrada:\n" + errorMessages);
 }
 
@@ -156,6 +416,8 @@ void VulkanCore::createLogicalDevice()
     std::set<uint32_t> uniqueQueueFamilies = {
         indices.graphicsFamily.value(),
         indices.presentFamily.value()};
+    if (indices.transferFamily)
+        uniqueQueueFamilies.insert(indices.transferFamily.value());
 
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -168,24 +430,63 @@ void VulkanCore::createLogicalDevice()
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
     VkPhysicalDeviceFeatures deviceFeatures{};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
+    // Contagem exata de amostras na occlusion query (estatística de overdraw)
+    deviceFeatures.occlusionQueryPrecise = supportedFeatures.occlusionQueryPrecise;
+    // Invocações de vertex/fragment por frame (VulkanProfiler)
+    deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+    // Texturas importadas em BC1/BC3/BC5/BC7 (TextureManager); sem a feature ficam em RGBA8
+    deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+
+    // Headless não tem swapchain
+    std::vector<const char *> extensions = headless ? std::vector<const char *>{} : deviceExtensions;
+
+    // Bindless: só as features usadas pelo VulkanBindless; sem elas fica o set por material
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    descriptorIndexingEnabled = queryDescriptorIndexingSupport();
+    if (descriptorIndexingEnabled)
+    {
+        extensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+        extensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+        indexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        indexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+        indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+        indexingFeatures.descriptorBindingVariableDescriptorCount = VK_TRUE;
+        indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+    }
+
+    // Só consultas: sem features para habilitar
+    memoryBudgetEnabled = queryMemoryBudgetSupport();
+    if (memoryBudgetEnabled)
+        extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = descriptorIndexingEnabled ? &indexingFeatures : nullptr;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
 
     if (vkCreateDevice(physicalDevice, &createInfo, nullptr, &device) != VK_SUCCESS)
     {
         throw std::runtime_error("failed to create logical device!");
     }
 
+    enabledFeatures = deviceFeatures;
+
     vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, &graphicsQueue);
     vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
+    transferQueue = graphicsQueue;
+    if (indices.transferFamily)
+        vkGetDeviceQueue(device, indices.transferFamily.value(), 0, &transferQueue);
 }
 
 void VulkanCore::createSurface()
@@ -198,60 +499,32 @@ void VulkanCore::createSurface()
 
 void VulkanCore::createRenderPass()
 {
+    // Compatível com o pass de UI do RenderGraph (só a imagem da swapchain); usado pelo ImGui
     VkAttachmentDescription colorAttachment{};
-    colorAttachment.format = VK_FORMAT_B8G8R8A8_SRGB;
+    colorAttachment.format = getBackbufferFormat();
     colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
     colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
     colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-    VkAttachmentDescription depthAttachment{};
-    depthAttachment.format = findDepthFormat();
-    depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
     VkAttachmentReference colorAttachmentRef{};
     colorAttachmentRef.attachment = 0;
     colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
-    VkAttachmentReference depthAttachmentRef{};
-    depthAttachmentRef.attachment = 1;
-    depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
     VkSubpassDescription subpass{};
     subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     subpass.colorAttachmentCount = 1;
     subpass.pColorAttachments = &colorAttachmentRef;
-    subpass.pDepthStencilAttachment = &depthAttachmentRef;
-
-    VkSubpassDependency dependency{};
-    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-    dependency.dstSubpass = 0;
-    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
-                              VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
-                              VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependency.srcAccessMask = 0;
-    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
-                               VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
-    std::array<VkAttachmentDescription, 2> attachments = {colorAttachment, depthAttachment};
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-    renderPassInfo.pAttachments = attachments.data();
+    renderPassInfo.attachmentCount = 1;
+    renderPassInfo.pAttachments = &colorAttachment;
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = 1;
-    renderPassInfo.pDependencies = &dependency;
 
     if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
     {
@@ -259,32 +532,6 @@ void VulkanCore::createRenderPass()
     }
 }
 
-void VulkanCore::createFramebuffers()
-{
-    framebuffers.resize(swapChain->getImageCount());
-
-    for (size_t i = 0; i < swapChain->getImageCount(); i++)
-    {
-        std::array<VkImageView, 2> attachments = {
-            swapChain->getImageViews()[i],
-            depthImageView};
-
-        VkFramebufferCreateInfo framebufferInfo{};
-        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        framebufferInfo.renderPass = renderPass;
-        framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-        framebufferInfo.pAttachments = attachments.data();
-        framebufferInfo.width = swapChain->getExtent().width;
-        framebufferInfo.height = swapChain->getExtent().height;
-        framebufferInfo.layers = 1;
-
-        if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &framebuffers[i]) != VK_SUCCESS)
-        {
-            throw std::runtime_error("failed to create framebuffer!");
-        }
-    }
-}
-
 void VulkanCore::createCommandPool()
 {
     QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
@@ -344,13 +591,61 @@ void VulkanCore::createSyncObjects()
     }
 }
 
+void VulkanCore::beginFrame()
+{
+    {
+        PROFILE_ZONE("WaitForFence");
+        vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    }
+
+    // Destruições pedidas até o frame que a fence acabou de liberar
+    deletionQueue->update();
+    // Recargas e despejos do orçamento de memória; os uploads deles entram no lote abaixo
+    residency->update();
+    // Texturas decodificadas pelos workers trocam o placeholder; os uploads também entram no lote
+    if (TextureManager *textures = VulkanRenderer::getInstance().getTextureManager())
+        textures->update();
+    // Uploads gravados desde o último frame vão antes do frame na fila gráfica
+    uploadContext->update();
+    // GPU terminou o frame anterior: páginas aposentadas podem ser liberadas; entidades removidas saem
+    // da cena agora e liberam os recursos pela fila de destruição
+    meshPool->update();
+    scene->destroyPendingEntities();
+}
+
+void VulkanCore::updateFrameTargets()
+{
+    // Trocar o modo de oclusão adiciona/remove passes; a fence garante que a GPU terminou o frame anterior
+    updateDynamicResolution();
+    if (sceneTargetsOutdated())
+    {
+        recreateSceneTargets();
+    }
+    else if (occlusion->isPrepassEnabled() != graphPrepassEnabled || occlusion->isHiZEnabled() != graphHiZEnabled)
+    {
+        buildRenderGraph();
+    }
+}
+
 void VulkanCore::renderFrame()
 {
-    vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    if (headless)
+    {
+        renderHeadlessFrame();
+        return;
+    }
+
+    PROFILE_ZONE("VulkanCore::renderFrame");
+
+    beginFrame();
 
     uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(device, swapChain->getSwapChain(), UINT64_MAX,
-                                            imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+    VkResult result;
+    {
+        PROFILE_ZONE("AcquireNextImage");
+        result = vkAcquireNextImageKHR(device, swapChain->getSwapChain(), UINT64_MAX,
+                                       imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+    }
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR)
     {
@@ -362,10 +657,15 @@ void VulkanCore::renderFrame()
         throw std::runtime_error("failed to acquire swap chain image!");
     }
 
+    updateFrameTargets();
+
     vkResetFences(device, 1, &inFlightFences[currentFrame]);
 
-    vkResetCommandBuffer(commandBuffers[currentFrame], 0);
-    recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
+    {
+        PROFILE_ZONE("RecordCommandBuffer");
+        vkResetCommandBuffer(commandBuffers[currentFrame], 0);
+        recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
+    }
 
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -382,9 +682,12 @@ void VulkanCore::renderFrame()
     submitInfo.signalSemaphoreCount = 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
-    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS)
     {
-        throw std::runtime_error("failed to submit draw command buffer!");
+        PROFILE_ZONE("QueueSubmit");
+        if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to submit draw command buffer!");
+        }
     }
 
     VkPresentInfoKHR presentInfo{};
@@ -397,7 +700,10 @@ void VulkanCore::renderFrame()
     presentInfo.pSwapchains = swapChains;
     presentInfo.pImageIndices = &imageIndex;
 
-    result = vkQueuePresentKHR(presentQueue, &presentInfo);
+    {
+        PROFILE_ZONE("QueuePresent");
+        result = vkQueuePresentKHR(presentQueue, &presentInfo);
+    }
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
     {
@@ -409,11 +715,51 @@ void VulkanCore::renderFrame()
     }
 
     currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+
+    pipelineCache->update();
+
+    // Draws gravados neste frame + criações/uploads desde o anterior
+    RenderCounters::endFrame();
+}
+
+void VulkanCore::renderHeadlessFrame()
+{
+    PROFILE_ZONE("VulkanCore::renderHeadlessFrame");
+
+    // Mesmo fluxo do renderFrame, sem acquire/present: só a fence separa os frames
+    beginFrame();
+
+    updateFrameTargets();
+
+    vkResetFences(device, 1, &inFlightFences[currentFrame]);
+
+    {
+        PROFILE_ZONE("RecordCommandBuffer");
+        vkResetCommandBuffer(commandBuffers[currentFrame], 0);
+        recordCommandBuffer(commandBuffers[currentFrame], 0);
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
+
+    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to submit draw command buffer!");
+    }
+
+    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+
+    pipelineCache->update();
+
+    // Draws gravados neste frame + criações/uploads desde o anterior
+    RenderCounters::endFrame();
 }
 
 void VulkanCore::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
                               VkMemoryPropertyFlags properties, VkBuffer &buffer,
-                              VkDeviceMemory &bufferMemory)
+                              GpuAllocation &bufferMemory, GpuMemoryCategory category)
 {
     VkBufferCreateInfo bufferInfo{};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -421,6 +767,7 @@ void VulkanCore::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
     bufferInfo.usage = usage;
     bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+    RenderCounters::add(RenderCounter::BuffersCreated);
     if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
     {
         throw std::runtime_error("failed to create buffer!");
@@ -429,25 +776,34 @@ void VulkanCore::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
     VkMemoryRequirements memRequirements;
     vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
 
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
+    bufferMemory = allocator->allocate(memRequirements, properties, GpuResourceKind::Linear, category);
+    if (vkBindBufferMemory(device, buffer, bufferMemory.memory, bufferMemory.offset) != VK_SUCCESS)
     {
-        throw std::runtime_error("failed to allocate buffer memory!");
+        allocator->free(bufferMemory);
+        throw std::runtime_error("failed to bind buffer memory!");
     }
+}
 
-    vkBindBufferMemory(device, buffer, bufferMemory, 0);
+void VulkanCore::destroyBuffer(VkBuffer &buffer, GpuAllocation &bufferMemory)
+{
+    if (buffer != VK_NULL_HANDLE)
+    {
+        RenderCounters::add(RenderCounter::BuffersDestroyed);
+        vkDestroyBuffer(device, buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
+    }
+    allocator->free(bufferMemory);
 }
 
-void VulkanCore::copyDataToBuffer(const void *data, VkDeviceMemory bufferMemory, VkDeviceSize size)
+void VulkanCore::copyDataToBuffer(const void *data, const GpuAllocation &bufferMemory, VkDeviceSize size)
 {
-    void *mapped;
-    vkMapMemory(device, bufferMemory, 0, size, 0, &mapped);
-    memcpy(mapped, data, static_cast<size_t>(size));
-    vkUnmapMemory(device, bufferMemory);
+    if (!bufferMemory.mapped)
+    {
+        throw std::runtime_error("copyDataToBuffer needs host-visible memory!");
+    }
+
+    memcpy(bufferMemory.mapped, data, static_cast<size_t>(size));
+    RenderCounters::add(RenderCounter::UploadBytes, size);
 }
 
 void VulkanCore::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
@@ -548,6 +904,7 @@ void VulkanCore::createSceneDescriptorSet()
     allocInfo.descriptorSetCount = 1;
     allocInfo.pSetLayouts = &sceneDescriptorSetLayout;
 
+    RenderCounters::add(RenderCounter::DescriptorSetsAllocated, allocInfo.descriptorSetCount);
     if (vkAllocateDescriptorSets(device, &allocInfo, &sceneDescriptorSet) != VK_SUCCESS)
     {
         throw std::runtime_error("failed to allocate descriptor set for scene!");
@@ -557,14 +914,17 @@ void VulkanCore::createSceneDescriptorSet()
     {
         throw std::runtime_error("Texture sampler is null!");
     }
+}
 
-    if (sceneImageView == VK_NULL_HANDLE)
+void VulkanCore::updateSceneDescriptorSet(VkImageView sceneView)
+{
+    if (sceneView == VK_NULL_HANDLE)
     {
         throw std::runtime_error("sceneImageView está vazio!");
     }
 
     VkDescriptorImageInfo imageInfo{};
-    imageInfo.imageView = sceneImageView;
+    imageInfo.imageView = sceneView;
     imageInfo.sampler = textureSampler;
     imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
@@ -584,8 +944,13 @@ void VulkanCore::cleanup()
 {
     // Wait for the device to finish operations before destroying resources
     vkDeviceWaitIdle(device);
+
+    // Entidades removidas nos últimos frames: liberadas enquanto a cena ainda existe
+    if (deletionQueue) {
+        deletionQueue->flush();
+    }
     
-    // Clean up material components in all entities
+    // Clean up material and mesh components in all entities
     if (scene && scene->registry)
     {
         for (const auto& entity : scene->registry->getEntities())
@@ -594,23 +959,40 @@ void VulkanCore::cleanup()
             {
                 entity->getComponent<MaterialComponent>().cleanup(device);
             }
+            if (entity->hasComponent<MeshComponent>())
+            {
+                entity->getComponent<MeshComponent>().Destroy(device, *allocator, *meshPool);
+            }
         }
     }
     
-    // Destroy framebuffers
-    for (auto framebuffer : framebuffers) {
-        if (framebuffer != VK_NULL_HANDLE) {
-            vkDestroyFramebuffer(device, framebuffer, nullptr);
-        }
+    // Imagens transitórias, framebuffers e render passes do grafo
+    if (renderGraph) {
+        renderGraph->reset();
+        renderGraph.reset();
     }
-    framebuffers.clear();
     
-    if (sceneFramebuffer != VK_NULL_HANDLE) {
-        vkDestroyFramebuffer(device, sceneFramebuffer, nullptr);
-        sceneFramebuffer = VK_NULL_HANDLE;
+    if (readbackBuffer != VK_NULL_HANDLE) {
+        destroyBuffer(readbackBuffer, readbackMemory);
+        readbackMapped = nullptr;
     }
-    
+
     // Destroy component-specific resources first
+    if (profiler) {
+        profiler->cleanup();
+        profiler.reset();
+    }
+
+    if (bindless) {
+        bindless->cleanup();
+        bindless.reset();
+    }
+
+    if (occlusion) {
+        occlusion->cleanup();
+        occlusion.reset();
+    }
+
     if (imgui) {
         imgui->cleanup();
         imgui.reset();
@@ -626,44 +1008,18 @@ void VulkanCore::cleanup()
         pipeline->cleanup();
         pipeline.reset();
     }
+
+    // Depois de materiais, bindless e pipelines fixos: nada mais referencia os objetos do cache
+    if (pipelineCache) {
+        pipelineCache->cleanup();
+        pipelineCache.reset();
+    }
     
     if (swapChain) {
         swapChain->cleanup();
         swapChain.reset();
     }
     
-    // Destroy image views
-    if (sceneImageView != VK_NULL_HANDLE) {
-        vkDestroyImageView(device, sceneImageView, nullptr);
-        sceneImageView = VK_NULL_HANDLE;
-    }
-    
-    if (depthImageView != VK_NULL_HANDLE) {
-        vkDestroyImageView(device, depthImageView, nullptr);
-        depthImageView = VK_NULL_HANDLE;
-    }
-    
-    // Destroy images and free memory
-    if (sceneImage != VK_NULL_HANDLE) {
-        vkDestroyImage(device, sceneImage, nullptr);
-        sceneImage = VK_NULL_HANDLE;
-    }
-    
-    if (sceneImageMemory != VK_NULL_HANDLE) {
-        vkFreeMemory(device, sceneImageMemory, nullptr);
-        sceneImageMemory = VK_NULL_HANDLE;
-    }
-    
-    if (depthImage != VK_NULL_HANDLE) {
-        vkDestroyImage(device, depthImage, nullptr);
-        depthImage = VK_NULL_HANDLE;
-    }
-    
-    if (depthImageMemory != VK_NULL_HANDLE) {
-        vkFreeMemory(device, depthImageMemory, nullptr);
-        depthImageMemory = VK_NULL_HANDLE;
-    }
-    
     // Destroy descriptor set layouts
     if (sceneDescriptorSetLayout != VK_NULL_HANDLE) {
         vkDestroyDescriptorSetLayout(device, sceneDescriptorSetLayout, nullptr);
@@ -675,7 +1031,7 @@ void VulkanCore::cleanup()
         vkDestroyRenderPass(device, sceneRenderPass, nullptr);
         sceneRenderPass = VK_NULL_HANDLE;
     }
-    
+
     if (renderPass != VK_NULL_HANDLE) {
         vkDestroyRenderPass(device, renderPass, nullptr);
         renderPass = VK_NULL_HANDLE;
@@ -686,6 +1042,10 @@ void VulkanCore::cleanup()
         vkDestroySampler(device, textureSampler, nullptr);
         textureSampler = VK_NULL_HANDLE;
     }
+    for (const auto &[info, sampler] : samplerCache) {
+        vkDestroySampler(device, sampler, nullptr);
+    }
+    samplerCache.clear();
     
     // Destroy command pool
     if (commandPool != VK_NULL_HANDLE) {
@@ -693,6 +1053,34 @@ void VulkanCore::cleanup()
         commandPool = VK_NULL_HANDLE;
     }
     
+    // Depois de todos que empilham destruições no cleanup; antes dos donos da memória
+    if (deletionQueue) {
+        deletionQueue->cleanup();
+        deletionQueue.reset();
+    }
+
+    if (residency) {
+        residency->cleanup();
+        residency.reset();
+    }
+
+    // Depois de todos os buffers e imagens: devolve os blocos de memória
+    if (uploadContext) {
+        uploadContext->cleanup();
+        uploadContext.reset();
+    }
+
+    // Depois do upload context: o último lote ainda pode copiar para as páginas
+    if (meshPool) {
+        meshPool->cleanup();
+        meshPool.reset();
+    }
+
+    if (allocator) {
+        allocator->cleanup();
+        allocator.reset();
+    }
+
     // Finally destroy the device
     if (device != VK_NULL_HANDLE) {
         vkDestroyDevice(device, nullptr);
@@ -717,7 +1105,11 @@ void VulkanCore::cleanup()
 }
 
 void VulkanCore::releaseResources() {
-    // Clean up material components in all entities
+    if (deletionQueue) {
+        deletionQueue->flush();
+    }
+
+    // Clean up material and mesh components in all entities
     if (scene && scene->registry)
     {
         for (const auto& entity : scene->registry->getEntities())
@@ -726,48 +1118,36 @@ void VulkanCore::releaseResources() {
             {
                 entity->getComponent<MaterialComponent>().cleanup(device);
             }
+            if (entity->hasComponent<MeshComponent>())
+            {
+                entity->getComponent<MeshComponent>().Destroy(device, *allocator, *meshPool);
+            }
         }
     }
     
-    for (auto framebuffer : framebuffers) {
-        if (framebuffer != VK_NULL_HANDLE)
-            vkDestroyFramebuffer(device, framebuffer, nullptr);
-    }
-    framebuffers.clear();
-
-    if (sceneFramebuffer != VK_NULL_HANDLE) {
-        vkDestroyFramebuffer(device, sceneFramebuffer, nullptr);
-        sceneFramebuffer = VK_NULL_HANDLE;
+    if (profiler) {
+        profiler->cleanup();
+        profiler.reset();
     }
 
-    if (sceneImageView != VK_NULL_HANDLE) {
-        vkDestroyImageView(device, sceneImageView, nullptr);
-        sceneImageView = VK_NULL_HANDLE;
+    if (bindless) {
+        bindless->cleanup();
+        bindless.reset();
     }
 
-    if (sceneImage != VK_NULL_HANDLE) {
-        vkDestroyImage(device, sceneImage, nullptr);
-        sceneImage = VK_NULL_HANDLE;
+    if (pipelineCache) {
+        pipelineCache->cleanup();
+        pipelineCache.reset();
     }
 
-    if (sceneImageMemory != VK_NULL_HANDLE) {
-        vkFreeMemory(device, sceneImageMemory, nullptr);
-        sceneImageMemory = VK_NULL_HANDLE;
+    if (occlusion) {
+        occlusion->cleanup();
+        occlusion.reset();
     }
 
-    if (depthImageView != VK_NULL_HANDLE) {
-        vkDestroyImageView(device, depthImageView, nullptr);
-        depthImageView = VK_NULL_HANDLE;
-    }
-
-    if (depthImage != VK_NULL_HANDLE) {
-        vkDestroyImage(device, depthImage, nullptr);
-        depthImage = VK_NULL_HANDLE;
-    }
-
-    if (depthImageMemory != VK_NULL_HANDLE) {
-        vkFreeMemory(device, depthImageMemory, nullptr);
-        depthImageMemory = VK_NULL_HANDLE;
+    if (renderGraph) {
+        renderGraph->reset();
+        renderGraph.reset();
     }
 
     if (defaultTextureView != VK_NULL_HANDLE) {
@@ -776,13 +1156,7 @@ void VulkanCore::releaseResources() {
     }
 
     if (defaultTexture != VK_NULL_HANDLE) {
-        vkDestroyImage(device, defaultTexture, nullptr);
-        defaultTexture = VK_NULL_HANDLE;
-    }
-
-    if (defaultTextureMemory != VK_NULL_HANDLE) {
-        vkFreeMemory(device, defaultTextureMemory, nullptr);
-        defaultTextureMemory = VK_NULL_HANDLE;
+        destroyImage(defaultTexture, defaultTextureMemory);
     }
 
     if (sceneRenderPass != VK_NULL_HANDLE) {
@@ -799,6 +1173,10 @@ void VulkanCore::releaseResources() {
         vkDestroySampler(device, textureSampler, nullptr);
         textureSampler = VK_NULL_HANDLE;
     }
+    for (const auto &[info, sampler] : samplerCache) {
+        vkDestroySampler(device, sampler, nullptr);
+    }
+    samplerCache.clear();
 
     if (sceneDescriptorSetLayout != VK_NULL_HANDLE) {
         vkDestroyDescriptorSetLayout(device, sceneDescriptorSetLayout, nullptr);
@@ -830,6 +1208,33 @@ void VulkanCore::releaseResources() {
     swapChain.reset();
     scene.reset();
 
+    // Depois de todos que empilham destruições no cleanup; antes dos donos da memória
+    if (deletionQueue) {
+        deletionQueue->cleanup();
+        deletionQueue.reset();
+    }
+
+    if (residency) {
+        residency->cleanup();
+        residency.reset();
+    }
+
+    if (uploadContext) {
+        uploadContext->cleanup();
+        uploadContext.reset();
+    }
+
+    // Depois do upload context: o último lote ainda pode copiar para as páginas
+    if (meshPool) {
+        meshPool->cleanup();
+        meshPool.reset();
+    }
+
+    if (allocator) {
+        allocator->cleanup();
+        allocator.reset();
+    }
+
     if (device != VK_NULL_HANDLE) {
         vkDestroyDevice(device, nullptr);
         device = VK_NULL_HANDLE;
@@ -859,37 +1264,20 @@ void VulkanCore::handleResize() {
         glfwSetWindowSize(window, width, height);
     }
 
-    vkDeviceWaitIdle(device);
+    // Sem vkDeviceWaitIdle: o que o frame em voo usa (grafo, swapchain antiga, pirâmide) sai pela fila
+    // de destruição. Imagens e framebuffers do grafo acompanham o tamanho da swapchain.
+    renderGraph->reset();
 
-    // Primeiro destruir framebuffers que usam as image views
-    for (auto framebuffer : framebuffers) {
-        if (framebuffer != VK_NULL_HANDLE) {
-            vkDestroyFramebuffer(device, framebuffer, nullptr);
-        }
-    }
-    framebuffers.clear();
+    // Os render passes de compatibilidade não dependem do tamanho e continuam válidos
+    swapChain->recreate();
 
-    if (sceneFramebuffer != VK_NULL_HANDLE) {
-        vkDestroyFramebuffer(device, sceneFramebuffer, nullptr);
-        sceneFramebuffer = VK_NULL_HANDLE;
-    }
+    pipeline->recreate(renderPass, swapChain->getExtent());
 
-    // Agora é seguro destruir as image views
-    if (sceneImageView != VK_NULL_HANDLE) {
-        vkDestroyImageView(device, sceneImageView, nullptr);
-        sceneImageView = VK_NULL_HANDLE;
+    if (occlusion) {
+        occlusion->recreate(getSceneExtent());
     }
 
-    // Recriar swapchain e recursos dependentes
-    swapChain->cleanup();
-    swapChain->create();
-    createRenderPass();
-    createSceneRenderPass();
-    createSceneResources();
-    createSceneDescriptorSet();
-    createFramebuffers();
-
-    pipeline->recreate(renderPass, swapChain->getExtent());
+    buildRenderGraph();
 }
 
 uint32_t VulkanCore::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
@@ -914,7 +1302,7 @@ VkFormat VulkanCore::findDepthFormat()
     return findSupportedFormat(
         {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
         VK_IMAGE_TILING_OPTIMAL,
-        VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+        VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT); // lido pelo Hi-Z
 }
 
 bool VulkanCore::hasStencilComponent(VkFormat format)
@@ -1043,21 +1431,6 @@ void VulkanCore::endCommandBuffer(VkCommandBuffer commandBuffer)
     vkEndCommandBuffer(commandBuffer);
 }
 
-void VulkanCore::beginRenderPass(VkCommandBuffer commandBuffer, uint32_t imageIndex,
-                                 const VkClearValue *clearValues, uint32_t clearValueCount)
-{
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = renderPass;
-    renderPassInfo.framebuffer = framebuffers[imageIndex];
-    renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = swapChain->getExtent();
-    renderPassInfo.clearValueCount = clearValueCount;
-    renderPassInfo.pClearValues = clearValues;
-
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-}
-
 VkCommandBuffer VulkanCore::beginSingleTimeCommands()
 {
     if (commandPool == VK_NULL_HANDLE)
@@ -1107,7 +1480,8 @@ void VulkanCore::endSingleTimeCommands(VkCommandBuffer commandBuffer)
 void VulkanCore::createImage(uint32_t width, uint32_t height, VkFormat format,
                              VkImageTiling tiling, VkImageUsageFlags usage,
                              VkMemoryPropertyFlags properties, VkImage &image,
-                             VkDeviceMemory &imageMemory)
+                             GpuAllocation &imageMemory, uint32_t mipLevels,
+                             GpuMemoryCategory category, uint32_t arrayLayers)
 {
     validateImageDimensions(width, height);
 
@@ -1115,8 +1489,8 @@ void VulkanCore::createImage(uint32_t width, uint32_t height, VkFormat format,
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     imageInfo.imageType = VK_IMAGE_TYPE_2D;
     imageInfo.extent = {width, height, 1};
-    imageInfo.mipLevels = 1;
-    imageInfo.arrayLayers = 1;
+    imageInfo.mipLevels = mipLevels;
+    imageInfo.arrayLayers = arrayLayers;
     imageInfo.format = format;
     imageInfo.tiling = tiling;
     imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -1124,6 +1498,7 @@ void VulkanCore::createImage(uint32_t width, uint32_t height, VkFormat format,
     imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
     imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+    RenderCounters::add(RenderCounter::ImagesCreated);
     if (vkCreateImage(device, &imageInfo, nullptr, &image) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create image!");
     }
@@ -1131,34 +1506,67 @@ void VulkanCore::createImage(uint32_t width, uint32_t height, VkFormat format,
     VkMemoryRequirements memRequirements;
     vkGetImageMemoryRequirements(device, image, &memRequirements);
 
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+    GpuResourceKind kind = tiling == VK_IMAGE_TILING_OPTIMAL ? GpuResourceKind::Optimal : GpuResourceKind::Linear;
+    imageMemory = allocator->allocate(memRequirements, properties, kind, category);
 
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
-        vkDestroyImage(device, image, nullptr);
-        throw std::runtime_error("Failed to allocate image memory!");
+    if (vkBindImageMemory(device, image, imageMemory.memory, imageMemory.offset) != VK_SUCCESS) {
+        destroyImage(image, imageMemory);
+        throw std::runtime_error("Failed to bind image memory!");
     }
+}
 
-    if (vkBindImageMemory(device, image, imageMemory, 0) != VK_SUCCESS) {
-        vkFreeMemory(device, imageMemory, nullptr);
+void VulkanCore::destroyImage(VkImage &image, GpuAllocation &imageMemory)
+{
+    if (image != VK_NULL_HANDLE)
+    {
+        RenderCounters::add(RenderCounter::ImagesDestroyed);
         vkDestroyImage(device, image, nullptr);
-        throw std::runtime_error("Failed to bind image memory!");
+        image = VK_NULL_HANDLE;
     }
+    allocator->free(imageMemory);
 }
 
 VkSampler VulkanCore::createTextureSampler(VkSamplerCreateInfo &samplerInfo)
 {
+    // Poucas configurações distintas: busca linear; pNext não entra na comparação
+    for (const auto &[info, sampler] : samplerCache)
+    {
+        if (info.flags == samplerInfo.flags && info.magFilter == samplerInfo.magFilter &&
+            info.minFilter == samplerInfo.minFilter && info.mipmapMode == samplerInfo.mipmapMode &&
+            info.addressModeU == samplerInfo.addressModeU && info.addressModeV == samplerInfo.addressModeV &&
+            info.addressModeW == samplerInfo.addressModeW && info.mipLodBias == samplerInfo.mipLodBias &&
+            info.anisotropyEnable == samplerInfo.anisotropyEnable && info.maxAnisotropy == samplerInfo.maxAnisotropy &&
+            info.compareEnable == samplerInfo.compareEnable && info.compareOp == samplerInfo.compareOp &&
+            info.minLod == samplerInfo.minLod && info.maxLod == samplerInfo.maxLod &&
+            info.borderColor == samplerInfo.borderColor &&
+            info.unnormalizedCoordinates == samplerInfo.unnormalizedCoordinates)
+        {
+            return sampler;
+        }
+    }
+
     VkSampler sampler;
     if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
     {
         throw std::runtime_error("failed to create texture sampler!");
     }
+    samplerCache.emplace_back(samplerInfo, sampler);
+    samplerCache.back().first.pNext = nullptr;
     return sampler;
 }
 
-VkImageView VulkanCore::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags)
+bool VulkanCore::supportsLinearBlit(VkFormat format)
+{
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+
+    const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                          VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (properties.optimalTilingFeatures & required) == required;
+}
+
+VkImageView VulkanCore::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels,
+                                        uint32_t baseArrayLayer)
 {
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -1167,8 +1575,8 @@ VkImageView VulkanCore::createImageView(VkImage image, VkFormat format, VkImageA
     viewInfo.format = format;
     viewInfo.subresourceRange.aspectMask = aspectFlags;
     viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = 1;
-    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.levelCount = mipLevels;
+    viewInfo.subresourceRange.baseArrayLayer = baseArrayLayer;
     viewInfo.subresourceRange.layerCount = 1;
 
     VkImageView imageView;
@@ -1217,7 +1625,8 @@ bool VulkanCore::isDeviceSuitable(VkPhysicalDevice device, std::string* outReaso
         return false;
     }
 
-    bool extensionsSupported = checkDeviceExtensionSupport(device);
+    // Headless: sem swapchain, e GPUs integradas/CPU (lavapipe) também servem
+    bool extensionsSupported = headless || checkDeviceExtensionSupport(device);
     if (!extensionsSupported)
     {
         if (outReason)
@@ -1225,16 +1634,19 @@ bool VulkanCore::isDeviceSuitable(VkPhysicalDevice device, std::string* outReaso
         return false;
     }
 
-    SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
-    bool swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
-    if (!swapChainAdequate)
+    if (!headless)
     {
-        if (outReason)
-            *outReason += " não possui suporte adequado para swapchain.";
-        return false;
+        SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
+        bool swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
+        if (!swapChainAdequate)
+        {
+            if (outReason)
+                *outReason += " não possui suporte adequado para swapchain.";
+            return false;
+        }
     }
 
-    if (deviceProperties.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+    if (!headless && deviceProperties.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
     {
         if (outReason)
             *outReason += " não é uma GPU dedicada.";
@@ -1287,17 +1699,38 @@ bool VulkanCore::checkValidationLayerSupport()
 
 std::vector<const char *> VulkanCore::getRequiredExtensions()
 {
-    uint32_t glfwExtensionCount = 0;
-    const char **glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    std::vector<const char *> extensions;
 
-    std::vector<const char *> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    // Headless não inicializa o GLFW nem cria surface
+    if (!headless)
+    {
+        uint32_t glfwExtensionCount = 0;
+        const char **glfwExtensions;
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
 
     if (enableValidationLayers)
     {
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
     }
 
+    // Necessária para consultar as features de descriptor indexing numa instância 1.0
+    uint32_t availableCount = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &availableCount, nullptr);
+    std::vector<VkExtensionProperties> available(availableCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &availableCount, available.data());
+
+    for (const auto &extension : available)
+    {
+        if (strcmp(extension.extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0)
+        {
+            extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+            physicalDeviceProperties2Enabled = true;
+            break;
+        }
+    }
+
     return extensions;
 }
 
@@ -1319,23 +1752,64 @@ bool VulkanCore::checkDeviceExtensionSupport(VkPhysicalDevice device)
     return requiredExtensions.empty();
 }
 
-void VulkanCore::createDepthResources()
+bool VulkanCore::queryDescriptorIndexingSupport()
 {
-    VkFormat depthFormat = findDepthFormat();
-    uint32_t width = swapChain->getExtent().width;
-    uint32_t height = swapChain->getExtent().height;
+    if (!physicalDeviceProperties2Enabled)
+        return false;
 
-    validateImageDimensions(width, height);
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
 
-    createImage(width, height,
-                depthFormat,
-                VK_IMAGE_TILING_OPTIMAL,
-                VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                depthImage,
-                depthImageMemory);
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, availableExtensions.data());
+
+    std::set<std::string> requiredExtensions = {VK_KHR_MAINTENANCE3_EXTENSION_NAME, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME};
+    for (const auto &extension : availableExtensions)
+    {
+        requiredExtensions.erase(extension.extensionName);
+    }
+
+    if (!requiredExtensions.empty())
+        return false;
 
-    depthImageView = createImageView(depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
+    auto getFeatures2 = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(
+        vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2KHR"));
+    if (!getFeatures2)
+        return false;
+
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+    VkPhysicalDeviceFeatures2KHR features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    features.pNext = &indexingFeatures;
+    getFeatures2(physicalDevice, &features);
+
+    return indexingFeatures.shaderSampledImageArrayNonUniformIndexing &&
+           indexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+           indexingFeatures.descriptorBindingUpdateUnusedWhilePending &&
+           indexingFeatures.descriptorBindingPartiallyBound &&
+           indexingFeatures.descriptorBindingVariableDescriptorCount &&
+           indexingFeatures.runtimeDescriptorArray;
+}
+
+bool VulkanCore::queryMemoryBudgetSupport()
+{
+    if (!physicalDeviceProperties2Enabled)
+        return false;
+
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, availableExtensions.data());
+
+    for (const auto &extension : availableExtensions)
+    {
+        if (strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
+            return true;
+    }
+    return false;
 }
 
 void VulkanCore::createTextureSampler()
@@ -1363,44 +1837,12 @@ void VulkanCore::createTextureSampler()
     }
 }
 
-void VulkanCore::createSceneResources()
-{
-    uint32_t width = swapChain->getExtent().width;
-    uint32_t height = swapChain->getExtent().height;
-
-    validateImageDimensions(width, height);
-
-    // Certifique-se de que o formato é consistente
-    createImage(width, height, VK_FORMAT_B8G8R8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
-                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sceneImage, sceneImageMemory);
-
-    sceneImageView = createImageView(sceneImage, VK_FORMAT_B8G8R8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
-
-    // Criar Framebuffer para a cena
-    std::array<VkImageView, 2> attachments = {sceneImageView, depthImageView};
-
-    VkFramebufferCreateInfo framebufferInfo{};
-    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-    framebufferInfo.renderPass = sceneRenderPass;
-    framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-    framebufferInfo.pAttachments = attachments.data();
-    framebufferInfo.width = width;
-    framebufferInfo.height = height;
-    framebufferInfo.layers = 1;
-
-    if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &sceneFramebuffer) != VK_SUCCESS)
-    {
-        throw std::runtime_error("failed to create scene framebuffer!");
-    }
-}
-
 void VulkanCore::createDefaultImage()
 {
-    VkFormat colorFormat = swapChain->getImageFormat();
+    VkFormat colorFormat = getBackbufferFormat();
 
-    uint32_t width = swapChain->getExtent().width;
-    uint32_t height = swapChain->getExtent().height;
+    uint32_t width = getRenderExtent().width;
+    uint32_t height = getRenderExtent().height;
 
     // Validar e ajustar as dimensões da imagem se necessário
     validateImageDimensions(width, height);
@@ -1411,13 +1853,16 @@ void VulkanCore::createDefaultImage()
                 VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                 defaultTexture,
-                defaultTextureMemory);
+                defaultTextureMemory,
+                1,
+                GpuMemoryCategory::RenderTarget);
 
     defaultTextureView = createImageView(defaultTexture, colorFormat, VK_IMAGE_ASPECT_COLOR_BIT);
 }
 
 void VulkanCore::createSceneRenderPass()
 {
+    // Compatível com o pass de cena do RenderGraph (cor + depth); usado para criar os pipelines de material
     VkAttachmentDescription colorAttachment{};
     colorAttachment.format = VK_FORMAT_B8G8R8A8_SRGB;
     colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
@@ -1425,8 +1870,8 @@ void VulkanCore::createSceneRenderPass()
     colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
     VkAttachmentDescription depthAttachment{};
     depthAttachment.format = findDepthFormat();
@@ -1435,7 +1880,7 @@ void VulkanCore::createSceneRenderPass()
     depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
     depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
     VkAttachmentReference colorAttachmentRef{};
@@ -1452,17 +1897,6 @@ void VulkanCore::createSceneRenderPass()
     subpass.pColorAttachments = &colorAttachmentRef;
     subpass.pDepthStencilAttachment = &depthAttachmentRef;
 
-    VkSubpassDependency dependency{};
-    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-    dependency.dstSubpass = 0;
-    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
-                              VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
-                              VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependency.srcAccessMask = 0;
-    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
-                               VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
     std::array<VkAttachmentDescription, 2> attachments = {colorAttachment, depthAttachment};
 
     VkRenderPassCreateInfo renderPassInfo{};
@@ -1471,8 +1905,6 @@ void VulkanCore::createSceneRenderPass()
     renderPassInfo.pAttachments = attachments.data();
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = 1;
-    renderPassInfo.pDependencies = &dependency;
 
     if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &sceneRenderPass) != VK_SUCCESS)
     {
@@ -1480,6 +1912,113 @@ void VulkanCore::createSceneRenderPass()
     }
 }
 
+void VulkanCore::buildRenderGraph()
+{
+    renderGraph->reset();
+
+    VkExtent2D extent = getSceneExtent();
+    VkFormat depthFormat = findDepthFormat();
+
+    graphSceneExtent = extent;
+    graphPrepassEnabled = occlusion->isPrepassEnabled();
+    graphHiZEnabled = occlusion->isHiZEnabled();
+
+    // A imagem da swapchain muda a cada frame (setImportedImage); o acquire espera no estágio de saída de cor
+    if (!headless)
+    {
+        backbufferResource = renderGraph->importImage("Backbuffer", {swapChain->getImageFormat(), swapChain->getExtent()},
+                                                      VK_NULL_HANDLE, VK_NULL_HANDLE,
+                                                      {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0},
+                                                      VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    }
+
+    RenderGraphResource sceneColor = renderGraph->createImage("SceneColor", {VK_FORMAT_B8G8R8A8_SRGB, extent});
+    RenderGraphResource sceneDepth = renderGraph->createImage("SceneDepth", {depthFormat, extent});
+
+    // Depth prepass opcional: o pass de cor só sombreia a superfície visível
+    if (graphPrepassEnabled)
+    {
+        renderGraph->addPass("DepthPrepass", RenderGraphPassType::Graphics)
+            .writeDepth(sceneDepth, RenderGraphLoad::Clear)
+            .setExecute([this](VkCommandBuffer commandBuffer) {
+                occlusion->bindDepthPrepass(commandBuffer);
+                scene->renderSystem->renderDepthPrepass(commandBuffer);
+            });
+    }
+
+    RenderGraphPass &scenePass = renderGraph->addPass("Scene", RenderGraphPassType::Graphics)
+        .writeColor(sceneColor, RenderGraphLoad::Clear, {{0.0f, 0.0f, 0.2f, 1.0f}})
+        .writeDepth(sceneDepth, graphPrepassEnabled ? RenderGraphLoad::Load : RenderGraphLoad::Clear)
+        .setExecute([this](VkCommandBuffer commandBuffer) {
+            occlusion->beginOverdrawQuery(commandBuffer);
+            scene->renderSystem->render(commandBuffer);
+            occlusion->endOverdrawQuery(commandBuffer);
+        });
+
+    // Headless: ninguém lê a cor sem o pass de UI, então o pass de cena não pode ser descartado
+    if (headless)
+    {
+        scenePass.setSideEffects();
+    }
+
+    // Pirâmide Hi-Z a partir do depth deste frame, usada no culling do próximo (readback para a CPU)
+    if (graphHiZEnabled)
+    {
+        RenderGraphResource hiz = renderGraph->importImage("HiZ", {VK_FORMAT_R32_SFLOAT, occlusion->getHiZExtent(), occlusion->getHiZMipLevels()},
+                                                           occlusion->getHiZImage(), VK_NULL_HANDLE,
+                                                           {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0});
+
+        renderGraph->addPass("HiZ", RenderGraphPassType::Compute)
+            .read(sceneDepth, RenderGraphAccess::SampledCompute)
+            .write(hiz, RenderGraphAccess::StorageCompute)
+            .setSideEffects()
+            .setExecute([this](VkCommandBuffer commandBuffer) {
+                occlusion->buildHiZ(commandBuffer, scene->renderSystem->getViewProjection());
+            });
+    }
+
+    if (!headless)
+    {
+        renderGraph->addPass("UI", RenderGraphPassType::Graphics)
+            .read(sceneColor, RenderGraphAccess::SampledFragment)
+            .writeColor(backbufferResource, RenderGraphLoad::Clear)
+            .setExecute([this](VkCommandBuffer commandBuffer) {
+                imgui->render(commandBuffer, sceneDescriptorSet);
+            });
+    }
+    else if (readbackBuffer != VK_NULL_HANDLE)
+    {
+        // Cópia da cor para o buffer do host; saveReadbackImage lê o último frame
+        renderGraph->addPass("Readback", RenderGraphPassType::Compute)
+            .read(sceneColor, RenderGraphAccess::TransferSrc)
+            .setSideEffects()
+            .setExecute([this, sceneColor, extent](VkCommandBuffer commandBuffer) {
+                VkBufferImageCopy region{};
+                region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                region.imageSubresource.layerCount = 1;
+                region.imageExtent = {extent.width, extent.height, 1};
+
+                vkCmdCopyImageToBuffer(commandBuffer, renderGraph->getImage(sceneColor), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                       readbackBuffer, 1, &region);
+
+                VkMemoryBarrier barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                                     0, 1, &barrier, 0, nullptr, 0, nullptr);
+            });
+    }
+
+    renderGraph->compile();
+
+    updateSceneDescriptorSet(renderGraph->getImageView(sceneColor));
+    if (graphHiZEnabled)
+    {
+        occlusion->setDepthSource(renderGraph->getImageView(sceneDepth));
+    }
+}
+
 void VulkanCore::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
 {
     VkCommandBufferBeginInfo beginInfo{};
@@ -1490,33 +2029,24 @@ void VulkanCore::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t ima
         throw std::runtime_error("failed to begin recording command buffer!");
     }
 
-    // Primeiro Render Pass: Cena
-    VkRenderPassBeginInfo sceneRenderPassInfo{};
-    sceneRenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    sceneRenderPassInfo.renderPass = sceneRenderPass;
-    sceneRenderPassInfo.framebuffer = sceneFramebuffer;
-    sceneRenderPassInfo.renderArea = {{0, 0}, swapChain->getExtent()};
-    VkClearValue sceneClearValues[2] = {{{0.0f, 0.0f, 0.2f, 1.0f}}, {1.0f, 0}};
-    sceneRenderPassInfo.clearValueCount = 2;
-    sceneRenderPassInfo.pClearValues = sceneClearValues;
-
-    vkCmdBeginRenderPass(commandBuffer, &sceneRenderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-    scene->renderSystem->render(*scene->registry, commandBuffer);
-    vkCmdEndRenderPass(commandBuffer);
-
-    // Segundo Render Pass: ImGui
-    VkRenderPassBeginInfo imguiRenderPassInfo{};
-    imguiRenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    imguiRenderPassInfo.renderPass = renderPass;
-    imguiRenderPassInfo.framebuffer = framebuffers[imageIndex];
-    imguiRenderPassInfo.renderArea = {{0, 0}, swapChain->getExtent()};
-    VkClearValue imguiClearValues[2] = {{{0.0f, 0.0f, 0.0f, 1.0f}}, {1.0f, 0}};
-    imguiRenderPassInfo.clearValueCount = 2; // Atualizado para refletir os anexos
-    imguiRenderPassInfo.pClearValues = imguiClearValues;
-
-    vkCmdBeginRenderPass(commandBuffer, &imguiRenderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-    imgui->render(commandBuffer, sceneDescriptorSet);
-    vkCmdEndRenderPass(commandBuffer);
+    // Timestamps de LATENCY frames atrás; o escopo "Frame" cobre todo o resto do command buffer
+    profiler->beginFrame(commandBuffer);
+
+    // Antes do prepareFrame: os draws já usam as faixas compactadas
+    meshPool->recordCompaction(commandBuffer);
+
+    // Resultados do frame anterior (pirâmide Hi-Z e overdraw) e lista de draws visíveis
+    occlusion->beginFrame(commandBuffer);
+    scene->renderSystem->prepareFrame(*scene->registry);
+
+    if (!headless)
+    {
+        renderGraph->setImportedImage(backbufferResource, swapChain->getImages()[imageIndex],
+                                      swapChain->getImageViews()[imageIndex]);
+    }
+    renderGraph->execute(commandBuffer);
+
+    profiler->endFrame(commandBuffer);
 
     if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
     {
@@ -1541,8 +2071,12 @@ QueueFamilyIndices VulkanCore::findQueueFamilies(VkPhysicalDevice device)
             indices.graphicsFamily = i;
         }
 
+        // Sem surface (headless) a fila de apresentação nunca é usada
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+        if (headless)
+            presentSupport = (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+        else
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
         if (presentSupport)
         {
             indices.presentFamily = i;
@@ -1555,6 +2089,16 @@ QueueFamilyIndices VulkanCore::findQueueFamilies(VkPhysicalDevice device)
         i++;
     }
 
+    for (uint32_t family = 0; family < queueFamilyCount; family++)
+    {
+        VkQueueFlags flags = queueFamilies[family].queueFlags;
+        if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+        {
+            indices.transferFamily = family;
+            break;
+        }
+    }
+
     return indices;
 }
 
@@ -5,6 +5,7 @@
 #include <vulkan/vulkan.h>
 #include <vector>
 #include <optional>
+#include <string>
 #include <memory>
 #include <array>
 #include <fstream>
@@ -12,17 +13,42 @@
 #include <ctime>
 
 #include "VulkanTypes.h"
+#include "VulkanAllocator.h"
 
 class VulkanSwapChain;
 class VulkanPipeline;
 class VulkanDescriptor;
 class VulkanImGui;
+class VulkanOcclusion;
+class VulkanBindless;
+class VulkanProfiler;
+class VulkanPipelineCache;
+class VulkanUploadContext;
+class VulkanMeshPool;
+class VulkanResidency;
+class VulkanDeletionQueue;
+class RenderGraph;
 class ProjectManager;
 class Scene;
 
+// Resolução dinâmica: ajusta a escala da cena para manter o tempo de GPU perto do alvo
+struct DynamicResolutionSettings
+{
+    bool enabled = false;
+    float targetGpuMs = 16.0f;
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+};
+
 class VulkanCore {
 public:
     void init(GLFWwindow* window);
+
+    // Sem janela, surface nem swapchain: a cena é renderizada numa imagem offscreen (CI, thumbnails).
+    // Com readback, cada frame copia a cor para um buffer do host que pode ser salvo em PNG.
+    void initHeadless(VkExtent2D extent, bool readback);
+    bool isHeadless() const { return headless; }
+    void saveReadbackImage(const std::string& path);
     void cleanup();
     void renderFrame();
     void handleResize();
@@ -33,17 +59,42 @@ public:
     VkPhysicalDevice getPhysicalDevice() const { return physicalDevice; }
     VkQueue getGraphicsQueue() const { return graphicsQueue; }
     VkQueue getPresentQueue() const { return presentQueue; }
+    // Fila da família só de transferência; sem ela, a própria fila gráfica
+    VkQueue getTransferQueue() const { return transferQueue; }
     VkCommandPool getCommandPool() const { return commandPool; }
     VkRenderPass getRenderPass() const { return renderPass; }
     VulkanSwapChain* getSwapChain() const { return swapChain.get(); }
     VulkanPipeline* getPipeline() const { return pipeline.get(); }
     VulkanDescriptor* getDescriptor() const { return descriptor.get(); }
+    VulkanOcclusion* getOcclusion() const { return occlusion.get(); }
+    VulkanBindless* getBindless() const { return bindless.get(); }
+    VulkanProfiler* getProfiler() const { return profiler.get(); }
+    VulkanPipelineCache* getPipelineCache() const { return pipelineCache.get(); }
+    VulkanAllocator* getAllocator() const { return allocator.get(); }
+    VulkanUploadContext* getUploadContext() const { return uploadContext.get(); }
+    VulkanMeshPool* getMeshPool() const { return meshPool.get(); }
+    VulkanResidency* getResidency() const { return residency.get(); }
+    VulkanDeletionQueue* getDeletionQueue() const { return deletionQueue.get(); }
+    RenderGraph* getRenderGraph() const { return renderGraph.get(); }
     Scene* getScene() const { return scene.get(); }
     uint32_t getQueueFamilyIndex();
     GLFWwindow* getWindow() const { return window; }
     VkInstance getInstance() const { return instance; }
     VkSurfaceKHR getSurface() const { return surface; }
-    VkImageView getDepthImageView() const { return depthImageView; }
+    VkFormat getDepthFormat() { return findDepthFormat(); }
+    VkRenderPass getSceneRenderPass() const { return sceneRenderPass; }
+    // Tamanho do frame: swapchain na janela, tamanho fixo no modo headless
+    VkExtent2D getRenderExtent() const;
+    // Resolução interna da cena: tamanho da janela "Scene" do editor vezes a escala (headless: tamanho fixo)
+    VkExtent2D getSceneExtent() const;
+    void setSceneViewportSize(VkExtent2D size);
+    VkExtent2D getSceneViewportSize() const { return sceneViewportSize; }
+    void setRenderScale(float scale);
+    float getRenderScale() const { return renderScale; }
+    DynamicResolutionSettings& getDynamicResolution() { return dynamicResolution; }
+    const VkPhysicalDeviceFeatures& getEnabledFeatures() const { return enabledFeatures; }
+    bool isDescriptorIndexingEnabled() const { return descriptorIndexingEnabled; }
+    bool isMemoryBudgetEnabled() const { return memoryBudgetEnabled; }
     VkImageView getDefaultTextureView() const { return defaultTextureView; }
     uint32_t getMaxFramesInFlight() const { return MAX_FRAMES_IN_FLIGHT; }
     ProjectManager* getProjectManager() const;
@@ -51,27 +102,34 @@ public:
     VkDescriptorSet getSceneDescriptorSet() const { return sceneDescriptorSet; }
     VkDescriptorSetLayout getSceneDescriptorSetLayout() const { return sceneDescriptorSetLayout; }
     // Resource Creation
-    VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
+    // baseArrayLayer: view 2D de uma camada de um array (TextureArrayPool)
+    VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1,
+                                uint32_t baseArrayLayer = 0);
     void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
     void createImage(uint32_t width, uint32_t height, VkFormat format,
                      VkImageTiling tiling, VkImageUsageFlags usage,
                      VkMemoryPropertyFlags properties, VkImage &image,
-                     VkDeviceMemory &imageMemory);
+                     GpuAllocation &imageMemory, uint32_t mipLevels = 1,
+                     GpuMemoryCategory category = GpuMemoryCategory::Other, uint32_t arrayLayers = 1);
+    void destroyImage(VkImage &image, GpuAllocation &imageMemory);
+    // Cache por configuração: texturas com os mesmos parâmetros compartilham o VkSampler (destruído no cleanup)
     VkSampler createTextureSampler(VkSamplerCreateInfo& samplerInfo);
+    uint32_t getSamplerCount() const { return static_cast<uint32_t>(samplerCache.size()); }
+    // Blit com filtro linear (geração de mips na GPU) em imagens optimal deste formato
+    bool supportsLinearBlit(VkFormat format);
 
     // Command Buffer Methods
     VkCommandBuffer beginSingleTimeCommands();
     void endSingleTimeCommands(VkCommandBuffer commandBuffer);
     void beginCommandBuffer(VkCommandBuffer commandBuffer);
     void endCommandBuffer(VkCommandBuffer commandBuffer);
-    void beginRenderPass(VkCommandBuffer commandBuffer, uint32_t imageIndex,
-                        const VkClearValue* clearValues, uint32_t clearValueCount);
 
     // Memory Management
     void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
                      VkMemoryPropertyFlags properties, VkBuffer& buffer,
-                     VkDeviceMemory& bufferMemory);
-    void copyDataToBuffer(const void* data, VkDeviceMemory bufferMemory, VkDeviceSize size);
+                     GpuAllocation& bufferMemory, GpuMemoryCategory category = GpuMemoryCategory::Other);
+    void destroyBuffer(VkBuffer& buffer, GpuAllocation& bufferMemory);
+    void copyDataToBuffer(const void* data, const GpuAllocation& bufferMemory, VkDeviceSize size);
     void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
     void transitionImageLayout(VkImage image, VkFormat format, 
                              VkImageLayout oldLayout, VkImageLayout newLayout);
@@ -117,22 +175,55 @@ private:
     VkDevice device{VK_NULL_HANDLE};
     VkQueue graphicsQueue{VK_NULL_HANDLE};
     VkQueue presentQueue{VK_NULL_HANDLE};
+    VkQueue transferQueue{VK_NULL_HANDLE};
     VkSurfaceKHR surface{VK_NULL_HANDLE};
     VkCommandPool commandPool{VK_NULL_HANDLE};
     VkRenderPass renderPass{VK_NULL_HANDLE};
     VkSampler textureSampler{VK_NULL_HANDLE};
+    std::vector<std::pair<VkSamplerCreateInfo, VkSampler>> samplerCache;
+    VkPhysicalDeviceFeatures enabledFeatures{};
+
+    // VK_EXT_descriptor_indexing é opcional (instância 1.0: as features vêm por VK_KHR_get_physical_device_properties2)
+    bool physicalDeviceProperties2Enabled = false;
+    bool descriptorIndexingEnabled = false;
+    // VK_EXT_memory_budget: uso/orçamento real por heap (também depende de properties2)
+    bool memoryBudgetEnabled = false;
+
+    // Modo headless
+    bool headless = false;
+    VkExtent2D headlessExtent{};
+    VkBuffer readbackBuffer{VK_NULL_HANDLE};
+    GpuAllocation readbackMemory;
+    void* readbackMapped = nullptr;
+
+    void createReadbackBuffer();
+    void renderHeadlessFrame();
+    // Comum aos dois caminhos de frame: espera a fence e processa o que ela liberou
+    void beginFrame();
+    // Escala dinâmica, alvos da cena e grafo; só depois da fence
+    void updateFrameTargets();
+    VkFormat getBackbufferFormat() const;
 
     std::unique_ptr<VulkanSwapChain> swapChain;
     std::unique_ptr<VulkanPipeline> pipeline;
     std::unique_ptr<VulkanDescriptor> descriptor;
     std::unique_ptr<VulkanImGui> imgui;
+    std::unique_ptr<VulkanOcclusion> occlusion;
+    std::unique_ptr<VulkanBindless> bindless;
+    std::unique_ptr<VulkanProfiler> profiler;
+    std::unique_ptr<VulkanPipelineCache> pipelineCache;
+    std::unique_ptr<VulkanAllocator> allocator;
+    std::unique_ptr<VulkanUploadContext> uploadContext;
+    std::unique_ptr<VulkanMeshPool> meshPool;
+    std::unique_ptr<VulkanResidency> residency;
+    std::unique_ptr<VulkanDeletionQueue> deletionQueue;
+    std::unique_ptr<RenderGraph> renderGraph;
     std::unique_ptr<Scene> scene;
 
     std::vector<VkCommandBuffer> commandBuffers;
     std::vector<VkSemaphore> imageAvailableSemaphores;
     std::vector<VkSemaphore> renderFinishedSemaphores;
     std::vector<VkFence> inFlightFences;
-    std::vector<VkFramebuffer> framebuffers;
 
     uint32_t currentFrame = 0;
 
@@ -141,25 +232,37 @@ private:
     VkDescriptorSetLayout sceneDescriptorSetLayout;
 
     void createSceneDescriptorSet();
+    void updateSceneDescriptorSet(VkImageView sceneView);
 
 private:
-    VkRenderPass sceneRenderPass;
-    VkFramebuffer sceneFramebuffer;
-    VkImage sceneImage;
-    VkDeviceMemory sceneImageMemory;
-    VkImageView sceneImageView;
+    // Render passes de compatibilidade para criar pipelines; as imagens e os passes do frame vêm do RenderGraph
+    VkRenderPass sceneRenderPass{VK_NULL_HANDLE};
 
-    void createSceneResources();
     void createSceneRenderPass();
 
-    // Depth Resources
-    VkImage depthImage{VK_NULL_HANDLE};
-    VkDeviceMemory depthImageMemory{VK_NULL_HANDLE};
-    VkImageView depthImageView{VK_NULL_HANDLE};
+    // Grafo do frame: recriado no resize e quando o modo de oclusão muda os passes
+    uint32_t backbufferResource = UINT32_MAX;
+    bool graphPrepassEnabled = false;
+    bool graphHiZEnabled = false;
+    VkExtent2D graphSceneExtent{};
+
+    void buildRenderGraph();
+
+    // Escala da cena; mudanças efetivas recriam os alvos da cena no início do frame seguinte
+    static constexpr float RENDER_SCALE_STEP = 0.05f;
+    static constexpr uint32_t DYNAMIC_RESOLUTION_INTERVAL = 30; // frames entre ajustes
+    VkExtent2D sceneViewportSize{};
+    float renderScale = 1.0f;
+    DynamicResolutionSettings dynamicResolution;
+    uint32_t framesSinceScaleChange = 0;
+
+    void updateDynamicResolution();
+    bool sceneTargetsOutdated() const;
+    void recreateSceneTargets();
 
     // storageImage Resources
     VkImage defaultTexture{VK_NULL_HANDLE};
-    VkDeviceMemory defaultTextureMemory{VK_NULL_HANDLE};
+    GpuAllocation defaultTextureMemory;
     VkImageView defaultTextureView{VK_NULL_HANDLE};
 
     // Initialization Methods
@@ -171,8 +274,6 @@ private:
     void createCommandPool();
     void createCommandBuffers();
     void createSyncObjects();
-    void createFramebuffers();
-    void createDepthResources();
     void createTextureSampler();
 public:
     void createDefaultImage();
@@ -181,6 +282,8 @@ private:
     bool isDeviceSuitable(VkPhysicalDevice device, std::string* reason);
     bool checkValidationLayerSupport();
     bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+    bool queryDescriptorIndexingSupport();
+    bool queryMemoryBudgetSupport();
     bool hasStencilComponent(VkFormat format);
     std::vector<const char*> getRequiredExtensions();
     VkFormat findSupportedFormat(const std::vector<VkFormat>& candidates,
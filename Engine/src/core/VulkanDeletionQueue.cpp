@@ -0,0 +1,93 @@
+#include "VulkanDeletionQueue.h"
+#include "CpuProfiler.h"
+
+VulkanDeletionQueue::VulkanDeletionQueue(VulkanCore &core) : core(core)
+{
+}
+
+VulkanDeletionQueue::~VulkanDeletionQueue()
+{
+    cleanup();
+}
+
+void VulkanDeletionQueue::create()
+{
+    frame = 0;
+    executed = 0;
+}
+
+void VulkanDeletionQueue::cleanup()
+{
+    flush();
+}
+
+void VulkanDeletionQueue::push(std::function<void()> deleter)
+{
+    entries.push_back({frame, std::move(deleter)});
+}
+
+void VulkanDeletionQueue::destroyBuffer(VkBuffer &buffer, GpuAllocation &memory)
+{
+    if (buffer == VK_NULL_HANDLE)
+        return;
+
+    push([this, buffer, memory]() mutable { core.destroyBuffer(buffer, memory); });
+    buffer = VK_NULL_HANDLE;
+    memory = {};
+}
+
+void VulkanDeletionQueue::destroyImage(VkImage &image, GpuAllocation &memory)
+{
+    if (image == VK_NULL_HANDLE)
+        return;
+
+    push([this, image, memory]() mutable { core.destroyImage(image, memory); });
+    image = VK_NULL_HANDLE;
+    memory = {};
+}
+
+void VulkanDeletionQueue::destroyImageView(VkImageView &view)
+{
+    if (view == VK_NULL_HANDLE)
+        return;
+
+    VkDevice device = core.getDevice();
+    push([device, view]() { vkDestroyImageView(device, view, nullptr); });
+    view = VK_NULL_HANDLE;
+}
+
+void VulkanDeletionQueue::update()
+{
+    PROFILE_ZONE("VulkanDeletionQueue::update");
+
+    frame++;
+    const uint64_t framesInFlight = core.getMaxFramesInFlight();
+
+    // Um deleter pode empilhar outro: esse recebe o frame novo e espera a vez dele
+    while (!entries.empty() && entries.front().frame + framesInFlight <= frame)
+    {
+        std::function<void()> deleter = std::move(entries.front().deleter);
+        entries.pop_front();
+        deleter();
+        executed++;
+    }
+}
+
+void VulkanDeletionQueue::flush()
+{
+    while (!entries.empty())
+    {
+        std::function<void()> deleter = std::move(entries.front().deleter);
+        entries.pop_front();
+        deleter();
+        executed++;
+    }
+}
+
+DeletionQueueStats VulkanDeletionQueue::getStats() const
+{
+    DeletionQueueStats result;
+    result.pending = static_cast<uint32_t>(entries.size());
+    result.executed = executed;
+    return result;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "VulkanCore.h"
+#include <deque>
+#include <functional>
+
+struct DeletionQueueStats
+{
+    uint32_t pending = 0;
+    uint64_t executed = 0;
+};
+
+// Destruição adiada: cada pedido leva o índice do frame em que foi feito e só roda depois que a fence
+// desse frame sinalizar (MAX_FRAMES_IN_FLIGHT frames depois). Assim remover entidades, trocar o modo
+// wireframe ou recriar targets não precisa de vkDeviceWaitIdle.
+class VulkanDeletionQueue
+{
+public:
+    VulkanDeletionQueue(VulkanCore &core);
+    ~VulkanDeletionQueue();
+
+    void create();
+    void cleanup();
+
+    // O frame em gravação (ou o último submetido) pode usar o recurso até a própria fence
+    void push(std::function<void()> deleter);
+    // Assumem o handle e o zeram: o chamador pode recriar na mesma variável
+    void destroyBuffer(VkBuffer &buffer, GpuAllocation &memory);
+    void destroyImage(VkImage &image, GpuAllocation &memory);
+    void destroyImageView(VkImageView &view);
+
+    // Logo depois da fence do frame, antes de qualquer outro subsistema: roda o que nenhum frame em voo usa
+    void update();
+    // Com a GPU ociosa (cleanup): roda tudo
+    void flush();
+
+    uint64_t getFrame() const { return frame; }
+    DeletionQueueStats getStats() const;
+
+private:
+    struct Entry
+    {
+        uint64_t frame = 0;
+        std::function<void()> deleter;
+    };
+
+    VulkanCore &core;
+    std::deque<Entry> entries; // em ordem de frame
+    uint64_t frame = 0;
+    uint64_t executed = 0;
+};
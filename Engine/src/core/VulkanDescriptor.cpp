@@ -3,9 +3,11 @@
 #include "VulkanSwapChain.h"
 #include "VulkanImGui.h"
 #include "VulkanCore.h"
+#include "RenderCounters.h"
 
 #include <stdexcept>
 #include <iostream>
+#include <cstring>
 
 VulkanDescriptor::VulkanDescriptor(VulkanCore &core) : core(core), descriptorPool(VK_NULL_HANDLE), descriptorSetLayout(VK_NULL_HANDLE)
 {
@@ -19,8 +21,9 @@ VulkanDescriptor::~VulkanDescriptor()
 void VulkanDescriptor::create()
 {
     createDescriptorSetLayout();
-    createUniformBuffer(core.getDevice(), core.getPhysicalDevice(), sizeof(UBO), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, uniformBuffer, uniformBufferMemory);
+    createFrameBuffers();
     createDescriptorPool();
+    createFrameDescriptorSet();
     core.createDefaultImage();
     createDescriptorSets();
 }
@@ -28,6 +31,25 @@ void VulkanDescriptor::create()
 void VulkanDescriptor::cleanup()
 {
     auto device = core.getDevice();
+    if (uniformBuffer != VK_NULL_HANDLE)
+    {
+        core.destroyBuffer(uniformBuffer, uniformBufferMemory);
+        uniformBufferMapped = nullptr;
+    }
+
+    if (lightBuffer != VK_NULL_HANDLE)
+    {
+        core.destroyBuffer(lightBuffer, lightBufferMemory);
+        lightBufferMapped = nullptr;
+    }
+
+    if (materialBuffer != VK_NULL_HANDLE)
+    {
+        core.destroyBuffer(materialBuffer, materialBufferMemory);
+        materialsMapped = nullptr;
+    }
+    materialCount = 0;
+
     if (descriptorPool != VK_NULL_HANDLE)
     {
         vkDestroyDescriptorPool(device, descriptorPool, nullptr);
@@ -48,23 +70,30 @@ void VulkanDescriptor::cleanup()
         vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
         descriptorSetLayout = VK_NULL_HANDLE;
     }
+
+    if (frameDescriptorSetLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(device, frameDescriptorSetLayout, nullptr);
+        frameDescriptorSetLayout = VK_NULL_HANDLE;
+    }
+    frameDescriptorSet = VK_NULL_HANDLE;
 }
 
 void VulkanDescriptor::createDescriptorPool()
 {
-    std::array<VkDescriptorPoolSize, 3> poolSizes{}; // Updated to 3 for PBR
+    std::array<VkDescriptorPoolSize, 3> poolSizes{};
 
-    // Para UBOs
+    // Para UBOs (câmera e luzes)
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSizes[0].descriptorCount = static_cast<uint32_t>(core.getMaxFramesInFlight() * 100);
+    poolSizes[0].descriptorCount = static_cast<uint32_t>(core.getMaxFramesInFlight() * 200);
 
-    for (int i = 1; i <= 5; ++i)
-    {
-        poolSizes[i].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        poolSizes[i].descriptorCount = static_cast<uint32_t>(core.getMaxFramesInFlight() * 500); // 5 texturas por material
-    }
+    // 5 texturas por material
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[1].descriptorCount = static_cast<uint32_t>(core.getMaxFramesInFlight() * 2500);
 
-    // Para Storage Images (PBR)
+    // Buffer de parâmetros dos materiais, um por set
+    poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[2].descriptorCount = static_cast<uint32_t>(core.getMaxFramesInFlight() * 100);
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -113,6 +142,7 @@ void VulkanDescriptor::createDescriptorSets()
 
     descriptorSets.resize(core.getMaxFramesInFlight());
 
+    RenderCounters::add(RenderCounter::DescriptorSetsAllocated, allocInfo.descriptorSetCount);
     if (vkAllocateDescriptorSets(core.getDevice(), &allocInfo, descriptorSets.data()) != VK_SUCCESS)
     {
         throw std::runtime_error("failed to allocate descriptor sets!");
@@ -190,33 +220,98 @@ std::vector<VkDescriptorSetLayoutBinding> VulkanDescriptor::getDescriptorSetLayo
     };
 }
 
-void VulkanDescriptor::createUniformBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer, VkDeviceMemory &bufferMemory)
+void VulkanDescriptor::createUniformBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer, GpuAllocation &bufferMemory)
+{
+    core.createBuffer(size, usage, properties, buffer, bufferMemory, GpuMemoryCategory::Uniform);
+}
+
+void VulkanDescriptor::createFrameBuffers()
 {
-    VkBufferCreateInfo bufferInfo{};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = size;
-    bufferInfo.usage = usage;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
-    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+    createUniformBuffer(core.getDevice(), core.getPhysicalDevice(), sizeof(UBO), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, properties, uniformBuffer, uniformBufferMemory);
+    createUniformBuffer(core.getDevice(), core.getPhysicalDevice(), sizeof(LightUBO), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, properties, lightBuffer, lightBufferMemory);
+
+    uniformBufferMapped = uniformBufferMemory.mapped;
+    lightBufferMapped = lightBufferMemory.mapped;
+
+    core.createBuffer(sizeof(GPUMaterial) * MAX_MATERIALS, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, properties,
+                      materialBuffer, materialBufferMemory, GpuMemoryCategory::Uniform);
+    materialsMapped = static_cast<GPUMaterial *>(materialBufferMemory.mapped);
+}
+
+uint32_t VulkanDescriptor::allocateMaterial()
+{
+    if (materialCount >= MAX_MATERIALS)
     {
-        throw std::runtime_error("failed to create buffer!");
+        throw std::runtime_error("material parameter buffer is full!");
     }
+    return materialCount++;
+}
+
+void VulkanDescriptor::writeMaterial(uint32_t index, const GPUMaterial &material)
+{
+    // Slots existentes só mudam com a GPU ociosa (ou depois da fence, com um frame em voo)
+    materialsMapped[index] = material;
+    RenderCounters::add(RenderCounter::UploadBytes, sizeof(GPUMaterial));
+}
 
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
+void VulkanDescriptor::updateFrameData(const UBO &ubo, const LightUBO &lights)
+{
+    // Com MAX_FRAMES_IN_FLIGHT = 1 a fence do frame anterior já foi aguardada aqui
+    memcpy(uniformBufferMapped, &ubo, sizeof(UBO));
+    memcpy(lightBufferMapped, &lights, sizeof(LightUBO));
+    RenderCounters::add(RenderCounter::UploadBytes, sizeof(UBO) + sizeof(LightUBO));
+}
 
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = core.findMemoryType(memRequirements.memoryTypeBits, properties);
+void VulkanDescriptor::createFrameDescriptorSet()
+{
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings = {{
+        {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
+        {6, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
+    }};
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(core.getDevice(), &layoutInfo, nullptr, &frameDescriptorSetLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create frame descriptor set layout!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &frameDescriptorSetLayout;
 
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
+    RenderCounters::add(RenderCounter::DescriptorSetsAllocated, allocInfo.descriptorSetCount);
+    if (vkAllocateDescriptorSets(core.getDevice(), &allocInfo, &frameDescriptorSet) != VK_SUCCESS)
     {
-        throw std::runtime_error("failed to allocate buffer memory!");
+        throw std::runtime_error("failed to allocate frame descriptor set!");
     }
 
-    vkBindBufferMemory(device, buffer, bufferMemory, 0);
+    VkDescriptorBufferInfo uboInfo = getBufferInfo(uniformBuffer, sizeof(UBO));
+    VkDescriptorBufferInfo lightInfo = getBufferInfo(lightBuffer, sizeof(LightUBO));
+
+    std::array<VkWriteDescriptorSet, 2> writes{};
+    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[0].dstSet = frameDescriptorSet;
+    writes[0].dstBinding = 0;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    writes[0].descriptorCount = 1;
+    writes[0].pBufferInfo = &uboInfo;
+
+    writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[1].dstSet = frameDescriptorSet;
+    writes[1].dstBinding = 6;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    writes[1].descriptorCount = 1;
+    writes[1].pBufferInfo = &lightInfo;
+
+    vkUpdateDescriptorSets(core.getDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
 }
 
 VkDescriptorBufferInfo VulkanDescriptor::getBufferInfo(VkBuffer buffer, VkDeviceSize size)
@@ -237,6 +332,7 @@ VkDescriptorSet VulkanDescriptor::allocateDescriptorSet()
     allocInfo.pSetLayouts = &descriptorSetLayout;
 
     VkDescriptorSet descriptorSet;
+    RenderCounters::add(RenderCounter::DescriptorSetsAllocated, allocInfo.descriptorSetCount);
     if (vkAllocateDescriptorSets(core.getDevice(), &allocInfo, &descriptorSet) != VK_SUCCESS)
     {
         throw std::runtime_error("Failed to allocate descriptor set!");
@@ -254,6 +350,7 @@ VkDescriptorSet VulkanDescriptor::createDescriptorSet()
     allocInfo.pSetLayouts = &descriptorSetLayout;
 
     VkDescriptorSet descriptorSet;
+    RenderCounters::add(RenderCounter::DescriptorSetsAllocated, allocInfo.descriptorSetCount);
     if (vkAllocateDescriptorSets(core.getDevice(), &allocInfo, &descriptorSet) != VK_SUCCESS)
     {
         throw std::runtime_error("failed to allocate descriptor set!");
@@ -34,9 +34,25 @@ public:
 
     std::vector<VkDescriptorSetLayoutBinding> getDescriptorSetLayoutBindings() const;
 
-    void createUniformBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer, VkDeviceMemory &bufferMemory);
+    void createUniformBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer, GpuAllocation &bufferMemory);
     template <typename T>
-    void updateUniformBuffer(VkDeviceMemory uniformBufferMemory, const T &ubo);
+    void updateUniformBuffer(const GpuAllocation &uniformBufferMemory, const T &ubo);
+
+    // Buffers por frame (câmera e luzes), mapeados permanentemente
+    void createFrameBuffers();
+    void updateFrameData(const UBO &ubo, const LightUBO &lights);
+
+    // Parâmetros dos materiais (GPUMaterial[MAX_MATERIALS]), lidos pelo materialIndex da push constant
+    // com ou sem bindless; slots novos não são lidos pelo frame em voo
+    static constexpr uint32_t MAX_MATERIALS = 16384;
+    uint32_t allocateMaterial();
+    void writeMaterial(uint32_t index, const GPUMaterial &material);
+    uint32_t getMaterialCount() const { return materialCount; }
+
+    // Set só com os dados por frame (binding 0 = UBO, binding 6 = luzes), usado pelo depth prepass
+    void createFrameDescriptorSet();
+    VkDescriptorSetLayout getFrameDescriptorSetLayout() const { return frameDescriptorSetLayout; }
+    VkDescriptorSet getFrameDescriptorSet() const { return frameDescriptorSet; }
 
 private:
     VulkanCore &core;
@@ -44,23 +60,30 @@ private:
     VkDescriptorSetLayout descriptorSetLayout;
     std::vector<VkDescriptorSet> descriptorSets;
     std::vector<VkDescriptorPool> descriptorPools;
+    VkDescriptorSetLayout frameDescriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorSet frameDescriptorSet = VK_NULL_HANDLE;
+    uint32_t materialCount = 0;
 
 public:
-    VkBuffer uniformBuffer;
-    VkDeviceMemory uniformBufferMemory;
-    void *uniformBufferMapped;
+    VkBuffer uniformBuffer = VK_NULL_HANDLE;
+    GpuAllocation uniformBufferMemory;
+    void *uniformBufferMapped = nullptr;
+
+    VkBuffer lightBuffer = VK_NULL_HANDLE;
+    GpuAllocation lightBufferMemory;
+    void *lightBufferMapped = nullptr;
+
+    VkBuffer materialBuffer = VK_NULL_HANDLE;
+    GpuAllocation materialBufferMemory;
+    GPUMaterial *materialsMapped = nullptr;
 };
 
 template <typename T>
-inline void VulkanDescriptor::updateUniformBuffer(VkDeviceMemory uniformBufferMemory, const T &ubo)
+inline void VulkanDescriptor::updateUniformBuffer(const GpuAllocation &uniformBufferMemory, const T &ubo)
 {
-    VkDeviceSize bufferSize = sizeof(T);
-
-    void *data;
-    VkResult result = vkMapMemory(core.getDevice(), uniformBufferMemory, 0, bufferSize, 0, &data);
-    if (result == VK_SUCCESS)
+    // Memória host-visible do alocador fica mapeada o tempo todo
+    if (uniformBufferMemory.mapped)
     {
-        memcpy(data, &ubo, bufferSize);
-        vkUnmapMemory(core.getDevice(), uniformBufferMemory);
+        memcpy(uniformBufferMemory.mapped, &ubo, sizeof(T));
     }
 }
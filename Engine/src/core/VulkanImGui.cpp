@@ -200,6 +200,8 @@ void VulkanImGui::render(VkCommandBuffer commandBuffer, VkDescriptorSet sceneDes
         drawer->drawInspectorWindow(selectedEntity);
         drawer->drawHierarchyWindow(selectedEntity);
         drawer->drawContentBrowser();
+        drawer->drawStatisticsWindow();
+        drawer->drawDebugWindow();
     }
     ImGui::End();
 
@@ -0,0 +1,351 @@
+#include "VulkanMeshPool.h"
+#include "VulkanCore.h"
+#include "VulkanUploadContext.h"
+#include "CpuProfiler.h"
+#include <stdexcept>
+#include <algorithm>
+
+VulkanMeshPool::VulkanMeshPool(VulkanCore &core) : core(core)
+{
+}
+
+VulkanMeshPool::~VulkanMeshPool()
+{
+    cleanup();
+}
+
+void VulkanMeshPool::create()
+{
+    // Uma página de cara: o primeiro modelo não paga a criação no meio da carga
+    pages.push_back(createPage(PAGE_VERTEX_COUNT, PAGE_INDEX_COUNT));
+}
+
+void VulkanMeshPool::cleanup()
+{
+    if (core.getDevice() == VK_NULL_HANDLE)
+        return;
+
+    for (RetiredPage &retired : retiredPages)
+        destroyPage(retired.page);
+    retiredPages.clear();
+
+    for (Page &page : pages)
+        destroyPage(page);
+    pages.clear();
+
+    entries.clear();
+    freeHandles.clear();
+}
+
+VulkanMeshPool::Page VulkanMeshPool::createPage(uint32_t vertexCapacity, uint32_t indexCapacity)
+{
+    // TRANSFER_SRC: a compactação copia daqui para a página nova
+    constexpr VkBufferUsageFlags transferUsage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+    Page page;
+    core.createBuffer(static_cast<VkDeviceSize>(vertexCapacity) * sizeof(Vertex), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | transferUsage,
+                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, page.vertexBuffer, page.vertexMemory, GpuMemoryCategory::Mesh);
+    core.createBuffer(static_cast<VkDeviceSize>(vertexCapacity) * sizeof(glm::vec3), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | transferUsage,
+                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, page.positionBuffer, page.positionMemory, GpuMemoryCategory::Mesh);
+    core.createBuffer(static_cast<VkDeviceSize>(indexCapacity) * sizeof(uint32_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT | transferUsage,
+                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, page.indexBuffer, page.indexMemory, GpuMemoryCategory::Mesh);
+
+    page.vertexRanges = std::make_unique<TlsfAllocator>(vertexCapacity);
+    page.indexRanges = std::make_unique<TlsfAllocator>(indexCapacity);
+    return page;
+}
+
+void VulkanMeshPool::destroyPage(Page &page)
+{
+    if (page.vertexBuffer != VK_NULL_HANDLE)
+        core.destroyBuffer(page.vertexBuffer, page.vertexMemory);
+    if (page.positionBuffer != VK_NULL_HANDLE)
+        core.destroyBuffer(page.positionBuffer, page.positionMemory);
+    if (page.indexBuffer != VK_NULL_HANDLE)
+        core.destroyBuffer(page.indexBuffer, page.indexMemory);
+
+    page = Page{};
+}
+
+void VulkanMeshPool::retirePage(Page &page)
+{
+    // Frames já gravados (e lotes de upload pendentes) ainda podem ler a página
+    RetiredPage retired;
+    retired.page = std::move(page);
+    retired.framesLeft = core.getMaxFramesInFlight();
+    retiredPages.push_back(std::move(retired));
+    page = Page{};
+}
+
+bool VulkanMeshPool::placeInPage(uint32_t pageIndex, Entry &entry)
+{
+    Page &page = pages[pageIndex];
+
+    uint64_t vertexOffset, firstIndex;
+    uint32_t vertexNode = page.vertexRanges->allocate(entry.range.vertexCount, 1, vertexOffset);
+    if (vertexNode == TlsfAllocator::INVALID_NODE)
+        return false;
+
+    uint32_t indexNode = page.indexRanges->allocate(entry.range.indexCount, 1, firstIndex);
+    if (indexNode == TlsfAllocator::INVALID_NODE)
+    {
+        page.vertexRanges->free(vertexNode);
+        return false;
+    }
+
+    entry.range.page = pageIndex;
+    entry.range.vertexOffset = static_cast<int32_t>(vertexOffset);
+    entry.range.firstIndex = static_cast<uint32_t>(firstIndex);
+    entry.vertexNode = vertexNode;
+    entry.indexNode = indexNode;
+    return true;
+}
+
+MeshHandle VulkanMeshPool::allocate(const Vertex *vertices, const glm::vec3 *positions, uint32_t vertexCount,
+                                    const uint32_t *indices, uint32_t indexCount)
+{
+    if (vertexCount == 0 || indexCount == 0)
+    {
+        throw std::runtime_error("mesh pool: empty geometry!");
+    }
+
+    MeshHandle handle;
+    if (!freeHandles.empty())
+    {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+    else
+    {
+        handle = static_cast<MeshHandle>(entries.size());
+        entries.emplace_back();
+    }
+
+    Entry &entry = entries[handle];
+    entry = Entry{};
+    entry.range.vertexCount = vertexCount;
+    entry.range.indexCount = indexCount;
+
+    bool placed = false;
+    for (uint32_t i = 0; i < pages.size() && !placed; i++)
+    {
+        if (pages[i].vertexBuffer != VK_NULL_HANDLE)
+            placed = placeInPage(i, entry);
+    }
+
+    if (!placed)
+    {
+        // Nenhuma página comporta: abre outra (do tamanho do mesh, se ele for maior que uma página)
+        uint32_t pageIndex = static_cast<uint32_t>(pages.size());
+        for (uint32_t i = 0; i < pages.size(); i++)
+        {
+            if (pages[i].vertexBuffer == VK_NULL_HANDLE)
+            {
+                pageIndex = i;
+                break;
+            }
+        }
+        if (pageIndex == pages.size())
+            pages.emplace_back();
+
+        pages[pageIndex] = createPage(std::max(PAGE_VERTEX_COUNT, vertexCount), std::max(PAGE_INDEX_COUNT, indexCount));
+        if (!placeInPage(pageIndex, entry))
+        {
+            throw std::runtime_error("mesh pool: failed to place mesh in a new page!");
+        }
+    }
+
+    entry.live = true;
+
+    Page &page = pages[entry.range.page];
+    VulkanUploadContext *uploads = core.getUploadContext();
+    VkDeviceSize firstVertex = static_cast<VkDeviceSize>(entry.range.vertexOffset);
+    uploads->uploadBuffer(page.vertexBuffer, firstVertex * sizeof(Vertex), vertices, vertexCount * sizeof(Vertex));
+    uploads->uploadBuffer(page.positionBuffer, firstVertex * sizeof(glm::vec3), positions, vertexCount * sizeof(glm::vec3));
+    uploads->uploadBuffer(page.indexBuffer, static_cast<VkDeviceSize>(entry.range.firstIndex) * sizeof(uint32_t), indices,
+                          indexCount * sizeof(uint32_t));
+    page.uploadTicket = uploads->getOpenTicket();
+
+    return handle;
+}
+
+void VulkanMeshPool::free(MeshHandle handle)
+{
+    if (handle >= entries.size() || !entries[handle].live)
+        return;
+
+    Entry &entry = entries[handle];
+    Page &page = pages[entry.range.page];
+    page.vertexRanges->free(entry.vertexNode);
+    page.indexRanges->free(entry.indexNode);
+
+    entry = Entry{};
+    freeHandles.push_back(handle);
+
+    // Página vazia sai, exceto a última viva (evita criar/destruir a cada carga)
+    if (page.vertexRanges->isEmpty())
+    {
+        uint32_t livePages = 0;
+        for (const Page &other : pages)
+        {
+            if (other.vertexBuffer != VK_NULL_HANDLE)
+                livePages++;
+        }
+
+        if (livePages > 1)
+            retirePage(page);
+    }
+}
+
+void VulkanMeshPool::update()
+{
+    VulkanUploadContext *uploads = core.getUploadContext();
+
+    for (auto it = retiredPages.begin(); it != retiredPages.end();)
+    {
+        if (it->framesLeft > 0)
+            it->framesLeft--;
+
+        if (it->framesLeft == 0 && uploads->isComplete(it->page.uploadTicket))
+        {
+            destroyPage(it->page);
+            it = retiredPages.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+float VulkanMeshPool::pageFragmentation(const Page &page) const
+{
+    auto fragmentation = [](const TlsfAllocator &ranges) {
+        TlsfAllocator::Stats stats = ranges.getStats();
+        if (stats.freeBytes == 0)
+            return 0.0f;
+        return 1.0f - static_cast<float>(stats.largestFreeRange) / static_cast<float>(stats.freeBytes);
+    };
+
+    return std::max(fragmentation(*page.vertexRanges), fragmentation(*page.indexRanges));
+}
+
+bool VulkanMeshPool::canCompact(const Page &page) const
+{
+    // Uploads para a página precisam ter sido submetidos antes deste frame; a barreira de release
+    // do upload cobre o estágio de transferência, então a cópia abaixo lê os dados já escritos
+    return page.vertexBuffer != VK_NULL_HANDLE && !page.vertexRanges->isEmpty() &&
+           core.getUploadContext()->isSubmitted(page.uploadTicket);
+}
+
+void VulkanMeshPool::recordCompaction(VkCommandBuffer commandBuffer)
+{
+    PROFILE_ZONE("VulkanMeshPool::recordCompaction");
+
+    for (uint32_t i = 0; i < pages.size(); i++)
+    {
+        if (!canCompact(pages[i]))
+            continue;
+
+        float fragmentation = pageFragmentation(pages[i]);
+        if (defragmentAll ? fragmentation > 0.0f : fragmentation > DEFRAG_THRESHOLD)
+        {
+            compactPage(commandBuffer, i);
+            if (!defragmentAll)
+                break;
+        }
+    }
+
+    defragmentAll = false;
+}
+
+void VulkanMeshPool::compactPage(VkCommandBuffer commandBuffer, uint32_t pageIndex)
+{
+    Page &old = pages[pageIndex];
+    Page fresh = createPage(static_cast<uint32_t>(old.vertexRanges->getSize()), static_cast<uint32_t>(old.indexRanges->getSize()));
+
+    struct Move
+    {
+        MeshHandle handle;
+        Entry entry;
+    };
+    std::vector<Move> moves;
+    std::vector<VkBufferCopy> vertexCopies, positionCopies, indexCopies;
+
+    // Alocações em sequência numa página vazia ficam contíguas: todo o espaço livre vai para o fim
+    for (MeshHandle handle = 0; handle < entries.size(); handle++)
+    {
+        const Entry &entry = entries[handle];
+        if (!entry.live || entry.range.page != pageIndex)
+            continue;
+
+        Entry moved = entry;
+        uint64_t vertexOffset, firstIndex;
+        moved.vertexNode = fresh.vertexRanges->allocate(entry.range.vertexCount, 1, vertexOffset);
+        moved.indexNode = fresh.indexRanges->allocate(entry.range.indexCount, 1, firstIndex);
+        if (moved.vertexNode == TlsfAllocator::INVALID_NODE || moved.indexNode == TlsfAllocator::INVALID_NODE)
+        {
+            // O arredondamento das classes do TLSF pode não caber numa página quase cheia: fica como está
+            destroyPage(fresh);
+            return;
+        }
+        moved.range.vertexOffset = static_cast<int32_t>(vertexOffset);
+        moved.range.firstIndex = static_cast<uint32_t>(firstIndex);
+
+        VkDeviceSize oldVertex = static_cast<VkDeviceSize>(entry.range.vertexOffset);
+        VkDeviceSize newVertex = static_cast<VkDeviceSize>(moved.range.vertexOffset);
+        vertexCopies.push_back({oldVertex * sizeof(Vertex), newVertex * sizeof(Vertex), entry.range.vertexCount * sizeof(Vertex)});
+        positionCopies.push_back({oldVertex * sizeof(glm::vec3), newVertex * sizeof(glm::vec3), entry.range.vertexCount * sizeof(glm::vec3)});
+        indexCopies.push_back({static_cast<VkDeviceSize>(entry.range.firstIndex) * sizeof(uint32_t),
+                               static_cast<VkDeviceSize>(moved.range.firstIndex) * sizeof(uint32_t),
+                               entry.range.indexCount * sizeof(uint32_t)});
+        moves.push_back({handle, moved});
+    }
+
+    vkCmdCopyBuffer(commandBuffer, old.vertexBuffer, fresh.vertexBuffer, static_cast<uint32_t>(vertexCopies.size()), vertexCopies.data());
+    vkCmdCopyBuffer(commandBuffer, old.positionBuffer, fresh.positionBuffer, static_cast<uint32_t>(positionCopies.size()), positionCopies.data());
+    vkCmdCopyBuffer(commandBuffer, old.indexBuffer, fresh.indexBuffer, static_cast<uint32_t>(indexCopies.size()), indexCopies.data());
+
+    // Draws deste frame já leem da página nova; uma compactação futura a copia de novo
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    for (const Move &move : moves)
+    {
+        entries[move.handle] = move.entry;
+        compactedBytes += move.entry.range.vertexCount * (sizeof(Vertex) + sizeof(glm::vec3)) +
+                          move.entry.range.indexCount * sizeof(uint32_t);
+    }
+    compactions++;
+
+    retirePage(old);
+    pages[pageIndex] = std::move(fresh);
+}
+
+MeshPoolStats VulkanMeshPool::getStats() const
+{
+    MeshPoolStats stats;
+    stats.meshCount = static_cast<uint32_t>(entries.size() - freeHandles.size());
+    stats.compactions = compactions;
+    stats.compactedBytes = compactedBytes;
+
+    for (const Page &page : pages)
+    {
+        if (page.vertexBuffer == VK_NULL_HANDLE)
+            continue;
+
+        stats.pageCount++;
+        stats.vertexCapacity += page.vertexRanges->getSize();
+        stats.vertexUsed += page.vertexRanges->getStats().usedBytes;
+        stats.indexCapacity += page.indexRanges->getSize();
+        stats.indexUsed += page.indexRanges->getStats().usedBytes;
+        stats.fragmentation = std::max(stats.fragmentation, pageFragmentation(page));
+    }
+
+    return stats;
+}
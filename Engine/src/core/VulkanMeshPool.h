@@ -0,0 +1,120 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include "TlsfAllocator.h"
+#include "VulkanAllocator.h"
+#include "VulkanTypes.h"
+#include <memory>
+#include <vector>
+
+class VulkanCore;
+
+// Índice na tabela do pool; continua válido quando a compactação move a geometria
+using MeshHandle = uint32_t;
+constexpr MeshHandle INVALID_MESH_HANDLE = UINT32_MAX;
+
+// Onde a geometria de um mesh está: os draws usam vertexOffset/firstIndex sobre os buffers da página
+struct MeshRange
+{
+    uint32_t page = 0;
+    int32_t vertexOffset = 0;
+    uint32_t vertexCount = 0;
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+};
+
+struct MeshPoolStats
+{
+    uint32_t pageCount = 0;
+    uint32_t meshCount = 0;
+    uint64_t vertexCapacity = 0;
+    uint64_t vertexUsed = 0;
+    uint64_t indexCapacity = 0;
+    uint64_t indexUsed = 0;
+    float fragmentation = 0.0f; // pior página, mesma métrica do VulkanAllocator
+    uint32_t compactions = 0;
+    uint64_t compactedBytes = 0;
+};
+
+// Geometria estática de todos os meshes em poucos buffers grandes (páginas): Vertex, só posições
+// (depth prepass) e índices. Vertex e position buffer dividem as mesmas faixas, em vértices; o index
+// buffer tem faixas próprias, em índices. Os índices ficam relativos ao mesh (vertexOffset no draw).
+class VulkanMeshPool
+{
+public:
+    static constexpr uint32_t PAGE_VERTEX_COUNT = 1u << 20; // 32 MB de Vertex + 12 MB de posições
+    static constexpr uint32_t PAGE_INDEX_COUNT = 4u << 20;  // 16 MB
+    // Acima disso o espaço livre está picado demais e a página é compactada
+    static constexpr float DEFRAG_THRESHOLD = 0.5f;
+
+    VulkanMeshPool(VulkanCore &core);
+    ~VulkanMeshPool();
+
+    void create();
+    void cleanup();
+
+    // Cópias vão pelo VulkanUploadContext; positions tem vertexCount elementos
+    MeshHandle allocate(const Vertex *vertices, const glm::vec3 *positions, uint32_t vertexCount,
+                        const uint32_t *indices, uint32_t indexCount);
+    // Só depois da fence do último frame que desenhou o mesh
+    void free(MeshHandle handle);
+
+    const MeshRange &getRange(MeshHandle handle) const { return entries[handle].range; }
+    VkBuffer getVertexBuffer(uint32_t page) const { return pages[page].vertexBuffer; }
+    VkBuffer getPositionBuffer(uint32_t page) const { return pages[page].positionBuffer; }
+    VkBuffer getIndexBuffer(uint32_t page) const { return pages[page].indexBuffer; }
+
+    // Depois da fence do frame: destrói páginas que a compactação (ou o esvaziamento) aposentou
+    void update();
+    // No início do command buffer do frame, fora de render pass: compacta no máximo uma página
+    // (todas, se requestDefragment foi chamado). Os ranges já saem atualizados para o prepareFrame.
+    void recordCompaction(VkCommandBuffer commandBuffer);
+    void requestDefragment() { defragmentAll = true; }
+
+    MeshPoolStats getStats() const;
+
+private:
+    struct Page
+    {
+        VkBuffer vertexBuffer = VK_NULL_HANDLE;
+        VkBuffer positionBuffer = VK_NULL_HANDLE;
+        VkBuffer indexBuffer = VK_NULL_HANDLE;
+        GpuAllocation vertexMemory;
+        GpuAllocation positionMemory;
+        GpuAllocation indexMemory;
+        std::unique_ptr<TlsfAllocator> vertexRanges;
+        std::unique_ptr<TlsfAllocator> indexRanges;
+        uint64_t uploadTicket = 0; // UploadTicket do último lote que escreveu na página
+    };
+
+    struct Entry
+    {
+        MeshRange range;
+        uint32_t vertexNode = TlsfAllocator::INVALID_NODE;
+        uint32_t indexNode = TlsfAllocator::INVALID_NODE;
+        bool live = false;
+    };
+
+    struct RetiredPage
+    {
+        Page page;
+        uint32_t framesLeft = 0;
+    };
+
+    Page createPage(uint32_t vertexCapacity, uint32_t indexCapacity);
+    void destroyPage(Page &page);
+    void retirePage(Page &page);
+    bool placeInPage(uint32_t pageIndex, Entry &entry);
+    float pageFragmentation(const Page &page) const;
+    bool canCompact(const Page &page) const;
+    void compactPage(VkCommandBuffer commandBuffer, uint32_t pageIndex);
+
+    VulkanCore &core;
+    std::vector<Page> pages; // páginas liberadas ficam com buffers nulos e são reaproveitadas
+    std::vector<RetiredPage> retiredPages;
+    std::vector<Entry> entries;
+    std::vector<MeshHandle> freeHandles;
+    bool defragmentAll = false;
+
+    uint32_t compactions = 0;
+    uint64_t compactedBytes = 0;
+};
@@ -0,0 +1,761 @@
+#include "VulkanOcclusion.h"
+#include "VulkanDescriptor.h"
+#include "RenderCounters.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanDeletionQueue.h"
+#include <managers/FileManager.h>
+
+#include <stdexcept>
+#include <array>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+namespace
+{
+    // Maior dimensão do nível da pirâmide copiado para a CPU
+    constexpr uint32_t HIZ_READBACK_MAX_SIZE = 128;
+
+    // Limite de texels testados por objeto; acima disso o objeto é considerado visível
+    constexpr uint32_t HIZ_MAX_TEXELS_PER_TEST = 1024;
+
+    struct HiZPushConstants
+    {
+        int32_t srcWidth;
+        int32_t srcHeight;
+        int32_t dstWidth;
+        int32_t dstHeight;
+    };
+}
+
+VulkanOcclusion::VulkanOcclusion(VulkanCore &core) : core(core)
+{
+}
+
+VulkanOcclusion::~VulkanOcclusion()
+{
+    cleanup();
+}
+
+void VulkanOcclusion::create(VkExtent2D extent)
+{
+    this->extent = extent;
+
+    createPrepassRenderPass();
+    createPrepassPipeline();
+    createHiZPipeline();
+    createHiZResources();
+    createReadbackBuffer();
+    createQueryPool();
+}
+
+void VulkanOcclusion::recreate(VkExtent2D extent)
+{
+    destroySizeDependentResources();
+
+    this->extent = extent;
+    createHiZResources();
+    createReadbackBuffer();
+
+    // A pirâmide antiga não corresponde mais ao novo tamanho
+    hizValid = false;
+    readbackPending = false;
+    overdrawQueryIssued = false;
+}
+
+void VulkanOcclusion::destroySizeDependentResources()
+{
+    // O frame em voo ainda pode ler a pirâmide e copiar para o readback: tudo sai pela fila de destruição
+    VkDevice device = core.getDevice();
+    VulkanDeletionQueue *deletionQueue = core.getDeletionQueue();
+
+    if (hizDescriptorPool != VK_NULL_HANDLE)
+    {
+        VkDescriptorPool pool = hizDescriptorPool;
+        deletionQueue->push([device, pool]() { vkDestroyDescriptorPool(device, pool, nullptr); });
+        hizDescriptorPool = VK_NULL_HANDLE;
+    }
+    hizDescriptorSets.clear();
+
+    for (auto &view : hizMipViews)
+    {
+        deletionQueue->destroyImageView(view);
+    }
+    hizMipViews.clear();
+    hizMipExtents.clear();
+    hizMipLevels = 0;
+
+    deletionQueue->destroyImage(hizImage, hizImageMemory);
+
+    deletionQueue->destroyBuffer(readbackBuffer, readbackMemory);
+    readbackMapped = nullptr;
+}
+
+void VulkanOcclusion::cleanup()
+{
+    VkDevice device = core.getDevice();
+    if (device == VK_NULL_HANDLE)
+        return;
+
+    destroySizeDependentResources();
+
+    if (overdrawQueryPool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(device, overdrawQueryPool, nullptr);
+        overdrawQueryPool = VK_NULL_HANDLE;
+    }
+
+    if (hizPipeline != VK_NULL_HANDLE)
+    {
+        RenderCounters::add(RenderCounter::PipelinesDestroyed);
+        vkDestroyPipeline(device, hizPipeline, nullptr);
+        hizPipeline = VK_NULL_HANDLE;
+    }
+
+    if (hizPipelineLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineLayout(device, hizPipelineLayout, nullptr);
+        hizPipelineLayout = VK_NULL_HANDLE;
+    }
+
+    if (hizSetLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(device, hizSetLayout, nullptr);
+        hizSetLayout = VK_NULL_HANDLE;
+    }
+
+    // Do cache de samplers do VulkanCore: só solta o handle
+    hizSampler = VK_NULL_HANDLE;
+
+    if (prepassPipeline != VK_NULL_HANDLE)
+    {
+        RenderCounters::add(RenderCounter::PipelinesDestroyed);
+        vkDestroyPipeline(device, prepassPipeline, nullptr);
+        prepassPipeline = VK_NULL_HANDLE;
+    }
+
+    if (prepassPipelineLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineLayout(device, prepassPipelineLayout, nullptr);
+        prepassPipelineLayout = VK_NULL_HANDLE;
+    }
+
+    if (prepassRenderPass != VK_NULL_HANDLE)
+    {
+        vkDestroyRenderPass(device, prepassRenderPass, nullptr);
+        prepassRenderPass = VK_NULL_HANDLE;
+    }
+}
+
+void VulkanOcclusion::createPrepassRenderPass()
+{
+    // Só para criar o pipeline: o render pass usado de fato é gerado pelo RenderGraph (mesmo formato)
+    VkAttachmentDescription depthAttachment{};
+    depthAttachment.format = core.getDepthFormat();
+    depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentReference depthAttachmentRef{};
+    depthAttachmentRef.attachment = 0;
+    depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 0;
+    subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+    VkRenderPassCreateInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = 1;
+    renderPassInfo.pAttachments = &depthAttachment;
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+
+    if (vkCreateRenderPass(core.getDevice(), &renderPassInfo, nullptr, &prepassRenderPass) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create depth prepass render pass!");
+    }
+}
+
+void VulkanOcclusion::createPrepassPipeline()
+{
+    auto vertShaderCode = VulkanCore::readFile(FileManager::getInstance().getResourcePath("engine\\shaders\\depth_prepass.vert.spv"));
+    VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
+
+    // Só o estágio de vértice: o prepass não tem fragment shader
+    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
+    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+    vertShaderStageInfo.module = vertShaderModule;
+    vertShaderStageInfo.pName = "main";
+
+    // Stream só de posições (MeshComponent::positionBuffer)
+    VkVertexInputBindingDescription bindingDescription{0, sizeof(glm::vec3), VK_VERTEX_INPUT_RATE_VERTEX};
+    VkVertexInputAttributeDescription attributeDescription{0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0};
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = 1;
+    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfo.vertexAttributeDescriptionCount = 1;
+    vertexInputInfo.pVertexAttributeDescriptions = &attributeDescription;
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    std::vector<VkDynamicState> dynamicStates = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR};
+
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    dynamicState.pDynamicStates = dynamicStates.data();
+
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_TRUE;
+    depthStencil.depthWriteEnable = VK_TRUE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+    depthStencil.depthBoundsTestEnable = VK_FALSE;
+    depthStencil.stencilTestEnable = VK_FALSE;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.attachmentCount = 0;
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = PushConstants::stages;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+
+    VkDescriptorSetLayout frameSetLayout = core.getDescriptor()->getFrameDescriptorSetLayout();
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &frameSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(core.getDevice(), &pipelineLayoutInfo, nullptr, &prepassPipelineLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create depth prepass pipeline layout!");
+    }
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = 1;
+    pipelineInfo.pStages = &vertShaderStageInfo;
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = prepassPipelineLayout;
+    pipelineInfo.renderPass = prepassRenderPass;
+    pipelineInfo.subpass = 0;
+
+    if (core.getPipelineCache()->compileGraphicsPipeline(pipelineInfo, &prepassPipeline) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create depth prepass pipeline!");
+    }
+
+    vkDestroyShaderModule(core.getDevice(), vertShaderModule, nullptr);
+}
+
+void VulkanOcclusion::createHiZPipeline()
+{
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_NEAREST;
+    samplerInfo.minFilter = VK_FILTER_NEAREST;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.maxAnisotropy = 1.0f;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = 0.0f;
+    hizSampler = core.createTextureSampler(samplerInfo);
+
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings = {{
+        {0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
+        {1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
+    }};
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(core.getDevice(), &layoutInfo, nullptr, &hizSetLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create Hi-Z descriptor set layout!");
+    }
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(HiZPushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &hizSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(core.getDevice(), &pipelineLayoutInfo, nullptr, &hizPipelineLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create Hi-Z pipeline layout!");
+    }
+
+    auto compShaderCode = VulkanCore::readFile(FileManager::getInstance().getResourcePath("engine\\shaders\\hiz_reduce.comp.spv"));
+    VkShaderModule compShaderModule = createShaderModule(compShaderCode);
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = compShaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = hizPipelineLayout;
+
+    if (core.getPipelineCache()->compileComputePipeline(pipelineInfo, &hizPipeline) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create Hi-Z compute pipeline!");
+    }
+
+    vkDestroyShaderModule(core.getDevice(), compShaderModule, nullptr);
+}
+
+void VulkanOcclusion::createHiZResources()
+{
+    // Nível 0 tem metade da resolução do depth buffer; cada nível guarda o máximo de um bloco 2x2
+    VkExtent2D mipExtent = {std::max(1u, extent.width >> 1), std::max(1u, extent.height >> 1)};
+    hizMipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(mipExtent.width, mipExtent.height)))) + 1;
+
+    hizMipExtents.resize(hizMipLevels);
+    for (uint32_t i = 0; i < hizMipLevels; i++)
+    {
+        hizMipExtents[i] = mipExtent;
+        mipExtent = {std::max(1u, mipExtent.width >> 1), std::max(1u, mipExtent.height >> 1)};
+    }
+
+    core.createImage(hizMipExtents[0].width, hizMipExtents[0].height, VK_FORMAT_R32_SFLOAT,
+                     VK_IMAGE_TILING_OPTIMAL,
+                     VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, hizImage, hizImageMemory, hizMipLevels,
+                     GpuMemoryCategory::RenderTarget);
+
+    hizMipViews.resize(hizMipLevels);
+    for (uint32_t i = 0; i < hizMipLevels; i++)
+    {
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = hizImage;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = VK_FORMAT_R32_SFLOAT;
+        viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, i, 1, 0, 1};
+
+        if (vkCreateImageView(core.getDevice(), &viewInfo, nullptr, &hizMipViews[i]) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create Hi-Z image view!");
+        }
+    }
+
+    // A pirâmide fica em GENERAL: escrita como storage image, lida como textura e copiada para a CPU
+    VkCommandBuffer commandBuffer = core.beginSingleTimeCommands();
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = hizImage;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, hizMipLevels, 0, 1};
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    core.endSingleTimeCommands(commandBuffer);
+
+    // Um descriptor set por nível: lê o nível anterior (ou o depth buffer) e escreve o atual
+    std::array<VkDescriptorPoolSize, 2> poolSizes = {{
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, hizMipLevels},
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, hizMipLevels},
+    }};
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = hizMipLevels;
+
+    if (vkCreateDescriptorPool(core.getDevice(), &poolInfo, nullptr, &hizDescriptorPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create Hi-Z descriptor pool!");
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(hizMipLevels, hizSetLayout);
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = hizDescriptorPool;
+    allocInfo.descriptorSetCount = hizMipLevels;
+    allocInfo.pSetLayouts = layouts.data();
+
+    hizDescriptorSets.resize(hizMipLevels);
+    RenderCounters::add(RenderCounter::DescriptorSetsAllocated, allocInfo.descriptorSetCount);
+    if (vkAllocateDescriptorSets(core.getDevice(), &allocInfo, hizDescriptorSets.data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate Hi-Z descriptor sets!");
+    }
+
+    // O nível 0 lê o depth do RenderGraph, definido em setDepthSource depois de cada compile
+    for (uint32_t i = 0; i < hizMipLevels; i++)
+    {
+        VkDescriptorImageInfo srcInfo{};
+        srcInfo.sampler = hizSampler;
+        srcInfo.imageView = i > 0 ? hizMipViews[i - 1] : VK_NULL_HANDLE;
+        srcInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        VkDescriptorImageInfo dstInfo{};
+        dstInfo.imageView = hizMipViews[i];
+        dstInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        std::array<VkWriteDescriptorSet, 2> writes{};
+        writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[0].dstSet = hizDescriptorSets[i];
+        writes[0].dstBinding = 0;
+        writes[0].descriptorCount = 1;
+        writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[0].pImageInfo = &srcInfo;
+
+        writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[1].dstSet = hizDescriptorSets[i];
+        writes[1].dstBinding = 1;
+        writes[1].descriptorCount = 1;
+        writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writes[1].pImageInfo = &dstInfo;
+
+        if (i == 0)
+            vkUpdateDescriptorSets(core.getDevice(), 1, &writes[1], 0, nullptr);
+        else
+            vkUpdateDescriptorSets(core.getDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+}
+
+void VulkanOcclusion::setDepthSource(VkImageView depthView)
+{
+    VkDescriptorImageInfo srcInfo{};
+    srcInfo.sampler = hizSampler;
+    srcInfo.imageView = depthView;
+    srcInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = hizDescriptorSets[0];
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &srcInfo;
+
+    vkUpdateDescriptorSets(core.getDevice(), 1, &write, 0, nullptr);
+}
+
+void VulkanOcclusion::createReadbackBuffer()
+{
+    readbackLevel = hizMipLevels - 1;
+    for (uint32_t i = 0; i < hizMipLevels; i++)
+    {
+        if (std::max(hizMipExtents[i].width, hizMipExtents[i].height) <= HIZ_READBACK_MAX_SIZE)
+        {
+            readbackLevel = i;
+            break;
+        }
+    }
+
+    const VkExtent2D &levelExtent = hizMipExtents[readbackLevel];
+    VkDeviceSize size = static_cast<VkDeviceSize>(levelExtent.width) * levelExtent.height * sizeof(float);
+
+    core.createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                      readbackBuffer, readbackMemory, GpuMemoryCategory::Staging);
+
+    readbackMapped = readbackMemory.mapped;
+
+    hizDepth.assign(static_cast<size_t>(levelExtent.width) * levelExtent.height, 1.0f);
+    hizDepthExtent = levelExtent;
+}
+
+void VulkanOcclusion::createQueryPool()
+{
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_OCCLUSION;
+    queryPoolInfo.queryCount = 1;
+
+    if (vkCreateQueryPool(core.getDevice(), &queryPoolInfo, nullptr, &overdrawQueryPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create occlusion query pool!");
+    }
+}
+
+void VulkanOcclusion::beginFrame(VkCommandBuffer commandBuffer)
+{
+    stats.objectsTested = 0;
+    stats.objectsOccluded = 0;
+    stats.prepassDraws = 0;
+    stats.colorDraws = 0;
+
+    // renderFrame já esperou a fence do frame anterior, então a cópia e a query estão prontas
+    if (readbackPending)
+    {
+        memcpy(hizDepth.data(), readbackMapped, hizDepth.size() * sizeof(float));
+        hizViewProjection = pendingViewProjection;
+        hizValid = true;
+        readbackPending = false;
+    }
+
+    if (overdrawQueryIssued)
+    {
+        uint64_t samples = 0;
+        if (vkGetQueryPoolResults(core.getDevice(), overdrawQueryPool, 0, 1, sizeof(samples), &samples,
+                                  sizeof(samples), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+        {
+            stats.samplesShaded = samples;
+            stats.pixelCount = static_cast<uint64_t>(extent.width) * extent.height;
+            stats.overdraw = stats.pixelCount > 0 ? static_cast<float>(samples) / static_cast<float>(stats.pixelCount) : 0.0f;
+            // Sem occlusionQueryPrecise o resultado só indica se algo passou
+            stats.overdrawAvailable = core.getEnabledFeatures().occlusionQueryPrecise == VK_TRUE;
+        }
+        overdrawQueryIssued = false;
+    }
+
+    vkCmdResetQueryPool(commandBuffer, overdrawQueryPool, 0, 1);
+}
+
+void VulkanOcclusion::bindDepthPrepass(VkCommandBuffer commandBuffer)
+{
+    RenderCounters::add(RenderCounter::PipelineBinds);
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, prepassPipeline);
+
+    VkDescriptorSet frameSet = core.getDescriptor()->getFrameDescriptorSet();
+    RenderCounters::add(RenderCounter::DescriptorBinds);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, prepassPipelineLayout, 0, 1, &frameSet, 0, nullptr);
+}
+
+void VulkanOcclusion::beginOverdrawQuery(VkCommandBuffer commandBuffer)
+{
+    VkQueryControlFlags flags = core.getEnabledFeatures().occlusionQueryPrecise ? VK_QUERY_CONTROL_PRECISE_BIT : 0;
+    vkCmdBeginQuery(commandBuffer, overdrawQueryPool, 0, flags);
+}
+
+void VulkanOcclusion::endOverdrawQuery(VkCommandBuffer commandBuffer)
+{
+    vkCmdEndQuery(commandBuffer, overdrawQueryPool, 0);
+    overdrawQueryIssued = true;
+}
+
+void VulkanOcclusion::buildHiZ(VkCommandBuffer commandBuffer, const glm::mat4 &viewProjection)
+{
+    // Transições do depth e da pirâmide entre passes ficam com o RenderGraph; aqui só as barreiras entre níveis
+    RenderCounters::add(RenderCounter::PipelineBinds);
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, hizPipeline);
+
+    VkExtent2D srcExtent = extent;
+    for (uint32_t i = 0; i < hizMipLevels; i++)
+    {
+        const VkExtent2D &dstExtent = hizMipExtents[i];
+
+        HiZPushConstants params{};
+        params.srcWidth = static_cast<int32_t>(srcExtent.width);
+        params.srcHeight = static_cast<int32_t>(srcExtent.height);
+        params.dstWidth = static_cast<int32_t>(dstExtent.width);
+        params.dstHeight = static_cast<int32_t>(dstExtent.height);
+
+        RenderCounters::add(RenderCounter::DescriptorBinds);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, hizPipelineLayout, 0, 1, &hizDescriptorSets[i], 0, nullptr);
+        vkCmdPushConstants(commandBuffer, hizPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+        vkCmdDispatch(commandBuffer, (dstExtent.width + 7) / 8, (dstExtent.height + 7) / 8, 1);
+
+        // O próximo nível lê o que acabou de ser escrito; o nível da CPU segue para a cópia
+        VkImageMemoryBarrier mipBarrier{};
+        mipBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        mipBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+        mipBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        mipBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        mipBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        mipBarrier.image = hizImage;
+        mipBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, i, 1, 0, 1};
+        mipBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        mipBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &mipBarrier);
+
+        srcExtent = dstExtent;
+    }
+
+    const VkExtent2D &levelExtent = hizMipExtents[readbackLevel];
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, readbackLevel, 0, 1};
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {levelExtent.width, levelExtent.height, 1};
+
+    vkCmdCopyImageToBuffer(commandBuffer, hizImage, VK_IMAGE_LAYOUT_GENERAL, readbackBuffer, 1, &region);
+
+    VkBufferMemoryBarrier hostBarrier{};
+    hostBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.buffer = readbackBuffer;
+    hostBarrier.offset = 0;
+    hostBarrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+
+    pendingViewProjection = viewProjection;
+    readbackPending = true;
+}
+
+bool VulkanOcclusion::isOccluded(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax, const glm::mat4 &model)
+{
+    if (!isHiZEnabled() || !hizValid)
+        return false;
+
+    stats.objectsTested++;
+
+    // Projeta a caixa com a câmera do frame em que a pirâmide foi gerada
+    glm::mat4 mvp = hizViewProjection * model;
+
+    glm::vec2 ndcMin(1.0f);
+    glm::vec2 ndcMax(-1.0f);
+    float nearestDepth = 1.0f;
+
+    for (int i = 0; i < 8; i++)
+    {
+        glm::vec3 corner((i & 1) ? boundsMax.x : boundsMin.x,
+                         (i & 2) ? boundsMax.y : boundsMin.y,
+                         (i & 4) ? boundsMax.z : boundsMin.z);
+
+        glm::vec4 clip = mvp * glm::vec4(corner, 1.0f);
+
+        // Caixa cruzando o plano near: não dá para projetar com segurança
+        if (clip.w <= 1e-5f)
+            return false;
+
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        ndcMin = glm::min(ndcMin, glm::vec2(ndc));
+        ndcMax = glm::max(ndcMax, glm::vec2(ndc));
+        nearestDepth = std::min(nearestDepth, ndc.z);
+    }
+
+    // Fora da tela do frame anterior: não há informação, então desenha
+    if (ndcMax.x < -1.0f || ndcMax.y < -1.0f || ndcMin.x > 1.0f || ndcMin.y > 1.0f)
+        return false;
+
+    ndcMin = glm::clamp(ndcMin, glm::vec2(-1.0f), glm::vec2(1.0f));
+    ndcMax = glm::clamp(ndcMax, glm::vec2(-1.0f), glm::vec2(1.0f));
+
+    // NDC -> pixel do depth buffer -> texel do nível lido (cada nível divide por 2 com arredondamento para baixo)
+    uint32_t shift = readbackLevel + 1;
+    auto toTexel = [&](float ndc, uint32_t size, uint32_t levelSize) {
+        uint32_t pixel = static_cast<uint32_t>(std::max(0.0f, (ndc * 0.5f + 0.5f) * static_cast<float>(size)));
+        return std::min(levelSize - 1, std::min(pixel, size - 1) >> shift);
+    };
+
+    uint32_t x0 = toTexel(ndcMin.x, extent.width, hizDepthExtent.width);
+    uint32_t x1 = toTexel(ndcMax.x, extent.width, hizDepthExtent.width);
+    uint32_t y0 = toTexel(ndcMin.y, extent.height, hizDepthExtent.height);
+    uint32_t y1 = toTexel(ndcMax.y, extent.height, hizDepthExtent.height);
+
+    if ((x1 - x0 + 1) * (y1 - y0 + 1) > HIZ_MAX_TEXELS_PER_TEST)
+        return false;
+
+    float farthestOccluder = 0.0f;
+    for (uint32_t y = y0; y <= y1; y++)
+    {
+        for (uint32_t x = x0; x <= x1; x++)
+        {
+            farthestOccluder = std::max(farthestOccluder, hizDepth[y * hizDepthExtent.width + x]);
+        }
+    }
+
+    bool occluded = nearestDepth > farthestOccluder;
+    if (occluded)
+        stats.objectsOccluded++;
+
+    return occluded;
+}
+
+void VulkanOcclusion::setMode(OcclusionMode newMode)
+{
+    if (mode == newMode)
+        return;
+
+    mode = newMode;
+    hizValid = false;
+    readbackPending = false;
+}
+
+VkShaderModule VulkanOcclusion::createShaderModule(const std::vector<char> &code)
+{
+    VkShaderModuleCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = code.size();
+    createInfo.pCode = reinterpret_cast<const uint32_t *>(code.data());
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(core.getDevice(), &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create shader module!");
+    }
+
+    return shaderModule;
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include "VulkanCore.h"
+#include "VulkanTypes.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+enum class OcclusionMode
+{
+    Off,              // só o pass de cor
+    DepthPrepass,     // prepass de profundidade + pass de cor com LESS_OR_EQUAL
+    DepthPrepassHiZ   // prepass + pirâmide Hi-Z + culling contra a pirâmide do frame anterior
+};
+
+struct OcclusionStats
+{
+    uint32_t objectsTested = 0;
+    uint32_t objectsOccluded = 0;
+    uint32_t prepassDraws = 0;
+    uint32_t colorDraws = 0;
+
+    // Resultado do frame anterior (occlusion query sobre o pass de cor)
+    uint64_t samplesShaded = 0;
+    uint64_t pixelCount = 0;
+    float overdraw = 0.0f;
+    bool overdrawAvailable = false;
+};
+
+class VulkanOcclusion
+{
+public:
+    VulkanOcclusion(VulkanCore &core);
+    ~VulkanOcclusion();
+
+    void create(VkExtent2D extent);
+    void cleanup();
+    void recreate(VkExtent2D extent);
+
+    // Início do frame (fora de render pass): lê os resultados do frame anterior e reseta as queries
+    void beginFrame(VkCommandBuffer commandBuffer);
+
+    // Dentro do pass de prepass do RenderGraph: pipeline só de profundidade + set do frame
+    void bindDepthPrepass(VkCommandBuffer commandBuffer);
+
+    // Envolve o pass de cor para medir as amostras sombreadas (overdraw)
+    void beginOverdrawQuery(VkCommandBuffer commandBuffer);
+    void endOverdrawQuery(VkCommandBuffer commandBuffer);
+
+    // Pass de compute do RenderGraph: reduz o depth em uma pirâmide Hi-Z e copia um nível grosso para a CPU
+    void buildHiZ(VkCommandBuffer commandBuffer, const glm::mat4 &viewProjection);
+
+    // Depth do RenderGraph lido pelo primeiro nível da pirâmide (muda a cada compile do grafo)
+    void setDepthSource(VkImageView depthView);
+
+    // Testa a caixa (espaço local) contra a pirâmide do frame anterior
+    bool isOccluded(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax, const glm::mat4 &model);
+
+    void setMode(OcclusionMode newMode);
+    OcclusionMode getMode() const { return mode; }
+    bool isPrepassEnabled() const { return mode != OcclusionMode::Off; }
+    bool isHiZEnabled() const { return mode == OcclusionMode::DepthPrepassHiZ; }
+
+    OcclusionStats &getStats() { return stats; }
+    VkPipeline getPrepassPipeline() const { return prepassPipeline; }
+    VkPipelineLayout getPrepassPipelineLayout() const { return prepassPipelineLayout; }
+    VkImage getHiZImage() const { return hizImage; }
+    VkExtent2D getHiZExtent() const { return hizMipExtents.empty() ? VkExtent2D{} : hizMipExtents[0]; }
+    uint32_t getHiZMipLevels() const { return hizMipLevels; }
+
+private:
+    void createPrepassRenderPass();
+    void createPrepassPipeline();
+    void createHiZResources();
+    void createHiZPipeline();
+    void createReadbackBuffer();
+    void createQueryPool();
+    void destroySizeDependentResources();
+    VkShaderModule createShaderModule(const std::vector<char> &code);
+
+    VulkanCore &core;
+    OcclusionMode mode = OcclusionMode::Off;
+    OcclusionStats stats;
+    VkExtent2D extent{};
+
+    // Depth prepass
+    VkRenderPass prepassRenderPass = VK_NULL_HANDLE; // compatível com o pass gerado pelo grafo
+    VkPipelineLayout prepassPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline prepassPipeline = VK_NULL_HANDLE;
+
+    // Pirâmide Hi-Z (R32_SFLOAT, profundidade máxima de cada bloco), sempre em VK_IMAGE_LAYOUT_GENERAL
+    VkImage hizImage = VK_NULL_HANDLE;
+    GpuAllocation hizImageMemory;
+    std::vector<VkImageView> hizMipViews;
+    std::vector<VkExtent2D> hizMipExtents;
+    uint32_t hizMipLevels = 0;
+    VkSampler hizSampler = VK_NULL_HANDLE;
+    VkDescriptorSetLayout hizSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool hizDescriptorPool = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> hizDescriptorSets;
+    VkPipelineLayout hizPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline hizPipeline = VK_NULL_HANDLE;
+
+    // Nível da pirâmide lido pela CPU para o teste de oclusão
+    uint32_t readbackLevel = 0;
+    VkBuffer readbackBuffer = VK_NULL_HANDLE;
+    GpuAllocation readbackMemory;
+    void *readbackMapped = nullptr;
+    std::vector<float> hizDepth;
+    VkExtent2D hizDepthExtent{};
+    glm::mat4 pendingViewProjection{1.0f};
+    glm::mat4 hizViewProjection{1.0f};
+    bool readbackPending = false;
+    bool hizValid = false;
+
+    // Occlusion query para medir overdraw do pass de cor
+    VkQueryPool overdrawQueryPool = VK_NULL_HANDLE;
+    bool overdrawQueryIssued = false;
+};
@@ -1,15 +1,20 @@
 #include "VulkanPipeline.h"
+#include "RenderCounters.h"
 #include <fstream>
 #include <Components.h>
 
 #include "VulkanSwapChain.h"
 #include "VulkanDescriptor.h"
 #include "VulkanImGui.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanDeletionQueue.h"
 #include <managers/FileManager.h>
 
 VulkanPipeline::VulkanPipeline(VulkanCore &core) : core(core),
                                                    graphicsPipeline(VK_NULL_HANDLE),
+                                                   sceneGraphicsPipeline(VK_NULL_HANDLE),
                                                    scenePipelineLayout(VK_NULL_HANDLE),
+                                                   uiPipelineLayout(VK_NULL_HANDLE),
                                                    wireframeMode(false)
 {
 }
@@ -32,6 +37,7 @@ void VulkanPipeline::cleanup()
 
     if (graphicsPipeline != VK_NULL_HANDLE)
     {
+        RenderCounters::add(RenderCounter::PipelinesDestroyed);
         vkDestroyPipeline(core.getDevice(), graphicsPipeline, nullptr);
         graphicsPipeline = VK_NULL_HANDLE;
     }
@@ -39,6 +45,7 @@ void VulkanPipeline::cleanup()
     // Add cleanup for sceneGraphicsPipeline
     if (sceneGraphicsPipeline != VK_NULL_HANDLE)
     {
+        RenderCounters::add(RenderCounter::PipelinesDestroyed);
         vkDestroyPipeline(core.getDevice(), sceneGraphicsPipeline, nullptr);
         sceneGraphicsPipeline = VK_NULL_HANDLE;
     }
@@ -76,26 +83,57 @@ void VulkanPipeline::create(VkRenderPass renderPass, VkExtent2D swapChainExtent)
 
 void VulkanPipeline::recreate(VkRenderPass renderPass, VkExtent2D extent)
 {
-    vkDeviceWaitIdle(core.getDevice());
-    cleanup();
+    retire();
     create(renderPass, extent);
 }
 
 void VulkanPipeline::setWireframeMode(bool enabled)
 {
-    vkDeviceWaitIdle(core.getDevice());
+    // Só marca: quem recriar pipelines por causa disso aposenta os antigos pela fila de destruição
     wireframeMode = enabled;
     wireframeModeChanged = true;
 }
 
-void VulkanPipeline::createGraphicsPipeline(VkRenderPass renderPass, VkExtent2D extent)
+void VulkanPipeline::retire()
 {
-    vkDeviceWaitIdle(core.getDevice());
+    VkDevice device = core.getDevice();
+    VkPipeline pipelines[] = {graphicsPipeline, sceneGraphicsPipeline};
+    VkPipelineLayout layouts[] = {scenePipelineLayout, uiPipelineLayout};
+
+    // O command buffer em voo pode ter ligado qualquer um deles
+    core.getDeletionQueue()->push([device, pipelines, layouts]() {
+        for (VkPipeline pipeline : pipelines)
+        {
+            if (pipeline != VK_NULL_HANDLE)
+            {
+                RenderCounters::add(RenderCounter::PipelinesDestroyed);
+                vkDestroyPipeline(device, pipeline, nullptr);
+            }
+        }
+        for (VkPipelineLayout layout : layouts)
+        {
+            if (layout != VK_NULL_HANDLE)
+                vkDestroyPipelineLayout(device, layout, nullptr);
+        }
+    });
+
+    graphicsPipeline = VK_NULL_HANDLE;
+    sceneGraphicsPipeline = VK_NULL_HANDLE;
+    scenePipelineLayout = VK_NULL_HANDLE;
+    uiPipelineLayout = VK_NULL_HANDLE;
+}
 
-    // Destruir pipeline existente se houver
+void VulkanPipeline::createGraphicsPipeline(VkRenderPass renderPass, VkExtent2D extent)
+{
+    // Pipeline existente sai pela fila de destruição
     if (graphicsPipeline != VK_NULL_HANDLE)
     {
-        vkDestroyPipeline(core.getDevice(), graphicsPipeline, nullptr);
+        VkDevice device = core.getDevice();
+        VkPipeline oldPipeline = graphicsPipeline;
+        core.getDeletionQueue()->push([device, oldPipeline]() {
+            RenderCounters::add(RenderCounter::PipelinesDestroyed);
+            vkDestroyPipeline(device, oldPipeline, nullptr);
+        });
         graphicsPipeline = VK_NULL_HANDLE;
     }
 
@@ -141,14 +179,14 @@ void VulkanPipeline::createGraphicsPipeline(VkRenderPass renderPass, VkExtent2D
     VkViewport viewport{};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
-    viewport.width = static_cast<float>(core.getSwapChain()->getExtent().width);
-    viewport.height = static_cast<float>(core.getSwapChain()->getExtent().height);
+    viewport.width = static_cast<float>(core.getRenderExtent().width);
+    viewport.height = static_cast<float>(core.getRenderExtent().height);
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
 
     VkRect2D scissor{};
     scissor.offset = {0, 0};
-    scissor.extent = core.getSwapChain()->getExtent();
+    scissor.extent = core.getRenderExtent();
 
     VkPipelineViewportStateCreateInfo viewportState{};
     viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
@@ -248,11 +286,11 @@ void VulkanPipeline::createGraphicsPipeline(VkRenderPass renderPass, VkExtent2D
     pipelineInfo.pColorBlendState = &colorBlending;
     pipelineInfo.pDynamicState = &dynamicState;
     pipelineInfo.layout = scenePipelineLayout;
-    pipelineInfo.renderPass = core.getRenderPass();
+    pipelineInfo.renderPass = core.getSceneRenderPass();
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(core.getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS)
+    if (core.getPipelineCache()->compileGraphicsPipeline(pipelineInfo, &graphicsPipeline) != VK_SUCCESS)
     {
         throw std::runtime_error("failed to create graphics pipeline!");
     }
@@ -380,7 +418,7 @@ void VulkanPipeline::createScenePipeline(VkRenderPass renderPass, VkExtent2D ext
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(core.getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &sceneGraphicsPipeline) != VK_SUCCESS) {
+    if (core.getPipelineCache()->compileGraphicsPipeline(pipelineInfo, &sceneGraphicsPipeline) != VK_SUCCESS) {
         throw std::runtime_error("failed to create scene graphics pipeline!");
     }
 
@@ -390,6 +428,7 @@ void VulkanPipeline::createScenePipeline(VkRenderPass renderPass, VkExtent2D ext
 
 void VulkanPipeline::bindScenePipeline(VkCommandBuffer commandBuffer)
 {
+    RenderCounters::add(RenderCounter::PipelineBinds);
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, sceneGraphicsPipeline);
 }
 
@@ -399,127 +438,27 @@ VkPipeline VulkanPipeline::createMaterialPipeline(
     const std::string& vertShaderPath,
     const std::string& fragShaderPath
     ) {
-    
-    auto vertShaderCode = VulkanCore::readFile(vertShaderPath);
-    auto fragShaderCode = VulkanCore::readFile(fragShaderPath);
-
-    VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-    VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
-
-    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vertShaderStageInfo.module = vertShaderModule;
-    vertShaderStageInfo.pName = "main";
-
-    VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-    fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    fragShaderStageInfo.module = fragShaderModule;
-    fragShaderStageInfo.pName = "main";
-
-    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages = {vertShaderStageInfo, fragShaderStageInfo};
-
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getAttributeDescriptions();
-
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.pVertexBindingDescriptions = bindingDescription.data();
-    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
-    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    inputAssembly.primitiveRestartEnable = VK_FALSE;
-
-    std::vector<VkDynamicState> dynamicStates = {
-        VK_DYNAMIC_STATE_VIEWPORT,
-        VK_DYNAMIC_STATE_SCISSOR
-    };
-
-    VkPipelineDynamicStateCreateInfo dynamicState{};
-    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-    dynamicState.pDynamicStates = dynamicStates.data();
-
-    VkPipelineViewportStateCreateInfo viewportState{};
-    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewportState.viewportCount = 1;
-    viewportState.scissorCount = 1;
-
-    VkPipelineRasterizationStateCreateInfo rasterizer{};
-    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    rasterizer.depthClampEnable = VK_FALSE;
-    rasterizer.rasterizerDiscardEnable = VK_FALSE;
-    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-    rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-    rasterizer.depthBiasEnable = VK_FALSE;
-
-    VkPipelineMultisampleStateCreateInfo multisampling{};
-    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-    VkPipelineDepthStencilStateCreateInfo depthStencil{};
-    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-    depthStencil.depthTestEnable = VK_TRUE;
-    depthStencil.depthWriteEnable = VK_TRUE;
-    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
-    depthStencil.depthBoundsTestEnable = VK_FALSE;
-    depthStencil.stencilTestEnable = VK_FALSE;
-
-    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | 
-                                         VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_FALSE;
-
-    VkPipelineColorBlendStateCreateInfo colorBlending{};
-    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    colorBlending.logicOpEnable = VK_FALSE;
-    colorBlending.attachmentCount = 1;
-    colorBlending.pAttachments = &colorBlendAttachment;
+    VulkanPipelineCache* cache = core.getPipelineCache();
 
-    // Usar o descriptor set layout existente do VulkanDescriptor
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
-
-    if (vkCreatePipelineLayout(core.getDevice(), &pipelineLayoutInfo, nullptr, &outPipelineLayout) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create pipeline layout!");
-    }
-
-    VkGraphicsPipelineCreateInfo pipelineInfo{};
-    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = shaderStages.size();
-    pipelineInfo.pStages = shaderStages.data();
-    pipelineInfo.pVertexInputState = &vertexInputInfo;
-    pipelineInfo.pInputAssemblyState = &inputAssembly;
-    pipelineInfo.pViewportState = &viewportState;
-    pipelineInfo.pRasterizationState = &rasterizer;
-    pipelineInfo.pMultisampleState = &multisampling;
-    pipelineInfo.pDepthStencilState = &depthStencil;
-    pipelineInfo.pColorBlendState = &colorBlending;
-    pipelineInfo.pDynamicState = &dynamicState;
-    pipelineInfo.layout = outPipelineLayout;
-    pipelineInfo.renderPass = core.getRenderPass();
-    pipelineInfo.subpass = 0;
-    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    // Matriz do modelo e índice do material chegam por push constant a cada draw
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = PushConstants::stages;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
 
-    VkPipeline graphicsPipeline;
-    if (vkCreateGraphicsPipelines(core.getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create graphics pipeline!");
-    }
+    // Layout e pipeline pertencem ao cache: materiais com o mesmo estado recebem os mesmos handles
+    outPipelineLayout = cache->getPipelineLayout({descriptorSetLayout}, {pushConstantRange});
 
-    vkDestroyShaderModule(core.getDevice(), fragShaderModule, nullptr);
-    vkDestroyShaderModule(core.getDevice(), vertShaderModule, nullptr);
+    GraphicsPipelineDesc desc;
+    desc.vertShader = vertShaderPath;
+    desc.fragShader = fragShaderPath;
+    desc.vertexBindings = Vertex::getBindingDescription();
+    desc.vertexAttributes = Vertex::getAttributeDescriptions();
+    desc.renderPass = core.getSceneRenderPass();
+    desc.layout = outPipelineLayout;
+    desc.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL; // igual passa: o depth pode vir do prepass
 
-    return graphicsPipeline;
+    return cache->getGraphicsPipeline(desc);
 }
 
 
@@ -36,6 +36,8 @@ public:
     bool wireframeModeChanged = false;
     bool wireframeMode;
 private:
+    // Handles atuais vão para a fila de destruição e os membros ficam nulos
+    void retire();
     VkShaderModule createShaderModule(const std::vector<char>& code);
     
     VulkanCore& core;
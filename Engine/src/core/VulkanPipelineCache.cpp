@@ -0,0 +1,477 @@
+#include "VulkanPipelineCache.h"
+#include "RenderCounters.h"
+#include <stdexcept>
+#include <cstring>
+#include <array>
+#include <fstream>
+#include <filesystem>
+#include <iostream>
+
+namespace
+{
+    template <typename T>
+    void appendBytes(std::string &key, const T &value)
+    {
+        key.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    // FNV-1a 64 bits
+    void hashBytes(uint64_t &hash, const void *data, size_t size)
+    {
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    }
+
+    template <typename T>
+    void hashValue(uint64_t &hash, const T &value)
+    {
+        hashBytes(hash, &value, sizeof(T));
+    }
+
+    bool sameBindings(const std::vector<VkVertexInputBindingDescription> &a, const std::vector<VkVertexInputBindingDescription> &b)
+    {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(a[0])) == 0);
+    }
+
+    bool sameAttributes(const std::vector<VkVertexInputAttributeDescription> &a, const std::vector<VkVertexInputAttributeDescription> &b)
+    {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(a[0])) == 0);
+    }
+}
+
+bool GraphicsPipelineDesc::operator==(const GraphicsPipelineDesc &other) const
+{
+    return vertShader == other.vertShader && fragShader == other.fragShader &&
+           sameBindings(vertexBindings, other.vertexBindings) && sameAttributes(vertexAttributes, other.vertexAttributes) &&
+           renderPass == other.renderPass && subpass == other.subpass && layout == other.layout &&
+           polygonMode == other.polygonMode && cullMode == other.cullMode && frontFace == other.frontFace &&
+           depthTest == other.depthTest && depthWrite == other.depthWrite && depthCompareOp == other.depthCompareOp &&
+           blendEnable == other.blendEnable;
+}
+
+size_t VulkanPipelineCache::DescHash::operator()(const GraphicsPipelineDesc &desc) const
+{
+    uint64_t hash = 14695981039346656037ull;
+    hashBytes(hash, desc.vertShader.data(), desc.vertShader.size());
+    hashBytes(hash, desc.fragShader.data(), desc.fragShader.size());
+    if (!desc.vertexBindings.empty())
+        hashBytes(hash, desc.vertexBindings.data(), desc.vertexBindings.size() * sizeof(desc.vertexBindings[0]));
+    if (!desc.vertexAttributes.empty())
+        hashBytes(hash, desc.vertexAttributes.data(), desc.vertexAttributes.size() * sizeof(desc.vertexAttributes[0]));
+    hashValue(hash, desc.renderPass);
+    hashValue(hash, desc.subpass);
+    hashValue(hash, desc.layout);
+    hashValue(hash, desc.polygonMode);
+    hashValue(hash, desc.cullMode);
+    hashValue(hash, desc.frontFace);
+    hashValue(hash, desc.depthTest);
+    hashValue(hash, desc.depthWrite);
+    hashValue(hash, desc.depthCompareOp);
+    hashValue(hash, desc.blendEnable);
+    return static_cast<size_t>(hash);
+}
+
+VulkanPipelineCache::VulkanPipelineCache(VulkanCore &core) : core(core)
+{
+}
+
+VulkanPipelineCache::~VulkanPipelineCache()
+{
+    cleanup();
+}
+
+void VulkanPipelineCache::create(const std::string &cacheFile)
+{
+    this->cacheFile = cacheFile;
+    stats = PipelineCacheStats{};
+
+    // Dados de outro driver/GPU são descartados: o driver poderia rejeitar ou, pior, aceitar lixo
+    std::vector<char> initialData = loadCacheData();
+    if (!initialData.empty() && !isCacheDataCompatible(initialData))
+    {
+        std::cout << "Pipeline cache: " << cacheFile << " é de outro dispositivo/driver, ignorando" << std::endl;
+        initialData.clear();
+    }
+
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = initialData.size();
+    cacheInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+    if (vkCreatePipelineCache(core.getDevice(), &cacheInfo, nullptr, &vkPipelineCache) != VK_SUCCESS)
+    {
+        // Alguns drivers falham com dados que passaram no header; tenta de novo vazio
+        cacheInfo.initialDataSize = 0;
+        cacheInfo.pInitialData = nullptr;
+        initialData.clear();
+        if (vkCreatePipelineCache(core.getDevice(), &cacheInfo, nullptr, &vkPipelineCache) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create pipeline cache!");
+        }
+    }
+
+    stats.warmStart = !initialData.empty();
+    stats.loadedBytes = initialData.size();
+    dirty = false;
+    lastSave = std::chrono::steady_clock::now();
+}
+
+void VulkanPipelineCache::cleanup()
+{
+    VkDevice device = core.getDevice();
+    if (device == VK_NULL_HANDLE)
+        return;
+
+    if (vkPipelineCache != VK_NULL_HANDLE)
+    {
+        save();
+        vkDestroyPipelineCache(device, vkPipelineCache, nullptr);
+        vkPipelineCache = VK_NULL_HANDLE;
+    }
+
+    for (auto &entry : pipelines)
+    {
+        RenderCounters::add(RenderCounter::PipelinesDestroyed);
+        vkDestroyPipeline(device, entry.second, nullptr);
+    }
+    pipelines.clear();
+
+    for (auto &entry : pipelineLayouts)
+        vkDestroyPipelineLayout(device, entry.second, nullptr);
+    pipelineLayouts.clear();
+
+    for (auto &entry : setLayouts)
+        vkDestroyDescriptorSetLayout(device, entry.second, nullptr);
+    setLayouts.clear();
+
+    for (auto &entry : shaderModules)
+        vkDestroyShaderModule(device, entry.second, nullptr);
+    shaderModules.clear();
+
+    stats = PipelineCacheStats{};
+}
+
+VkShaderModule VulkanPipelineCache::getShaderModule(const std::string &path)
+{
+    auto it = shaderModules.find(path);
+    if (it != shaderModules.end())
+        return it->second;
+
+    auto code = VulkanCore::readFile(path);
+
+    VkShaderModuleCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = code.size();
+    createInfo.pCode = reinterpret_cast<const uint32_t *>(code.data());
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(core.getDevice(), &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create shader module: " + path);
+    }
+
+    shaderModules[path] = shaderModule;
+    stats.shaderModuleCount++;
+    return shaderModule;
+}
+
+VkDescriptorSetLayout VulkanPipelineCache::getDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding> &bindings)
+{
+    std::string key;
+    for (const auto &binding : bindings)
+    {
+        if (binding.pImmutableSamplers != nullptr)
+        {
+            throw std::runtime_error("immutable samplers are not supported by the pipeline cache!");
+        }
+        appendBytes(key, binding.binding);
+        appendBytes(key, binding.descriptorType);
+        appendBytes(key, binding.descriptorCount);
+        appendBytes(key, binding.stageFlags);
+    }
+
+    auto it = setLayouts.find(key);
+    if (it != setLayouts.end())
+        return it->second;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    VkDescriptorSetLayout setLayout;
+    if (vkCreateDescriptorSetLayout(core.getDevice(), &layoutInfo, nullptr, &setLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+
+    setLayouts[key] = setLayout;
+    stats.setLayoutCount++;
+    return setLayout;
+}
+
+VkPipelineLayout VulkanPipelineCache::getPipelineLayout(const std::vector<VkDescriptorSetLayout> &layouts,
+                                                        const std::vector<VkPushConstantRange> &pushConstantRanges)
+{
+    std::string key;
+    for (VkDescriptorSetLayout layout : layouts)
+        appendBytes(key, layout);
+    for (const auto &range : pushConstantRanges)
+        appendBytes(key, range);
+
+    auto it = pipelineLayouts.find(key);
+    if (it != pipelineLayouts.end())
+        return it->second;
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(layouts.size());
+    pipelineLayoutInfo.pSetLayouts = layouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+    pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+
+    VkPipelineLayout pipelineLayout;
+    if (vkCreatePipelineLayout(core.getDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+
+    pipelineLayouts[key] = pipelineLayout;
+    stats.pipelineLayoutCount++;
+    return pipelineLayout;
+}
+
+VkPipeline VulkanPipelineCache::getGraphicsPipeline(const GraphicsPipelineDesc &desc)
+{
+    auto it = pipelines.find(desc);
+    if (it != pipelines.end())
+    {
+        stats.hits++;
+        return it->second;
+    }
+
+    stats.misses++;
+    VkPipeline pipeline = createGraphicsPipeline(desc);
+    pipelines.emplace(desc, pipeline);
+    stats.pipelineCount++;
+    return pipeline;
+}
+
+VkPipeline VulkanPipelineCache::createGraphicsPipeline(const GraphicsPipelineDesc &desc)
+{
+    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
+    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+    vertShaderStageInfo.module = getShaderModule(desc.vertShader);
+    vertShaderStageInfo.pName = "main";
+
+    VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
+    fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    fragShaderStageInfo.module = getShaderModule(desc.fragShader);
+    fragShaderStageInfo.pName = "main";
+
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages = {vertShaderStageInfo, fragShaderStageInfo};
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(desc.vertexBindings.size());
+    vertexInputInfo.pVertexBindingDescriptions = desc.vertexBindings.data();
+    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(desc.vertexAttributes.size());
+    vertexInputInfo.pVertexAttributeDescriptions = desc.vertexAttributes.data();
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    std::array<VkDynamicState, 2> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    dynamicState.pDynamicStates = dynamicStates.data();
+
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = desc.polygonMode;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = desc.cullMode;
+    rasterizer.frontFace = desc.frontFace;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = desc.depthTest ? VK_TRUE : VK_FALSE;
+    depthStencil.depthWriteEnable = desc.depthWrite ? VK_TRUE : VK_FALSE;
+    depthStencil.depthCompareOp = desc.depthCompareOp;
+    depthStencil.depthBoundsTestEnable = VK_FALSE;
+    depthStencil.stencilTestEnable = VK_FALSE;
+
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                          VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.blendEnable = desc.blendEnable ? VK_TRUE : VK_FALSE;
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
+    pipelineInfo.pStages = shaderStages.data();
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = desc.layout;
+    pipelineInfo.renderPass = desc.renderPass;
+    pipelineInfo.subpass = desc.subpass;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+    VkPipeline pipeline;
+    if (compileGraphicsPipeline(pipelineInfo, &pipeline) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create graphics pipeline!");
+    }
+
+    return pipeline;
+}
+
+VkResult VulkanPipelineCache::compileGraphicsPipeline(const VkGraphicsPipelineCreateInfo &pipelineInfo, VkPipeline *pipeline)
+{
+    auto start = std::chrono::steady_clock::now();
+    RenderCounters::add(RenderCounter::PipelinesCreated);
+    VkResult result = vkCreateGraphicsPipelines(core.getDevice(), vkPipelineCache, 1, &pipelineInfo, nullptr, pipeline);
+
+    stats.compileMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats.compiledPipelines++;
+    dirty = true;
+    return result;
+}
+
+VkResult VulkanPipelineCache::compileComputePipeline(const VkComputePipelineCreateInfo &pipelineInfo, VkPipeline *pipeline)
+{
+    auto start = std::chrono::steady_clock::now();
+    RenderCounters::add(RenderCounter::PipelinesCreated);
+    VkResult result = vkCreateComputePipelines(core.getDevice(), vkPipelineCache, 1, &pipelineInfo, nullptr, pipeline);
+
+    stats.compileMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats.compiledPipelines++;
+    dirty = true;
+    return result;
+}
+
+void VulkanPipelineCache::update()
+{
+    if (!dirty)
+        return;
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - lastSave).count();
+    if (elapsed >= SAVE_INTERVAL_SECONDS)
+        save();
+}
+
+bool VulkanPipelineCache::save()
+{
+    lastSave = std::chrono::steady_clock::now();
+    if (vkPipelineCache == VK_NULL_HANDLE || cacheFile.empty())
+        return false;
+
+    size_t size = 0;
+    if (vkGetPipelineCacheData(core.getDevice(), vkPipelineCache, &size, nullptr) != VK_SUCCESS || size == 0)
+        return false;
+
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(core.getDevice(), vkPipelineCache, &size, data.data()) != VK_SUCCESS)
+        return false;
+
+    // Escreve num temporário e renomeia: um crash no meio não deixa um arquivo truncado
+    std::string tempFile = cacheFile + ".tmp";
+    {
+        std::ofstream file(tempFile, std::ios::binary | std::ios::trunc);
+        if (!file.write(data.data(), static_cast<std::streamsize>(size)))
+        {
+            std::cerr << "Pipeline cache: falha ao escrever " << tempFile << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempFile, cacheFile, error);
+    if (error)
+    {
+        std::cerr << "Pipeline cache: falha ao renomear para " << cacheFile << ": " << error.message() << std::endl;
+        return false;
+    }
+
+    stats.savedBytes = size;
+    dirty = false;
+    return true;
+}
+
+std::vector<char> VulkanPipelineCache::loadCacheData() const
+{
+    std::ifstream file(cacheFile, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return {};
+
+    std::streamsize size = file.tellg();
+    if (size <= 0)
+        return {};
+
+    std::vector<char> data(static_cast<size_t>(size));
+    file.seekg(0);
+    if (!file.read(data.data(), size))
+        return {};
+
+    return data;
+}
+
+bool VulkanPipelineCache::isCacheDataCompatible(const std::vector<char> &data) const
+{
+    if (data.size() < sizeof(VkPipelineCacheHeaderVersionOne))
+        return false;
+
+    VkPipelineCacheHeaderVersionOne header;
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(core.getPhysicalDevice(), &properties);
+
+    return header.headerSize >= sizeof(VkPipelineCacheHeaderVersionOne) &&
+           header.headerSize <= data.size() &&
+           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           header.vendorID == properties.vendorID &&
+           header.deviceID == properties.deviceID &&
+           std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "VulkanCore.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+
+// Estado completo de um pipeline gráfico de material: dois pipelines com a mesma descrição são idênticos
+struct GraphicsPipelineDesc
+{
+    std::string vertShader;
+    std::string fragShader;
+    std::vector<VkVertexInputBindingDescription> vertexBindings;
+    std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    uint32_t subpass = 0;
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+
+    VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+    VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+    VkFrontFace frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    bool depthTest = true;
+    bool depthWrite = true;
+    VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+    bool blendEnable = false;
+
+    bool operator==(const GraphicsPipelineDesc &other) const;
+};
+
+struct PipelineCacheStats
+{
+    uint32_t pipelineCount = 0;
+    uint32_t pipelineLayoutCount = 0;
+    uint32_t setLayoutCount = 0;
+    uint32_t shaderModuleCount = 0;
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+
+    // VkPipelineCache em disco: warm quando o arquivo foi aceito na validação do header
+    bool warmStart = false;
+    size_t loadedBytes = 0;
+    size_t savedBytes = 0;
+    uint32_t compiledPipelines = 0;
+    double compileMs = 0.0;
+};
+
+// Pipelines, layouts e shader modules compartilhados entre materiais. Os objetos pertencem ao cache
+// e vivem até o cleanup; quem pede só guarda o handle (não destrói).
+// Todo pipeline do engine é compilado com o mesmo VkPipelineCache, salvo em disco no cleanup e periodicamente.
+class VulkanPipelineCache
+{
+public:
+    static constexpr const char *CACHE_FILE = "pipeline_cache.bin";
+    static constexpr double SAVE_INTERVAL_SECONDS = 30.0;
+
+    VulkanPipelineCache(VulkanCore &core);
+    ~VulkanPipelineCache();
+
+    void create(const std::string &cacheFile = CACHE_FILE);
+    void cleanup();
+
+    // Salva se pipelines novos foram compilados e o intervalo passou; chamado uma vez por frame
+    void update();
+    bool save();
+
+    // Pipelines que não passam pela descrição de material (fixos, prepass, compute) usam estes wrappers
+    VkResult compileGraphicsPipeline(const VkGraphicsPipelineCreateInfo &pipelineInfo, VkPipeline *pipeline);
+    VkResult compileComputePipeline(const VkComputePipelineCreateInfo &pipelineInfo, VkPipeline *pipeline);
+    VkPipelineCache getVkPipelineCache() const { return vkPipelineCache; }
+
+    VkShaderModule getShaderModule(const std::string &path);
+    VkDescriptorSetLayout getDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding> &bindings);
+    VkPipelineLayout getPipelineLayout(const std::vector<VkDescriptorSetLayout> &setLayouts,
+                                       const std::vector<VkPushConstantRange> &pushConstantRanges);
+    VkPipeline getGraphicsPipeline(const GraphicsPipelineDesc &desc);
+
+    const PipelineCacheStats &getStats() const { return stats; }
+
+private:
+    struct DescHash
+    {
+        size_t operator()(const GraphicsPipelineDesc &desc) const;
+    };
+
+    VkPipeline createGraphicsPipeline(const GraphicsPipelineDesc &desc);
+    std::vector<char> loadCacheData() const;
+    bool isCacheDataCompatible(const std::vector<char> &data) const;
+
+    VulkanCore &core;
+    PipelineCacheStats stats;
+
+    VkPipelineCache vkPipelineCache = VK_NULL_HANDLE;
+    std::string cacheFile;
+    bool dirty = false;
+    std::chrono::steady_clock::time_point lastSave;
+
+    std::unordered_map<std::string, VkShaderModule> shaderModules;
+    // Chave: bytes das estruturas de entrada (sem ponteiros)
+    std::unordered_map<std::string, VkDescriptorSetLayout> setLayouts;
+    std::unordered_map<std::string, VkPipelineLayout> pipelineLayouts;
+    std::unordered_map<GraphicsPipelineDesc, VkPipeline, DescHash> pipelines;
+};
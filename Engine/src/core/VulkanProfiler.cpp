@@ -0,0 +1,242 @@
+#include "VulkanProfiler.h"
+#include <stdexcept>
+
+VulkanProfiler::VulkanProfiler(VulkanCore &core) : core(core)
+{
+}
+
+VulkanProfiler::~VulkanProfiler()
+{
+    cleanup();
+}
+
+void VulkanProfiler::create()
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(core.getPhysicalDevice(), &properties);
+
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(core.getPhysicalDevice(), &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(core.getPhysicalDevice(), &familyCount, families.data());
+
+    statisticsSupported = core.getEnabledFeatures().pipelineStatisticsQuery == VK_TRUE;
+    if (statisticsSupported)
+    {
+        VkQueryPoolCreateInfo statisticsInfo{};
+        statisticsInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        statisticsInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+        statisticsInfo.queryCount = LATENCY;
+        statisticsInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+                                            VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                                            VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+                                            VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+                                            VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+        if (vkCreateQueryPool(core.getDevice(), &statisticsInfo, nullptr, &statisticsPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create pipeline statistics query pool!");
+        }
+    }
+
+    uint32_t validBits = families[core.findQueueFamilies(core.getPhysicalDevice()).graphicsFamily.value()].timestampValidBits;
+    supported = validBits > 0 && properties.limits.timestampPeriod > 0.0f;
+    if (!supported)
+        return;
+
+    timestampPeriod = properties.limits.timestampPeriod;
+    timestampMask = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+
+    // Um bloco de 2 * MAX_SCOPES queries por slot
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = LATENCY * MAX_SCOPES * 2;
+
+    if (vkCreateQueryPool(core.getDevice(), &queryPoolInfo, nullptr, &queryPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create timestamp query pool!");
+    }
+}
+
+void VulkanProfiler::cleanup()
+{
+    if (queryPool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(core.getDevice(), queryPool, nullptr);
+        queryPool = VK_NULL_HANDLE;
+    }
+
+    if (statisticsPool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(core.getDevice(), statisticsPool, nullptr);
+        statisticsPool = VK_NULL_HANDLE;
+    }
+
+    for (auto &slot : slots)
+    {
+        slot = FrameSlot{};
+    }
+    supported = false;
+    statisticsSupported = false;
+    recording = false;
+}
+
+void VulkanProfiler::beginFrame(VkCommandBuffer commandBuffer)
+{
+    if (!supported && !statisticsSupported)
+        return;
+
+    currentSlot = (currentSlot + 1) % LATENCY;
+    FrameSlot &slot = slots[currentSlot];
+
+    // Gravado LATENCY frames atrás: com as fences do core já terminou na GPU
+    if (slot.pending)
+    {
+        resolve(slot);
+    }
+    if (slot.statisticsPending)
+    {
+        resolveStatistics(currentSlot);
+    }
+
+    if (statisticsSupported)
+    {
+        vkCmdResetQueryPool(commandBuffer, statisticsPool, currentSlot, 1);
+        vkCmdBeginQuery(commandBuffer, statisticsPool, currentSlot, 0);
+        slot.statisticsPending = true;
+    }
+
+    if (!supported)
+        return;
+
+    slot.scopes.clear();
+    slot.open.clear();
+    slot.queryCount = 0;
+    slot.pending = false;
+
+    vkCmdResetQueryPool(commandBuffer, queryPool, currentSlot * MAX_SCOPES * 2, MAX_SCOPES * 2);
+    recording = true;
+
+    beginScope(commandBuffer, "Frame");
+}
+
+void VulkanProfiler::endFrame(VkCommandBuffer commandBuffer)
+{
+    FrameSlot &slot = slots[currentSlot];
+    if (slot.statisticsPending)
+    {
+        vkCmdEndQuery(commandBuffer, statisticsPool, currentSlot);
+    }
+
+    if (!supported || !recording)
+        return;
+
+    while (!slot.open.empty())
+    {
+        endScope(commandBuffer);
+    }
+
+    slot.pending = true;
+    recording = false;
+}
+
+void VulkanProfiler::beginScope(VkCommandBuffer commandBuffer, const std::string &name)
+{
+    if (!supported || !recording)
+        return;
+
+    FrameSlot &slot = slots[currentSlot];
+    if (slot.queryCount + 2 > MAX_SCOPES * 2)
+    {
+        // Sem queries livres: o escopo é ignorado, mas o endScope correspondente ainda precisa casar
+        slot.open.push_back(SKIPPED_SCOPE);
+        return;
+    }
+
+    uint32_t base = currentSlot * MAX_SCOPES * 2;
+    Scope scope{name, static_cast<uint32_t>(slot.open.size()), base + slot.queryCount, base + slot.queryCount + 1};
+    slot.queryCount += 2;
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, scope.beginQuery);
+
+    slot.open.push_back(slot.scopes.size());
+    slot.scopes.push_back(scope);
+}
+
+void VulkanProfiler::endScope(VkCommandBuffer commandBuffer)
+{
+    if (!supported || !recording)
+        return;
+
+    FrameSlot &slot = slots[currentSlot];
+    if (slot.open.empty())
+        return;
+
+    size_t index = slot.open.back();
+    slot.open.pop_back();
+    if (index == SKIPPED_SCOPE)
+        return;
+
+    const Scope &scope = slot.scopes[index];
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, scope.endQuery);
+}
+
+void VulkanProfiler::resolve(FrameSlot &slot)
+{
+    if (slot.queryCount == 0)
+        return;
+
+    uint32_t firstQuery = slot.scopes.front().beginQuery;
+    std::vector<uint64_t> results(slot.queryCount);
+
+    // Sem WAIT: se por algum motivo ainda não estiver pronto, o frame é só descartado
+    VkResult result = vkGetQueryPoolResults(core.getDevice(), queryPool, firstQuery, slot.queryCount,
+                                            results.size() * sizeof(uint64_t), results.data(), sizeof(uint64_t),
+                                            VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS)
+        return;
+
+    timings.clear();
+    for (const auto &scope : slot.scopes)
+    {
+        uint64_t begin = results[scope.beginQuery - firstQuery] & timestampMask;
+        uint64_t end = results[scope.endQuery - firstQuery] & timestampMask;
+        float ms = end >= begin ? static_cast<float>((end - begin) * timestampPeriod / 1e6) : 0.0f;
+
+        timings.push_back({scope.name, scope.depth, ms});
+
+        std::deque<float> &history = scopeHistory[scope.name];
+        history.push_back(ms);
+        if (history.size() > HISTORY_SIZE)
+            history.pop_front();
+    }
+
+    frameHistory.push_back(getFrameTime());
+    if (frameHistory.size() > HISTORY_SIZE)
+        frameHistory.pop_front();
+}
+
+void VulkanProfiler::resolveStatistics(uint32_t slotIndex)
+{
+    uint64_t results[5];
+    VkResult result = vkGetQueryPoolResults(core.getDevice(), statisticsPool, slotIndex, 1, sizeof(results), results,
+                                            sizeof(results), VK_QUERY_RESULT_64_BIT);
+    slots[slotIndex].statisticsPending = false;
+    if (result != VK_SUCCESS)
+        return;
+
+    statistics.inputAssemblyPrimitives = results[0];
+    statistics.vertexInvocations = results[1];
+    statistics.clippingPrimitives = results[2];
+    statistics.fragmentInvocations = results[3];
+    statistics.computeInvocations = results[4];
+}
+
+const std::deque<float> &VulkanProfiler::getScopeHistory(const std::string &name) const
+{
+    static const std::deque<float> empty;
+    auto it = scopeHistory.find(name);
+    return it != scopeHistory.end() ? it->second : empty;
+}
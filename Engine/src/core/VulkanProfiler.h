@@ -0,0 +1,124 @@
+#pragma once
+#include "VulkanCore.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+
+struct GpuScopeTiming
+{
+    std::string name;
+    uint32_t depth = 0;
+    float milliseconds = 0.0f;
+};
+
+// Contagens do pipeline no frame inteiro (VK_QUERY_TYPE_PIPELINE_STATISTICS), na ordem dos bits da query
+struct PipelineStatistics
+{
+    uint64_t inputAssemblyPrimitives = 0;
+    uint64_t vertexInvocations = 0;
+    uint64_t clippingPrimitives = 0;
+    uint64_t fragmentInvocations = 0;
+    uint64_t computeInvocations = 0;
+};
+
+// Profiler de GPU com timestamp queries. Os resultados são lidos LATENCY frames depois
+// (o slot já terminou na GPU), então nunca há espera pela fila.
+class VulkanProfiler
+{
+public:
+    static constexpr uint32_t LATENCY = 3;
+    static constexpr uint32_t MAX_SCOPES = 64;
+    static constexpr size_t HISTORY_SIZE = 240;
+
+    VulkanProfiler(VulkanCore &core);
+    ~VulkanProfiler();
+
+    void create();
+    void cleanup();
+
+    // Sem timestampValidBits na fila gráfica os escopos viram no-op
+    bool isSupported() const { return supported; }
+    // Depende da feature pipelineStatisticsQuery
+    bool isPipelineStatisticsSupported() const { return statisticsSupported; }
+
+    // Fora de render pass, antes de qualquer escopo: lê o slot antigo e reseta as queries
+    void beginFrame(VkCommandBuffer commandBuffer);
+    void endFrame(VkCommandBuffer commandBuffer);
+
+    // Escopos podem ser aninhados (passes do RenderGraph, grupos de draws)
+    void beginScope(VkCommandBuffer commandBuffer, const std::string &name);
+    void endScope(VkCommandBuffer commandBuffer);
+
+    // Último frame resolvido (o primeiro escopo é o frame inteiro)
+    const std::vector<GpuScopeTiming> &getTimings() const { return timings; }
+    float getFrameTime() const { return timings.empty() ? 0.0f : timings[0].milliseconds; }
+    const std::deque<float> &getFrameHistory() const { return frameHistory; }
+    const std::deque<float> &getScopeHistory(const std::string &name) const;
+    const PipelineStatistics &getPipelineStatistics() const { return statistics; }
+
+private:
+    struct Scope
+    {
+        std::string name;
+        uint32_t depth;
+        uint32_t beginQuery;
+        uint32_t endQuery;
+    };
+
+    struct FrameSlot
+    {
+        std::vector<Scope> scopes;
+        std::vector<size_t> open; // pilha de índices em scopes
+        uint32_t queryCount = 0;
+        bool pending = false;
+        bool statisticsPending = false;
+    };
+
+    static constexpr size_t SKIPPED_SCOPE = ~size_t(0);
+
+    void resolve(FrameSlot &slot);
+    void resolveStatistics(uint32_t slotIndex);
+
+    VulkanCore &core;
+    bool supported = false;
+    float timestampPeriod = 1.0f; // ns por tick
+    uint64_t timestampMask = ~0ull;
+
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+    VkQueryPool statisticsPool = VK_NULL_HANDLE; // uma query por slot
+    bool statisticsSupported = false;
+    PipelineStatistics statistics;
+    FrameSlot slots[LATENCY];
+    uint32_t currentSlot = 0;
+    bool recording = false;
+
+    std::vector<GpuScopeTiming> timings;
+    std::deque<float> frameHistory;
+    std::map<std::string, std::deque<float>> scopeHistory;
+};
+
+// Escopo RAII: GpuProfileScope scope(profiler, commandBuffer, "Nome");
+class GpuProfileScope
+{
+public:
+    GpuProfileScope(VulkanProfiler *profiler, VkCommandBuffer commandBuffer, const std::string &name)
+        : profiler(profiler), commandBuffer(commandBuffer)
+    {
+        if (profiler)
+            profiler->beginScope(commandBuffer, name);
+    }
+
+    ~GpuProfileScope()
+    {
+        if (profiler)
+            profiler->endScope(commandBuffer);
+    }
+
+    GpuProfileScope(const GpuProfileScope &) = delete;
+    GpuProfileScope &operator=(const GpuProfileScope &) = delete;
+
+private:
+    VulkanProfiler *profiler;
+    VkCommandBuffer commandBuffer;
+};
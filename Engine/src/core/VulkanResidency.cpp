@@ -0,0 +1,290 @@
+#include "VulkanResidency.h"
+#include "VulkanBindless.h"
+#include "VulkanMeshPool.h"
+#include "VulkanUploadContext.h"
+#include "CpuProfiler.h"
+#include "VulkanRenderer.h"
+#include "rendering/Texture.h"
+#include "ecs/components/MeshComponent.h"
+#include "ecs/components/MaterialComponent.h"
+#include <algorithm>
+
+VulkanResidency::VulkanResidency(VulkanCore &core) : core(core)
+{
+}
+
+VulkanResidency::~VulkanResidency()
+{
+    cleanup();
+}
+
+void VulkanResidency::create()
+{
+    core.getAllocator()->setOutOfMemoryHandler([this](VkDeviceSize size) { return handleOutOfMemory(size); });
+    updateBudget();
+}
+
+void VulkanResidency::cleanup()
+{
+    if (core.getAllocator())
+        core.getAllocator()->setOutOfMemoryHandler(nullptr);
+    textureRestores.clear();
+    meshRestoreCount = 0;
+}
+
+void VulkanResidency::update()
+{
+    PROFILE_ZONE("VulkanResidency::update");
+
+    frame++;
+    processRestores();
+
+    updateBudget();
+    if (stats.overBudget && frame > MIN_IDLE_FRAMES)
+    {
+        evictLeastRecentlyUsed(stats.usage - stats.budget, frame - MIN_IDLE_FRAMES, false);
+    }
+
+    stats.evictedTextures = 0;
+    stats.evictedMeshes = 0;
+    if (TextureManager *textures = VulkanRenderer::getInstance().getTextureManager())
+    {
+        for (const auto &[path, texture] : textures->getTextures())
+        {
+            if (texture->evicted)
+                stats.evictedTextures++;
+        }
+    }
+    if (core.getScene())
+    {
+        core.getScene()->forEachEntity([this](const std::shared_ptr<Entity> &entity) {
+            if (entity->hasComponent<MeshComponent>() && entity->getComponent<MeshComponent>().evicted)
+                stats.evictedMeshes++;
+        });
+    }
+}
+
+void VulkanResidency::markUsed(MeshComponent &mesh)
+{
+    mesh.lastUsedFrame = frame;
+    if (mesh.evicted && !mesh.restoreRequested)
+    {
+        mesh.restoreRequested = true;
+        meshRestoreCount++;
+    }
+}
+
+void VulkanResidency::markUsed(const MaterialComponent &material)
+{
+    for (const auto *map : {&material.albedoMap, &material.normalMap, &material.metallicRoughnessMap,
+                            &material.aoMap, &material.emissiveMap})
+    {
+        const std::shared_ptr<Texture> &texture = *map;
+        if (!texture)
+            continue;
+
+        texture->lastUsedFrame = frame;
+        if (texture->evicted && std::find(textureRestores.begin(), textureRestores.end(), texture) == textureRestores.end())
+            textureRestores.push_back(texture);
+    }
+}
+
+void VulkanResidency::updateBudget()
+{
+    const bool driverBudget = core.isMemoryBudgetEnabled();
+
+    VkDeviceSize usage = 0;
+    VkDeviceSize autoBudget = 0;
+    for (const GpuHeapBudget &heap : core.getAllocator()->queryBudget())
+    {
+        if (!heap.deviceLocal)
+            continue;
+
+        usage += heap.usage;
+        autoBudget += driverBudget ? static_cast<VkDeviceSize>(heap.budget * AUTO_BUDGET_FRACTION)
+                                   : static_cast<VkDeviceSize>(heap.size * AUTO_HEAP_FRACTION);
+    }
+
+    stats.budget = budgetOverride > 0 ? budgetOverride : autoBudget;
+    stats.usage = usage;
+    stats.overBudget = usage > stats.budget;
+}
+
+void VulkanResidency::processRestores()
+{
+    uint32_t restored = 0;
+
+    TextureManager *textures = VulkanRenderer::getInstance().getTextureManager();
+    while (!textureRestores.empty() && restored < MAX_RESTORES_PER_FRAME)
+    {
+        std::shared_ptr<Texture> texture = textureRestores.back();
+        textureRestores.pop_back();
+        if (!texture->evicted || !textures->restoreTexture(*texture))
+            continue;
+
+        texture->lastUsedFrame = frame;
+        refreshTexture(*texture);
+        stats.restores++;
+        restored++;
+    }
+
+    if (meshRestoreCount == 0 || !core.getScene())
+        return;
+
+    // Entidades destruídas com pedido pendente somem da contagem aqui
+    uint32_t pending = 0;
+    core.getScene()->forEachEntity([&](const std::shared_ptr<Entity> &entity) {
+        if (!entity->hasComponent<MeshComponent>())
+            return;
+
+        auto &mesh = entity->getComponent<MeshComponent>();
+        if (!mesh.restoreRequested)
+            return;
+
+        if (restored < MAX_RESTORES_PER_FRAME)
+        {
+            restoreMesh(mesh);
+            restored++;
+        }
+        else
+        {
+            pending++;
+        }
+    });
+    meshRestoreCount = pending;
+}
+
+VkDeviceSize VulkanResidency::evictLeastRecentlyUsed(VkDeviceSize bytes, uint64_t usedBefore, bool texturesOnly)
+{
+    VulkanUploadContext *uploads = core.getUploadContext();
+    std::vector<Candidate> candidates;
+
+    // Cópia ainda pendente no lote de uploads: a imagem não pode ser destruída
+    if (TextureManager *textures = VulkanRenderer::getInstance().getTextureManager())
+    {
+        for (const auto &[path, texture] : textures->getTextures())
+        {
+            if (!texture->evicted && !texture->loading && !texture->streaming && !texture->isPacked() &&
+                !texture->sourcePath.empty() && texture->lastUsedFrame < usedBefore &&
+                uploads->isComplete(texture->uploadTicket))
+            {
+                candidates.push_back({texture->lastUsedFrame, texture.get(), nullptr});
+            }
+        }
+    }
+
+    if (!texturesOnly && core.getScene())
+    {
+        core.getScene()->forEachEntity([&](const std::shared_ptr<Entity> &entity) {
+            if (!entity->hasComponent<MeshComponent>())
+                return;
+
+            auto &mesh = entity->getComponent<MeshComponent>();
+            if (mesh.canEvict() && mesh.lastUsedFrame < usedBefore)
+                candidates.push_back({mesh.lastUsedFrame, nullptr, &mesh});
+        });
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate &a, const Candidate &b) { return a.lastUsedFrame < b.lastUsedFrame; });
+
+    VkDeviceSize freed = 0;
+    for (const Candidate &candidate : candidates)
+    {
+        if (freed >= bytes)
+            break;
+        freed += candidate.texture ? evictTexture(*candidate.texture) : evictMesh(*candidate.mesh);
+    }
+    return freed;
+}
+
+bool VulkanResidency::handleOutOfMemory(VkDeviceSize size)
+{
+    // O 1x1 de substituição também aloca: se isso falhar, desiste em vez de entrar de novo
+    if (handlingOutOfMemory)
+        return false;
+
+    // Só texturas: liberam a memória na hora, enquanto as páginas de mesh esperam frames para sair.
+    // Nada usado no frame atual (pode já estar gravado no command buffer).
+    handlingOutOfMemory = true;
+    VkDeviceSize freed = evictLeastRecentlyUsed(size, frame, true);
+    handlingOutOfMemory = false;
+
+    if (freed == 0)
+        return false;
+
+    stats.emergencyEvictions++;
+    // Os 1x1 de substituição vão para a fila antes do frame que está sendo gravado
+    core.getUploadContext()->flush();
+    return true;
+}
+
+VkDeviceSize VulkanResidency::evictTexture(Texture &texture)
+{
+    VkDeviceSize freed = VulkanRenderer::getInstance().getTextureManager()->evictTexture(texture);
+    if (freed == 0)
+        return 0;
+
+    refreshTexture(texture);
+    stats.textureEvictions++;
+    return freed;
+}
+
+VkDeviceSize VulkanResidency::evictMesh(MeshComponent &mesh)
+{
+    VulkanMeshPool *meshPool = core.getMeshPool();
+    const MeshRange &range = meshPool->getRange(mesh.geometry);
+    VkDeviceSize freed = static_cast<VkDeviceSize>(range.vertexCount) * (sizeof(Vertex) + sizeof(glm::vec3)) +
+                         static_cast<VkDeviceSize>(range.indexCount) * sizeof(uint32_t);
+
+    meshPool->free(mesh.geometry);
+    mesh.geometry = INVALID_MESH_HANDLE;
+    mesh.evicted = true;
+    stats.meshEvictions++;
+    return freed;
+}
+
+void VulkanResidency::restoreMesh(MeshComponent &mesh)
+{
+    std::vector<glm::vec3> positions;
+    positions.reserve(mesh.cpuVertices.size());
+    for (const Vertex &vertex : mesh.cpuVertices)
+        positions.push_back(vertex.position);
+
+    // Os LODs são relativos à faixa do mesh: continuam valendo na faixa nova
+    mesh.geometry = core.getMeshPool()->allocate(mesh.cpuVertices.data(), positions.data(),
+                                                 static_cast<uint32_t>(mesh.cpuVertices.size()),
+                                                 mesh.cpuIndices.data(), static_cast<uint32_t>(mesh.cpuIndices.size()));
+    mesh.evicted = false;
+    mesh.restoreRequested = false;
+    mesh.lastUsedFrame = frame;
+    stats.restores++;
+}
+
+void VulkanResidency::refreshTexture(const Texture &texture)
+{
+    VulkanBindless *bindless = core.getBindless();
+    if (bindless && bindless->isEnabled())
+    {
+        bindless->refreshTexture(texture);
+        return;
+    }
+
+    if (!core.getScene())
+        return;
+
+    // Sets por material: só os que usam a textura (nenhum deles foi ligado no frame em gravação)
+    EngineModelLoader *modelLoader = VulkanRenderer::getInstance().getModelLoader();
+    core.getScene()->forEachEntity([&](const std::shared_ptr<Entity> &entity) {
+        if (!entity->hasComponent<MaterialComponent>())
+            return;
+
+        auto &material = entity->getComponent<MaterialComponent>();
+        if (material.albedoMap.get() == &texture || material.normalMap.get() == &texture ||
+            material.metallicRoughnessMap.get() == &texture || material.aoMap.get() == &texture ||
+            material.emissiveMap.get() == &texture)
+        {
+            modelLoader->RefreshMaterialDescriptors(material);
+        }
+    });
+}
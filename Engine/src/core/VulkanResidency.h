@@ -0,0 +1,87 @@
+#pragma once
+#include "VulkanCore.h"
+#include <memory>
+#include <vector>
+
+class Texture;
+struct MeshComponent;
+struct MaterialComponent;
+
+struct ResidencyStats
+{
+    VkDeviceSize budget = 0; // efetivo: configurado ou automático
+    VkDeviceSize usage = 0;  // heaps device-local (do driver com VK_EXT_memory_budget)
+    bool overBudget = false;
+    uint32_t evictedTextures = 0; // despejadas agora
+    uint32_t evictedMeshes = 0;
+    uint64_t textureEvictions = 0;
+    uint64_t meshEvictions = 0;
+    uint64_t emergencyEvictions = 0; // feitas dentro do handler de falta de memória
+    uint64_t restores = 0;
+};
+
+// Orçamento de memória de vídeo. RenderSystem marca o que foi desenhado em cada frame; acima do orçamento,
+// texturas e meshes Static sem uso há MIN_IDLE_FRAMES são despejados, do menos recente para o mais recente.
+// Textura despejada vira um 1x1 com a cor média; mesh despejado some até voltar (um frame depois de
+// ficar visível de novo). Se o driver recusar memória, o handler do VulkanAllocator despeja texturas
+// não usadas no frame atual antes de desistir.
+class VulkanResidency
+{
+public:
+    static constexpr uint64_t MIN_IDLE_FRAMES = 30;
+    // Recargas lêem do disco na thread principal: poucas por frame
+    static constexpr uint32_t MAX_RESTORES_PER_FRAME = 4;
+    // Orçamento automático: fração do budget do driver, ou do tamanho do heap sem a extensão
+    static constexpr float AUTO_BUDGET_FRACTION = 0.9f;
+    static constexpr float AUTO_HEAP_FRACTION = 0.8f;
+
+    VulkanResidency(VulkanCore &core);
+    ~VulkanResidency();
+
+    void create();
+    void cleanup();
+
+    // Depois da fence do frame anterior, antes do VulkanUploadContext::update: recargas pedidas e despejos
+    void update();
+
+    // Chamados pelo prepareFrame para cada draw visível; itens despejados são trazidos de volta
+    void markUsed(MeshComponent &mesh);
+    void markUsed(const MaterialComponent &material);
+
+    // 0 = automático
+    void setBudget(VkDeviceSize bytes) { budgetOverride = bytes; }
+    VkDeviceSize getBudgetOverride() const { return budgetOverride; }
+
+    uint64_t getFrame() const { return frame; }
+    const ResidencyStats &getStats() const { return stats; }
+
+    // Bindless ou sets por material: quem amostra a textura passa a ver a imagem nova
+    void refreshTexture(const Texture &texture);
+
+private:
+    struct Candidate
+    {
+        uint64_t lastUsedFrame = 0;
+        Texture *texture = nullptr;
+        MeshComponent *mesh = nullptr;
+    };
+
+    void updateBudget();
+    void processRestores();
+    // Despeja, do menos para o mais recente, itens usados antes de usedBefore até liberar bytes
+    VkDeviceSize evictLeastRecentlyUsed(VkDeviceSize bytes, uint64_t usedBefore, bool texturesOnly);
+    bool handleOutOfMemory(VkDeviceSize size);
+
+    VkDeviceSize evictTexture(Texture &texture);
+    VkDeviceSize evictMesh(MeshComponent &mesh);
+    void restoreMesh(MeshComponent &mesh);
+
+    VulkanCore &core;
+    ResidencyStats stats;
+    uint64_t frame = 0;
+    VkDeviceSize budgetOverride = 0;
+    bool handlingOutOfMemory = false;
+
+    std::vector<std::shared_ptr<Texture>> textureRestores;
+    uint32_t meshRestoreCount = 0; // meshes com restoreRequested
+};
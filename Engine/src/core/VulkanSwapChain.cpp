@@ -3,6 +3,7 @@
 #include "VulkanPipeline.h"
 #include "VulkanDescriptor.h"
 #include "VulkanImGui.h"
+#include "VulkanDeletionQueue.h"
 #include <algorithm>
 #include <limits>
 #include <stdexcept>
@@ -60,11 +61,14 @@ void VulkanSwapChain::create() {
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     createInfo.presentMode = presentMode;
     createInfo.clipped = VK_TRUE;
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
+    // No recreate, a swapchain atual é aposentada pela nova
+    createInfo.oldSwapchain = swapChain;
 
-    if (vkCreateSwapchainKHR(core.getDevice(), &createInfo, nullptr, &swapChain) != VK_SUCCESS) {
+    VkSwapchainKHR newSwapChain = VK_NULL_HANDLE;
+    if (vkCreateSwapchainKHR(core.getDevice(), &createInfo, nullptr, &newSwapChain) != VK_SUCCESS) {
         throw std::runtime_error("failed to create swap chain!");
     }
+    swapChain = newSwapChain;
 
     vkGetSwapchainImagesKHR(core.getDevice(), swapChain, &imageCount, nullptr);
     swapChainImages.resize(imageCount);
@@ -76,56 +80,8 @@ void VulkanSwapChain::create() {
     createImageViews();
 }
 
-void VulkanSwapChain::createFramebuffers() {
-    // Limpar framebuffers existentes
-    for (auto framebuffer : framebuffers) {
-        if (framebuffer != VK_NULL_HANDLE) {
-            vkDestroyFramebuffer(core.getDevice(), framebuffer, nullptr);
-        }
-    }
-    
-    framebuffers.resize(swapChainImageViews.size());
-    
-    // Obter depth image view de forma segura
-    VkImageView depthView = core.getDepthImageView();
-    if (depthView == VK_NULL_HANDLE) {
-        throw std::runtime_error("Depth image view não foi criado!");
-    }
-    
-    for (size_t i = 0; i < swapChainImageViews.size(); i++) {
-        if (swapChainImageViews[i] == VK_NULL_HANDLE) {
-            throw std::runtime_error("Image view inválido no índice " + std::to_string(i));
-        }
-
-        std::array<VkImageView, 2> attachments = {
-            swapChainImageViews[i],  // Color attachment
-            depthView               // Depth attachment  
-        };
-
-        VkFramebufferCreateInfo framebufferInfo{};
-        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        framebufferInfo.renderPass = core.getRenderPass();
-        framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-        framebufferInfo.pAttachments = attachments.data();
-        framebufferInfo.width = swapChainExtent.width;
-        framebufferInfo.height = swapChainExtent.height;
-        framebufferInfo.layers = 1;
-
-        if (vkCreateFramebuffer(core.getDevice(), &framebufferInfo, nullptr, &framebuffers[i]) != VK_SUCCESS) {
-            throw std::runtime_error("Falha ao criar framebuffer!");
-        }
-    }
-}
-
 void VulkanSwapChain::cleanup() {
     auto device = core.getDevice();
-    for (auto framebuffer : framebuffers) {
-        if (framebuffer != VK_NULL_HANDLE) {
-            vkDestroyFramebuffer(device, framebuffer, nullptr);
-        }
-    }
-    framebuffers.clear();
-
     for (auto imageView : swapChainImageViews) {
         vkDestroyImageView(device, imageView, nullptr);
     }
@@ -138,9 +94,23 @@ void VulkanSwapChain::cleanup() {
 }
 
 void VulkanSwapChain::recreate() {
-    vkDeviceWaitIdle(core.getDevice());
-    cleanup();
+    // O frame em voo ainda pode estar escrevendo numa imagem da swapchain antiga:
+    // ela e as views saem pela fila de destruição
+    VkSwapchainKHR oldSwapChain = swapChain;
+    std::vector<VkImageView> oldImageViews = std::move(swapChainImageViews);
+    swapChainImageViews.clear();
+
     create();
+
+    VkDevice device = core.getDevice();
+    core.getDeletionQueue()->push([device, oldSwapChain, oldImageViews]() {
+        for (auto imageView : oldImageViews) {
+            vkDestroyImageView(device, imageView, nullptr);
+        }
+        if (oldSwapChain != VK_NULL_HANDLE) {
+            vkDestroySwapchainKHR(device, oldSwapChain, nullptr);
+        }
+    });
 }
 
 void VulkanSwapChain::createSwapChain() {
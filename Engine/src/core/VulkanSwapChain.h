@@ -20,12 +20,10 @@ public:
     VkFormat getImageFormat() const { return swapChainImageFormat; }
     size_t getImageCount() const { return swapChainImages.size(); }
     const std::vector<VkImageView>& getImageViews() const { return swapChainImageViews; }
-    std::vector<VkFramebuffer> getFramebuffers() const { return framebuffers; }
     std::vector<VkImage> getImages() const { return swapChainImages; }
 private:
     void createSwapChain();
     void createImageViews();
-    void createFramebuffers();
     VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
     VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
     VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
@@ -36,7 +34,6 @@ private:
     std::vector<VkImageView> swapChainImageViews;
     VkFormat swapChainImageFormat;
     VkExtent2D swapChainExtent;
-    std::vector<VkFramebuffer> framebuffers;
 };
 
 #endif
\ No newline at end of file
@@ -7,6 +7,8 @@
 struct QueueFamilyIndices {
     std::optional<uint32_t> graphicsFamily;
     std::optional<uint32_t> presentFamily;
+    // Família só de transferência (DMA), se existir; uploads rodam nela em paralelo aos frames
+    std::optional<uint32_t> transferFamily;
     
     bool isComplete() {
         return graphicsFamily.has_value() && presentFamily.has_value();
@@ -60,11 +62,35 @@ struct Vertex {
     }
 };
 
+// Dados por frame: escritos uma única vez no início do frame
 struct UBO {
-    alignas(16) glm::mat4 model;
     alignas(16) glm::mat4 view;
     alignas(16) glm::mat4 proj;
-    alignas(16) Material material;
+    alignas(16) glm::vec4 cameraPos;
+};
+
+// Dados por draw: enviados com vkCmdPushConstants (máximo garantido de 128 bytes)
+struct PushConstants {
+    static constexpr VkShaderStageFlags stages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    glm::mat4 model;
+    uint32_t materialIndex;
+    uint32_t padding[3];
+};
+
+// Parâmetros de material (std430, ver pbr.frag e pbr_bindless.frag): fatores constantes, multiplicados
+// pelas texturas (brancas quando o mapa não existe); os índices no array global só valem no bindless
+struct GPUMaterial {
+    glm::vec4 baseColorFactor;
+    glm::vec4 emissiveFactor; // w sem uso
+    float metallicFactor;
+    float roughnessFactor;
+    uint32_t albedoTexture;
+    uint32_t normalTexture;
+    uint32_t metallicRoughnessTexture;
+    uint32_t aoTexture;
+    uint32_t emissiveTexture;
+    uint32_t padding;
 };
 
 struct GPULight {
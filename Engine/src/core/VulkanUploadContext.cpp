@@ -0,0 +1,613 @@
+#include "VulkanUploadContext.h"
+#include "CpuProfiler.h"
+#include "RenderCounters.h"
+#include <stdexcept>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+    // Onde os recursos enviados são consumidos pelos passes do grafo (e copiados pela compactação do VulkanMeshPool)
+    constexpr VkPipelineStageFlags CONSUMER_STAGES = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+                                                     VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                                     VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                                     VK_PIPELINE_STAGE_TRANSFER_BIT;
+    constexpr VkAccessFlags BUFFER_READ_ACCESS = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                                                 VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT |
+                                                 VK_ACCESS_TRANSFER_READ_BIT;
+}
+
+VulkanUploadContext::VulkanUploadContext(VulkanCore &core) : core(core)
+{
+}
+
+VulkanUploadContext::~VulkanUploadContext()
+{
+    cleanup();
+}
+
+void VulkanUploadContext::create()
+{
+    QueueFamilyIndices indices = core.findQueueFamilies(core.getPhysicalDevice());
+    graphicsFamily = indices.graphicsFamily.value();
+    transferFamily = indices.transferFamily.value_or(graphicsFamily);
+    transferQueue = core.getTransferQueue();
+    stats = UploadStats{};
+    stats.dedicatedTransferQueue = transferFamily != graphicsFamily;
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = transferFamily;
+    if (vkCreateCommandPool(core.getDevice(), &poolInfo, nullptr, &transferPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create upload command pool!");
+    }
+
+    if (stats.dedicatedTransferQueue)
+    {
+        poolInfo.queueFamilyIndex = graphicsFamily;
+        if (vkCreateCommandPool(core.getDevice(), &poolInfo, nullptr, &acquirePool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create upload acquire command pool!");
+        }
+    }
+
+    core.createBuffer(STAGING_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                      stagingBuffer, stagingMemory, GpuMemoryCategory::Staging);
+    stagingHead = stagingTail = stagingUsed = 0;
+    stats.stagingCapacity = STAGING_SIZE;
+}
+
+void VulkanUploadContext::cleanup()
+{
+    VkDevice device = core.getDevice();
+    if (device == VK_NULL_HANDLE || transferPool == VK_NULL_HANDLE)
+        return;
+
+    waitIdle();
+
+    for (Batch &batch : freeBatches)
+        destroyBatchObjects(batch);
+    freeBatches.clear();
+
+    if (stagingBuffer != VK_NULL_HANDLE)
+        core.destroyBuffer(stagingBuffer, stagingMemory);
+
+    if (acquirePool != VK_NULL_HANDLE)
+    {
+        vkDestroyCommandPool(device, acquirePool, nullptr);
+        acquirePool = VK_NULL_HANDLE;
+    }
+
+    vkDestroyCommandPool(device, transferPool, nullptr);
+    transferPool = VK_NULL_HANDLE;
+}
+
+VulkanUploadContext::Batch VulkanUploadContext::createBatchObjects()
+{
+    VkDevice device = core.getDevice();
+    Batch batch;
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = transferPool;
+    allocInfo.commandBufferCount = 1;
+    if (vkAllocateCommandBuffers(device, &allocInfo, &batch.transferCommands) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate upload command buffer!");
+    }
+
+    if (stats.dedicatedTransferQueue)
+    {
+        allocInfo.commandPool = acquirePool;
+        if (vkAllocateCommandBuffers(device, &allocInfo, &batch.acquireCommands) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to allocate upload acquire command buffer!");
+        }
+
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &batch.transferDone) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create upload semaphore!");
+        }
+    }
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    if (vkCreateFence(device, &fenceInfo, nullptr, &batch.fence) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create upload fence!");
+    }
+
+    return batch;
+}
+
+void VulkanUploadContext::destroyBatchObjects(Batch &batch)
+{
+    // Command buffers voltam junto com os pools
+    VkDevice device = core.getDevice();
+    if (batch.transferDone != VK_NULL_HANDLE)
+        vkDestroySemaphore(device, batch.transferDone, nullptr);
+    if (batch.fence != VK_NULL_HANDLE)
+        vkDestroyFence(device, batch.fence, nullptr);
+    batch = Batch{};
+}
+
+VulkanUploadContext::Batch &VulkanUploadContext::openBatch()
+{
+    if (hasOpenBatch)
+        return current;
+
+    if (!freeBatches.empty())
+    {
+        current = std::move(freeBatches.back());
+        freeBatches.pop_back();
+    }
+    else
+    {
+        current = createBatchObjects();
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(current.transferCommands, &beginInfo);
+
+    hasOpenBatch = true;
+    return current;
+}
+
+bool VulkanUploadContext::tryAllocateRing(VkDeviceSize size, VkDeviceSize &offset)
+{
+    if (stagingUsed == 0)
+        stagingHead = stagingTail = 0;
+
+    VkDeviceSize aligned = (stagingHead + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+    VkDeviceSize consumed;
+
+    if (stagingHead >= stagingTail && !(stagingHead == stagingTail && stagingUsed > 0))
+    {
+        // Livre: [head, fim) e [0, tail)
+        if (aligned + size <= STAGING_SIZE)
+        {
+            offset = aligned;
+            consumed = aligned - stagingHead + size;
+        }
+        else if (size <= stagingTail)
+        {
+            // Volta ao início; o resto do fim fica com o lote até ele terminar
+            offset = 0;
+            consumed = STAGING_SIZE - stagingHead + size;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    else
+    {
+        // Livre: [head, tail)
+        if (aligned + size > stagingTail)
+            return false;
+        offset = aligned;
+        consumed = aligned - stagingHead + size;
+    }
+
+    stagingHead = offset + size;
+    stagingUsed += consumed;
+    openStagingConsumed += consumed;
+    return true;
+}
+
+void *VulkanUploadContext::allocateStaging(VkDeviceSize size, VkBuffer &buffer, VkDeviceSize &offset)
+{
+    if (size > STAGING_SIZE)
+    {
+        GpuAllocation memory;
+        core.createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          buffer, memory, GpuMemoryCategory::Staging);
+        openOversize.emplace_back(buffer, memory);
+        offset = 0;
+        return memory.mapped;
+    }
+
+    while (!tryAllocateRing(size, offset))
+    {
+        // Ring cheio: submete o que está aberto e espera o lote mais antigo liberar espaço
+        PROFILE_ZONE("UploadContext::StagingStall");
+        stats.stallCount++;
+        if (hasOpenBatch)
+            flush();
+        if (!retireOldest(true))
+        {
+            throw std::runtime_error("upload staging ring exhausted!");
+        }
+    }
+
+    buffer = stagingBuffer;
+    return static_cast<char *>(stagingMemory.mapped) + offset;
+}
+
+void VulkanUploadContext::uploadBuffer(VkBuffer dst, VkDeviceSize dstOffset, const void *data, VkDeviceSize size)
+{
+    VkBuffer srcBuffer;
+    VkDeviceSize srcOffset;
+    void *mapped = allocateStaging(size, srcBuffer, srcOffset);
+    memcpy(mapped, data, static_cast<size_t>(size));
+    RenderCounters::add(RenderCounter::UploadBytes, size);
+    stats.uploadedBytes += size;
+
+    Batch &batch = openBatch();
+
+    VkBufferCopy region{};
+    region.srcOffset = srcOffset;
+    region.dstOffset = dstOffset;
+    region.size = size;
+    vkCmdCopyBuffer(batch.transferCommands, srcBuffer, dst, 1, &region);
+
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = BUFFER_READ_ACCESS;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = dst;
+    barrier.offset = dstOffset;
+    barrier.size = size;
+
+    if (stats.dedicatedTransferQueue)
+    {
+        barrier.srcQueueFamilyIndex = transferFamily;
+        barrier.dstQueueFamilyIndex = graphicsFamily;
+
+        VkBufferMemoryBarrier acquire = barrier;
+        acquire.srcAccessMask = 0;
+        batch.bufferAcquires.push_back(acquire);
+
+        barrier.dstAccessMask = 0;
+    }
+
+    batch.bufferReleases.push_back(barrier);
+    batch.copyCount++;
+}
+
+void VulkanUploadContext::uploadImage(VkImage image, uint32_t width, uint32_t height, const void *data, VkDeviceSize size,
+                                      uint32_t mipLevels, VkImageLayout finalLayout)
+{
+    VkBufferImageCopy region{};
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = {width, height, 1};
+    recordImageUpload(image, width, height, data, size, {region}, mipLevels, finalLayout, false);
+}
+
+void VulkanUploadContext::uploadImageLevels(VkImage image, uint32_t width, uint32_t height, const void *data,
+                                            VkDeviceSize size, const std::vector<VkDeviceSize> &levelOffsets,
+                                            uint32_t arrayLayer)
+{
+    std::vector<VkBufferImageCopy> regions(levelOffsets.size());
+    for (uint32_t level = 0; level < regions.size(); level++)
+    {
+        regions[level].bufferOffset = levelOffsets[level];
+        regions[level].imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, arrayLayer, 1};
+        regions[level].imageExtent = {std::max(1u, width >> level), std::max(1u, height >> level), 1};
+    }
+    recordImageUpload(image, width, height, data, size, std::move(regions), static_cast<uint32_t>(levelOffsets.size()),
+                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false, arrayLayer);
+}
+
+void VulkanUploadContext::uploadImageGenerateMips(VkImage image, uint32_t width, uint32_t height, const void *data,
+                                                  VkDeviceSize size, uint32_t mipLevels)
+{
+    VkBufferImageCopy region{};
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = {width, height, 1};
+    recordImageUpload(image, width, height, data, size, {region}, mipLevels, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                      mipLevels > 1);
+}
+
+void VulkanUploadContext::recordImageUpload(VkImage image, uint32_t width, uint32_t height, const void *data,
+                                            VkDeviceSize size, std::vector<VkBufferImageCopy> regions,
+                                            uint32_t mipLevels, VkImageLayout finalLayout, bool generateMips,
+                                            uint32_t arrayLayer)
+{
+    VkBuffer srcBuffer;
+    VkDeviceSize srcOffset;
+    void *mapped = allocateStaging(size, srcBuffer, srcOffset);
+    memcpy(mapped, data, static_cast<size_t>(size));
+    RenderCounters::add(RenderCounter::UploadBytes, size);
+    stats.uploadedBytes += size;
+
+    Batch &batch = openBatch();
+
+    VkImageMemoryBarrier toTransfer{};
+    toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    toTransfer.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.image = image;
+    toTransfer.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, arrayLayer, 1};
+    toTransfer.srcAccessMask = 0;
+    toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(batch.transferCommands, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+    for (VkBufferImageCopy &region : regions)
+        region.bufferOffset += srcOffset;
+    vkCmdCopyBufferToImage(batch.transferCommands, srcBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()), regions.data());
+    batch.copyCount++;
+
+    if (generateMips)
+    {
+        MipGeneration mips{image, width, height, mipLevels};
+        if (!stats.dedicatedTransferQueue)
+        {
+            // A "fila de transferência" é a gráfica: os blits seguem a cópia no mesmo command buffer
+            recordMipBlits(batch.transferCommands, mips);
+            return;
+        }
+
+        // Ownership passa para a fila gráfica ainda em TRANSFER_DST; os blits rodam depois do acquire
+        VkImageMemoryBarrier release = toTransfer;
+        release.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        release.srcQueueFamilyIndex = transferFamily;
+        release.dstQueueFamilyIndex = graphicsFamily;
+        release.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        release.dstAccessMask = 0;
+
+        VkImageMemoryBarrier acquire = release;
+        acquire.srcAccessMask = 0;
+        acquire.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+        batch.imageReleases.push_back(release);
+        batch.imageAcquires.push_back(acquire);
+        batch.mipGenerations.push_back(mips);
+        return;
+    }
+
+    VkImageMemoryBarrier barrier = toTransfer;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = finalLayout;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    if (stats.dedicatedTransferQueue)
+    {
+        // A transição de layout acontece uma vez, descrita igual no release e no acquire
+        barrier.srcQueueFamilyIndex = transferFamily;
+        barrier.dstQueueFamilyIndex = graphicsFamily;
+
+        VkImageMemoryBarrier acquire = barrier;
+        acquire.srcAccessMask = 0;
+        batch.imageAcquires.push_back(acquire);
+
+        barrier.dstAccessMask = 0;
+    }
+
+    batch.imageReleases.push_back(barrier);
+}
+
+void VulkanUploadContext::recordMipBlits(VkCommandBuffer commandBuffer, const MipGeneration &mips)
+{
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = mips.image;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+    int32_t mipWidth = static_cast<int32_t>(mips.width);
+    int32_t mipHeight = static_cast<int32_t>(mips.height);
+
+    for (uint32_t level = 1; level < mips.mipLevels; level++)
+    {
+        // Nível anterior: escrito pela cópia (ou pelo blit de antes), agora origem
+        barrier.subresourceRange.baseMipLevel = level - 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                             nullptr, 0, nullptr, 1, &barrier);
+
+        int32_t nextWidth = std::max(1, mipWidth / 2);
+        int32_t nextHeight = std::max(1, mipHeight / 2);
+
+        VkImageBlit blit{};
+        blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1};
+        blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
+        blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+        blit.dstOffsets[1] = {nextWidth, nextHeight, 1};
+        vkCmdBlitImage(commandBuffer, mips.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, mips.image,
+                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, CONSUMER_STAGES, 0, 0, nullptr, 0,
+                             nullptr, 1, &barrier);
+
+        mipWidth = nextWidth;
+        mipHeight = nextHeight;
+    }
+
+    // Último nível só foi escrito
+    barrier.subresourceRange.baseMipLevel = mips.mipLevels - 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, CONSUMER_STAGES, 0, 0, nullptr, 0, nullptr,
+                         1, &barrier);
+}
+
+void VulkanUploadContext::onComplete(std::function<void()> callback)
+{
+    if (hasOpenBatch)
+        current.callbacks.push_back(std::move(callback));
+    else if (!inFlight.empty())
+        inFlight.back().callbacks.push_back(std::move(callback));
+    else
+        callback();
+}
+
+UploadTicket VulkanUploadContext::flush()
+{
+    if (!hasOpenBatch)
+        return nextTicket - 1;
+
+    PROFILE_ZONE("UploadContext::Flush");
+
+    Batch batch = std::move(current);
+    current = Batch{};
+    hasOpenBatch = false;
+
+    batch.ticket = nextTicket++;
+    batch.stagingEnd = stagingHead;
+    batch.stagingConsumed = openStagingConsumed;
+    batch.oversizeStaging = std::move(openOversize);
+    openStagingConsumed = 0;
+    openOversize.clear();
+
+    // Todas as barreiras pós-cópia do lote numa única chamada
+    VkPipelineStageFlags releaseDstStages = stats.dedicatedTransferQueue ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : CONSUMER_STAGES;
+    vkCmdPipelineBarrier(batch.transferCommands, VK_PIPELINE_STAGE_TRANSFER_BIT, releaseDstStages, 0, 0, nullptr,
+                         static_cast<uint32_t>(batch.bufferReleases.size()), batch.bufferReleases.data(),
+                         static_cast<uint32_t>(batch.imageReleases.size()), batch.imageReleases.data());
+
+    if (vkEndCommandBuffer(batch.transferCommands) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to record upload command buffer!");
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.transferCommands;
+
+    if (stats.dedicatedTransferQueue)
+    {
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &batch.transferDone;
+        if (vkQueueSubmit(transferQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to submit upload batch!");
+        }
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(batch.acquireCommands, &beginInfo);
+        vkCmdPipelineBarrier(batch.acquireCommands, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, CONSUMER_STAGES, 0, 0, nullptr,
+                             static_cast<uint32_t>(batch.bufferAcquires.size()), batch.bufferAcquires.data(),
+                             static_cast<uint32_t>(batch.imageAcquires.size()), batch.imageAcquires.data());
+        for (const MipGeneration &mips : batch.mipGenerations)
+            recordMipBlits(batch.acquireCommands, mips);
+        vkEndCommandBuffer(batch.acquireCommands);
+
+        VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        VkSubmitInfo acquireInfo{};
+        acquireInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        acquireInfo.waitSemaphoreCount = 1;
+        acquireInfo.pWaitSemaphores = &batch.transferDone;
+        acquireInfo.pWaitDstStageMask = &waitStage;
+        acquireInfo.commandBufferCount = 1;
+        acquireInfo.pCommandBuffers = &batch.acquireCommands;
+
+        // Frames submetidos depois na fila gráfica ficam ordenados após o acquire
+        if (vkQueueSubmit(core.getGraphicsQueue(), 1, &acquireInfo, batch.fence) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to submit upload acquire!");
+        }
+    }
+    else if (vkQueueSubmit(transferQueue, 1, &submitInfo, batch.fence) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to submit upload batch!");
+    }
+
+    stats.submittedBatches++;
+    UploadTicket ticket = batch.ticket;
+    inFlight.push_back(std::move(batch));
+    return ticket;
+}
+
+bool VulkanUploadContext::retireOldest(bool block)
+{
+    if (inFlight.empty())
+        return false;
+
+    Batch &batch = inFlight.front();
+    if (block)
+    {
+        PROFILE_ZONE("UploadContext::Wait");
+        vkWaitForFences(core.getDevice(), 1, &batch.fence, VK_TRUE, UINT64_MAX);
+    }
+    else if (vkGetFenceStatus(core.getDevice(), batch.fence) != VK_SUCCESS)
+    {
+        return false;
+    }
+
+    // Lotes terminam em ordem de submissão: o staging do mais antigo é o início do ring
+    stagingTail = batch.stagingEnd;
+    stagingUsed -= batch.stagingConsumed;
+
+    for (auto &staging : batch.oversizeStaging)
+        core.destroyBuffer(staging.first, staging.second);
+
+    completedTicket = batch.ticket;
+    std::vector<std::function<void()>> callbacks = std::move(batch.callbacks);
+
+    vkResetFences(core.getDevice(), 1, &batch.fence);
+    vkResetCommandBuffer(batch.transferCommands, 0);
+    if (batch.acquireCommands != VK_NULL_HANDLE)
+        vkResetCommandBuffer(batch.acquireCommands, 0);
+
+    Batch recycled;
+    recycled.transferCommands = batch.transferCommands;
+    recycled.acquireCommands = batch.acquireCommands;
+    recycled.transferDone = batch.transferDone;
+    recycled.fence = batch.fence;
+    freeBatches.push_back(std::move(recycled));
+    inFlight.pop_front();
+
+    for (auto &callback : callbacks)
+        callback();
+    return true;
+}
+
+void VulkanUploadContext::wait(UploadTicket ticket)
+{
+    if (ticket >= nextTicket)
+        flush();
+
+    while (completedTicket < ticket && retireOldest(true))
+    {
+    }
+}
+
+void VulkanUploadContext::waitIdle()
+{
+    flush();
+    while (retireOldest(true))
+    {
+    }
+}
+
+void VulkanUploadContext::update()
+{
+    flush();
+    while (retireOldest(false))
+    {
+    }
+
+    stats.pendingCopies = hasOpenBatch ? current.copyCount : 0;
+    stats.inFlightBatches = static_cast<uint32_t>(inFlight.size());
+    stats.stagingUsed = stagingUsed;
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include "VulkanCore.h"
+#include <deque>
+#include <functional>
+#include <vector>
+
+// Identifica um lote de uploads; completo quando a fence do lote sinaliza
+using UploadTicket = uint64_t;
+
+struct UploadStats
+{
+    uint64_t submittedBatches = 0;
+    uint64_t uploadedBytes = 0;
+    uint32_t pendingCopies = 0;   // gravadas no lote aberto, ainda não submetidas
+    uint32_t inFlightBatches = 0;
+    uint64_t stagingUsed = 0;
+    uint64_t stagingCapacity = 0;
+    uint32_t stallCount = 0;       // vezes em que o ring encheu e foi preciso esperar a GPU
+    bool dedicatedTransferQueue = false;
+};
+
+// Uploads em lote: cópias e barreiras de muitos buffers/imagens vão num único command buffer,
+// com staging num ring host-visible e uma fence por lote. Nada bloqueia a thread principal, exceto
+// quando o ring enche. Com fila de transferência dedicada, o lote roda nela e uma segunda submissão
+// na fila gráfica (esperando um semáforo) faz a aquisição de ownership e a transição final.
+class VulkanUploadContext
+{
+public:
+    static constexpr VkDeviceSize STAGING_SIZE = 64ull * 1024 * 1024;
+    static constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+    VulkanUploadContext(VulkanCore &core);
+    ~VulkanUploadContext();
+
+    void create();
+    void cleanup();
+
+    // Copia data para dst; o buffer só pode ser lido pela GPU depois do lote (ordem da fila garante isso)
+    void uploadBuffer(VkBuffer dst, VkDeviceSize dstOffset, const void *data, VkDeviceSize size);
+    // Imagem inteira (nível 0) de UNDEFINED para finalLayout; os demais níveis só mudam de layout
+    void uploadImage(VkImage image, uint32_t width, uint32_t height, const void *data, VkDeviceSize size,
+                     uint32_t mipLevels = 1, VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    // Todos os níveis já prontos em data, um atrás do outro; levelOffsets[i] é o início do nível i.
+    // Num array, só a camada arrayLayer muda de layout (as outras podem estar em uso pelo frame)
+    void uploadImageLevels(VkImage image, uint32_t width, uint32_t height, const void *data, VkDeviceSize size,
+                           const std::vector<VkDeviceSize> &levelOffsets, uint32_t arrayLayer = 0);
+    // Nível 0 de data; os demais saem dele por vkCmdBlitImage na fila gráfica (o formato precisa de
+    // filtro linear com tiling optimal e a imagem de TRANSFER_SRC). Termina em SHADER_READ_ONLY.
+    void uploadImageGenerateMips(VkImage image, uint32_t width, uint32_t height, const void *data, VkDeviceSize size,
+                                 uint32_t mipLevels);
+
+    // Chamado quando o lote que contém os uploads gravados até agora terminar
+    void onComplete(std::function<void()> callback);
+
+    // Submete o lote aberto (se houver); o ticket devolvido vale para tudo gravado até aqui
+    UploadTicket flush();
+    bool isComplete(UploadTicket ticket) const { return ticket <= completedTicket; }
+    // Já na fila: comandos gravados depois, na fila gráfica, enxergam as cópias
+    bool isSubmitted(UploadTicket ticket) const { return ticket < nextTicket; }
+    // Ticket que o lote aberto vai receber no flush (vale para o que for gravado até lá)
+    UploadTicket getOpenTicket() const { return nextTicket; }
+    void wait(UploadTicket ticket);
+    void waitIdle();
+
+    // Uma vez por frame, antes de gravar o frame: submete o lote aberto e recolhe os concluídos
+    void update();
+
+    const UploadStats &getStats() const { return stats; }
+
+private:
+    // Imagem cujos mips são gerados por blit depois da cópia do nível 0
+    struct MipGeneration
+    {
+        VkImage image = VK_NULL_HANDLE;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t mipLevels = 1;
+    };
+
+    struct Batch
+    {
+        UploadTicket ticket = 0;
+        VkCommandBuffer transferCommands = VK_NULL_HANDLE;
+        VkCommandBuffer acquireCommands = VK_NULL_HANDLE;
+        VkSemaphore transferDone = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+
+        VkDeviceSize stagingEnd = 0;
+        VkDeviceSize stagingConsumed = 0;
+        // Uploads maiores que o ring ganham um staging próprio, liberado quando o lote termina
+        std::vector<std::pair<VkBuffer, GpuAllocation>> oversizeStaging;
+        std::vector<std::function<void()>> callbacks;
+
+        // Barreiras pós-cópia: "release" no fim do command buffer de transferência e, com fila
+        // dedicada, o "acquire" correspondente na fila gráfica
+        std::vector<VkBufferMemoryBarrier> bufferReleases;
+        std::vector<VkImageMemoryBarrier> imageReleases;
+        std::vector<VkBufferMemoryBarrier> bufferAcquires;
+        std::vector<VkImageMemoryBarrier> imageAcquires;
+        // Com fila dedicada, os blits vão no command buffer de acquire (a fila de transferência não faz blit)
+        std::vector<MipGeneration> mipGenerations;
+        uint32_t copyCount = 0;
+    };
+
+    void recordImageUpload(VkImage image, uint32_t width, uint32_t height, const void *data, VkDeviceSize size,
+                           std::vector<VkBufferImageCopy> regions, uint32_t mipLevels, VkImageLayout finalLayout,
+                           bool generateMips, uint32_t arrayLayer = 0);
+    // Todos os níveis em TRANSFER_DST com o nível 0 escrito; termina com todos em SHADER_READ_ONLY
+    void recordMipBlits(VkCommandBuffer commandBuffer, const MipGeneration &mips);
+    Batch &openBatch();
+    void *allocateStaging(VkDeviceSize size, VkBuffer &buffer, VkDeviceSize &offset);
+    bool tryAllocateRing(VkDeviceSize size, VkDeviceSize &offset);
+    bool retireOldest(bool block);
+    Batch createBatchObjects();
+    void destroyBatchObjects(Batch &batch);
+
+    VulkanCore &core;
+    UploadStats stats;
+
+    uint32_t graphicsFamily = 0;
+    uint32_t transferFamily = 0;
+    VkQueue transferQueue = VK_NULL_HANDLE;
+    VkCommandPool transferPool = VK_NULL_HANDLE;
+    VkCommandPool acquirePool = VK_NULL_HANDLE;
+
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    GpuAllocation stagingMemory;
+    VkDeviceSize stagingHead = 0;
+    VkDeviceSize stagingTail = 0;
+    VkDeviceSize stagingUsed = 0;
+
+    bool hasOpenBatch = false;
+    Batch current;
+    // Staging reservado antes de o lote abrir; passa para o lote no flush
+    VkDeviceSize openStagingConsumed = 0;
+    std::vector<std::pair<VkBuffer, GpuAllocation>> openOversize;
+    std::deque<Batch> inFlight;
+    std::vector<Batch> freeBatches; // command buffers, fence e semáforo reaproveitados
+
+    UploadTicket nextTicket = 1;
+    UploadTicket completedTicket = 0;
+};
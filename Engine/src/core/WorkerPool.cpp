@@ -0,0 +1,74 @@
+#include "WorkerPool.h"
+#include "CpuProfiler.h"
+
+WorkerPool::WorkerPool(const std::string &name, uint32_t threadCount) : name(name)
+{
+    if (threadCount == 0)
+    {
+        // hardware_concurrency pode devolver 0 quando não sabe
+        unsigned hw = std::thread::hardware_concurrency();
+        threadCount = hw > 1 ? hw - 1 : 1;
+    }
+
+    threads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++)
+        threads.emplace_back(&WorkerPool::run, this, i);
+}
+
+WorkerPool::~WorkerPool()
+{
+    // Tarefas ainda na fila são descartadas; as que estão rodando terminam
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    jobAvailable.notify_all();
+
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+void WorkerPool::submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    jobAvailable.notify_one();
+}
+
+void WorkerPool::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return jobs.empty() && running == 0; });
+}
+
+void WorkerPool::run(uint32_t index)
+{
+    PROFILE_THREAD_NAME(name + " " + std::to_string(index));
+
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping)
+                return;
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            running++;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running--;
+            if (jobs.empty() && running == 0)
+                idle.notify_all();
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Threads de trabalho para tarefas de CPU fora da thread principal (decodificação de texturas).
+// As tarefas não tocam em objetos Vulkan: devolvem dados que a thread principal consome.
+class WorkerPool
+{
+public:
+    // 0 = núcleos - 1 (ao menos um)
+    explicit WorkerPool(const std::string &name, uint32_t threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    void submit(std::function<void()> job);
+    // Bloqueia até a fila esvaziar e nenhuma tarefa estar rodando
+    void waitIdle();
+
+    uint32_t getThreadCount() const { return static_cast<uint32_t>(threads.size()); }
+
+private:
+    void run(uint32_t index);
+
+    std::string name;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable idle;
+    std::deque<std::function<void()>> jobs;
+    uint32_t running = 0;
+    bool stopping = false;
+};
@@ -4,70 +4,130 @@
 #include "../VulkanRenderer.h"
 #include "../core/VulkanCore.h"
 #include "../core/VulkanDescriptor.h"
+#include "../core/VulkanOcclusion.h"
+#include "../core/VulkanBindless.h"
+#include "../core/VulkanProfiler.h"
+#include "../core/VulkanMeshPool.h"
+#include "../core/VulkanResidency.h"
+#include "../rendering/TextureManager.h"
+#include "../core/CpuProfiler.h"
+#include "../core/RenderCounters.h"
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
 #include <glm/gtx/string_cast.hpp>
 
-void RenderSystem::render(Registry& registry, VkCommandBuffer commandBuffer)
+void RenderSystem::setViewportAndScissor(VkCommandBuffer commandBuffer)
 {
     VulkanRenderer &vulkanRender = VulkanRenderer::getInstance();
 
     VkViewport viewport{};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
-    viewport.width = (float)vulkanRender.getCore()->getSwapChain()->getExtent().width;
-    viewport.height = (float)vulkanRender.getCore()->getSwapChain()->getExtent().height;
+    viewport.width = (float)vulkanRender.getCore()->getSceneExtent().width;
+    viewport.height = (float)vulkanRender.getCore()->getSceneExtent().height;
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
 
     VkRect2D scissor{};
     scissor.offset = {0, 0};
-    scissor.extent = vulkanRender.getCore()->getSwapChain()->getExtent();
+    scissor.extent = vulkanRender.getCore()->getSceneExtent();
 
-    // Set viewport and scissor once for all entities
     vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+void RenderSystem::prepareFrame(Registry& registry)
+{
+    VulkanRenderer &vulkanRender = VulkanRenderer::getInstance();
+    VulkanOcclusion *occlusion = vulkanRender.getCore()->getOcclusion();
+    VulkanBindless *bindless = vulkanRender.getCore()->getBindless();
+    VulkanMeshPool *meshPool = vulkanRender.getCore()->getMeshPool();
+    VulkanResidency *residency = vulkanRender.getCore()->getResidency();
+    TextureManager *textures = vulkanRender.getTextureManager();
+    const bool bindlessEnabled = bindless && bindless->isEnabled();
 
-    // Recursive function to render an entity and all its children
-    std::function<void(std::shared_ptr<Entity>)> renderEntityHierarchy = 
+    // Câmera e luzes mudam uma vez por frame, não por draw
+    UBO ubo = prepareUBO(vulkanRender);
+    vulkanRender.getCore()->getDescriptor()->updateFrameData(ubo, prepareLightUBO(vulkanRender));
+    viewProjection = ubo.proj * ubo.view;
+
+    drawList.clear();
+    trianglesSubmitted = 0;
+
+    const auto &camera = vulkanRender.getCore()->getScene()->cameraEntity->getComponent<CameraComponent>();
+    float viewportHeight = static_cast<float>(vulkanRender.getCore()->getSceneExtent().height);
+
+    // Recursive function to collect an entity and all its children
+    std::function<void(std::shared_ptr<Entity>)> collectEntityHierarchy = 
         [&](std::shared_ptr<Entity> entity) {
-            // Render the entity if it has the required components
             if (entity->hasComponent<MeshComponent>() && 
                 entity->hasComponent<MaterialComponent>() && 
                 entity->hasComponent<TransformComponent>()) {
                 
-                const auto& mesh = entity->getComponent<MeshComponent>();
+                auto& mesh = entity->getComponent<MeshComponent>();
                 const auto& material = entity->getComponent<MaterialComponent>();
                 const auto& transform = entity->getComponent<TransformComponent>();
                 
-                if (!mesh.vertexBuffer || !mesh.indexBuffer || mesh.indexCount == 0 ||
-                    !material.descriptorSet || !material.uniformBuffer || !material.pipeline || !material.pipelineLayout) {
+                // No modo bindless o material não tem pipeline/set próprios, só as texturas registradas
+                bool materialReady = bindlessEnabled
+                    ? material.albedoMap != nullptr
+                    : (material.descriptorSet && material.pipeline && material.pipelineLayout);
+
+                if ((!mesh.hasGeometry() && !mesh.evicted) || mesh.indexCount == 0 || !materialReady) {
                     // Skip entities with invalid components
                 }
                 else {
-                    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, material.pipeline);
+                    glm::mat4 model = transform.getWorldMatrix();
 
-                    // Prepare UBO
-                    UBO ubo = prepareUBO(transform, vulkanRender);
+                    // Testa contra a pirâmide Hi-Z do frame anterior
+                    bool visible = !occlusion || !occlusion->isOccluded(mesh.boundsMin, mesh.boundsMax, model);
 
-                    // Update Uniform Buffer
-                    vulkanRender.getCore()->getDescriptor()->updateUniformBuffer(material.uniformBufferMemory, ubo);
+                    // Visível conta como uso para o orçamento; despejado volta no próximo frame, até lá não desenha
+                    if (visible && residency) {
+                        residency->markUsed(mesh);
+                        residency->markUsed(material);
+                    }
 
-                    LightUBO lightUBO = prepareLightUBO(vulkanRender);
-                    vulkanRender.getCore()->getDescriptor()->updateUniformBuffer(material.lightBufferMemory, lightUBO);
+                    // Mip que a tela pede: UV coberto por um pixel no ponto mais próximo do mesh
+                    if (visible && textures) {
+                        float scale = 1.0f;
+                        float pixels = pixelsPerUnit(mesh, model, camera, viewportHeight, scale);
+                        textures->requestMips(material, mesh.uvDensity > 0.0f ? mesh.uvDensity / (scale * pixels) : 0.0f);
+                    }
 
-                    VkDeviceSize offsets[] = {0};
-                    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &mesh.vertexBuffer, offsets);
-                    vkCmdBindIndexBuffer(commandBuffer, mesh.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-                    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, material.pipelineLayout, 0, 1, &material.descriptorSet, 0, nullptr);
-                    vkCmdDrawIndexed(commandBuffer, mesh.indexCount, 1, 0, 0, 0);
+                    if (visible && !mesh.evicted) {
+                        // Prepass e pass de cor usam o mesmo nível: o depth precisa bater
+                        uint32_t firstIndex = 0;
+                        uint32_t indexCount = mesh.indexCount;
+                        if (!mesh.lods.empty()) {
+                            const MeshLod& lod = mesh.lods[selectLod(mesh, model, camera, viewportHeight)];
+                            firstIndex = lod.firstIndex;
+                            indexCount = lod.indexCount;
+                        }
+
+                        DrawItem item{&mesh, &material, model, mesh.vertexBuffer, mesh.positionBuffer, mesh.indexBuffer,
+                                      0, firstIndex, indexCount};
+                        if (mesh.geometry != INVALID_MESH_HANDLE) {
+                            const MeshRange& range = meshPool->getRange(mesh.geometry);
+                            item.vertexBuffer = meshPool->getVertexBuffer(range.page);
+                            item.positionBuffer = meshPool->getPositionBuffer(range.page);
+                            item.indexBuffer = meshPool->getIndexBuffer(range.page);
+                            item.vertexOffset = range.vertexOffset;
+                            item.firstIndex += range.firstIndex;
+                        }
+
+                        drawList.push_back(item);
+                        trianglesSubmitted += indexCount / 3;
+                    }
                 }
             }
             
-            // Recursively render all children
+            // Recursively collect all children
             for (const auto& child : entity->getChildren()) {
                 auto childEntity = std::dynamic_pointer_cast<Entity>(child);
                 if (childEntity) {
-                    renderEntityHierarchy(childEntity);
+                    collectEntityHierarchy(childEntity);
                 }
             }
         };
@@ -75,25 +135,187 @@ void RenderSystem::render(Registry& registry, VkCommandBuffer commandBuffer)
     // Get all entities from the registry
     auto entities = registry.getEntities();
     
-    // Render only root entities (those without parents)
+    // Collect only root entities (those without parents)
     for (auto& entity : entities) {
-        // Check if this is a root entity (no parent)
         if (!entity->getParent()) {
-            renderEntityHierarchy(entity);
+            collectEntityHierarchy(entity);
+        }
+    }
+}
+
+float RenderSystem::pixelsPerUnit(const MeshComponent& mesh, const glm::mat4& model, const CameraComponent& camera,
+                                  float viewportHeight, float& scale) const
+{
+    // Esfera envolvente em espaço de mundo
+    glm::vec3 center = glm::vec3(model * glm::vec4((mesh.boundsMin + mesh.boundsMax) * 0.5f, 1.0f));
+    scale = std::max({glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))});
+    float radius = glm::length(mesh.boundsMax - mesh.boundsMin) * 0.5f * scale;
+
+    // Ponto mais próximo da esfera; dentro dela a projeção é feita no near plane
+    float distance = std::max(glm::length(center - camera.position) - radius, camera.near);
+    return viewportHeight / (2.0f * std::tan(glm::radians(camera.fov) * 0.5f) * distance);
+}
+
+uint32_t RenderSystem::selectLod(MeshComponent& mesh, const glm::mat4& model, const CameraComponent& camera, float viewportHeight)
+{
+    const uint32_t lastLod = static_cast<uint32_t>(mesh.lods.size()) - 1;
+
+    if (!lodSettings.enabled) {
+        mesh.currentLod = 0;
+        return mesh.currentLod;
+    }
+
+    if (lodSettings.forcedLod >= 0) {
+        mesh.currentLod = std::min(static_cast<uint32_t>(lodSettings.forcedLod), lastLod);
+        return mesh.currentLod;
+    }
+
+    float scale = 1.0f;
+    float pixels = pixelsPerUnit(mesh, model, camera, viewportHeight, scale);
+
+    auto pixelError = [&](uint32_t level) {
+        return mesh.lods[level].error * scale * pixels;
+    };
+
+    // Nível mais grosso cujo erro projetado fica abaixo do limite
+    uint32_t desired = 0;
+    for (uint32_t level = lastLod; level > 0; level--) {
+        if (pixelError(level) <= lodSettings.pixelErrorThreshold) {
+            desired = level;
+            break;
         }
     }
+
+    uint32_t current = std::min(mesh.currentLod, lastLod);
+
+    // Histerese: só engrossa com folga abaixo do limite e só refina quando o atual passou do limite com folga
+    if (desired > current) {
+        if (pixelError(desired) <= lodSettings.pixelErrorThreshold * (1.0f - lodSettings.hysteresis)) {
+            current = desired;
+        }
+    }
+    else if (desired < current) {
+        if (pixelError(current) > lodSettings.pixelErrorThreshold * (1.0f + lodSettings.hysteresis)) {
+            current = desired;
+        }
+    }
+
+    mesh.currentLod = current;
+    return current;
 }
 
-UBO RenderSystem::prepareUBO(const TransformComponent &transform, VulkanRenderer &vulkanRender)
+void RenderSystem::renderDepthPrepass(VkCommandBuffer commandBuffer)
 {
+    VulkanOcclusion *occlusion = VulkanRenderer::getInstance().getCore()->getOcclusion();
+    VkPipelineLayout layout = occlusion->getPrepassPipelineLayout();
+
+    setViewportAndScissor(commandBuffer);
+
+    // Meshes do pool dividem os buffers: só rebinda quando a página muda
+    VkBuffer boundVertexBuffer = VK_NULL_HANDLE;
+    VkBuffer boundIndexBuffer = VK_NULL_HANDLE;
+
+    for (const auto& item : drawList) {
+        if (!item.positionBuffer) {
+            continue;
+        }
+
+        PushConstants pushConstants{};
+        pushConstants.model = item.model;
+        pushConstants.materialIndex = item.material->materialIndex;
+        vkCmdPushConstants(commandBuffer, layout, PushConstants::stages, 0, sizeof(PushConstants), &pushConstants);
+
+        if (item.positionBuffer != boundVertexBuffer) {
+            VkDeviceSize offsets[] = {0};
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &item.positionBuffer, offsets);
+            boundVertexBuffer = item.positionBuffer;
+        }
+        if (item.indexBuffer != boundIndexBuffer) {
+            vkCmdBindIndexBuffer(commandBuffer, item.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+            boundIndexBuffer = item.indexBuffer;
+        }
+        vkCmdDrawIndexed(commandBuffer, item.indexCount, 1, item.firstIndex, item.vertexOffset, 0);
+        RenderCounters::countDraw(item.indexCount);
+
+        occlusion->getStats().prepassDraws++;
+    }
+}
+
+void RenderSystem::render(VkCommandBuffer commandBuffer)
+{
+    PROFILE_ZONE("RenderSystem::render");
+
+    VulkanOcclusion *occlusion = VulkanRenderer::getInstance().getCore()->getOcclusion();
+    VulkanBindless *bindless = VulkanRenderer::getInstance().getCore()->getBindless();
+    VulkanProfiler *profiler = VulkanRenderer::getInstance().getCore()->getProfiler();
+    const bool bindlessEnabled = bindless && bindless->isEnabled();
+
+    // Set viewport and scissor once for all entities
+    setViewportAndScissor(commandBuffer);
+
+    VkPipeline boundPipeline = VK_NULL_HANDLE;
+    VkDescriptorSet boundDescriptorSet = VK_NULL_HANDLE;
+    VkBuffer boundVertexBuffer = VK_NULL_HANDLE;
+    VkBuffer boundIndexBuffer = VK_NULL_HANDLE;
+
+    // Só os draws, sem o clear/load do render pass
+    GpuProfileScope profileScope(profiler, commandBuffer, "Draws");
+
+    // Bindless: pipeline e set uma vez por frame; por draw só as push constants
+    if (bindlessEnabled) {
+        bindless->bind(commandBuffer);
+    }
+
+    for (const auto& item : drawList) {
+        const auto& material = *item.material;
+
+        if (!bindlessEnabled) {
+            if (material.pipeline != boundPipeline) {
+                RenderCounters::add(RenderCounter::PipelineBinds);
+                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, material.pipeline);
+                boundPipeline = material.pipeline;
+            }
+
+            if (material.descriptorSet != boundDescriptorSet) {
+                RenderCounters::add(RenderCounter::DescriptorBinds);
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, material.pipelineLayout, 0, 1, &material.descriptorSet, 0, nullptr);
+                boundDescriptorSet = material.descriptorSet;
+            }
+        }
+
+        // Dados por draw via push constants
+        PushConstants pushConstants{};
+        pushConstants.model = item.model;
+        pushConstants.materialIndex = material.materialIndex;
+        VkPipelineLayout layout = bindlessEnabled ? bindless->getPipelineLayout() : material.pipelineLayout;
+        vkCmdPushConstants(commandBuffer, layout, PushConstants::stages, 0, sizeof(PushConstants), &pushConstants);
+
+        if (item.vertexBuffer != boundVertexBuffer) {
+            VkDeviceSize offsets[] = {0};
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &item.vertexBuffer, offsets);
+            boundVertexBuffer = item.vertexBuffer;
+        }
+        if (item.indexBuffer != boundIndexBuffer) {
+            vkCmdBindIndexBuffer(commandBuffer, item.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+            boundIndexBuffer = item.indexBuffer;
+        }
+        vkCmdDrawIndexed(commandBuffer, item.indexCount, 1, item.firstIndex, item.vertexOffset, 0);
+        RenderCounters::countDraw(item.indexCount);
+
+        if (occlusion) {
+            occlusion->getStats().colorDraws++;
+        }
+    }
+}
+
+UBO RenderSystem::prepareUBO(VulkanRenderer &vulkanRender)
+{
+    const auto &camera = vulkanRender.getCore()->getScene()->cameraEntity->getComponent<CameraComponent>();
+
     UBO ubo{};
-    ubo.model = transform.getWorldMatrix();
-    ubo.view = vulkanRender.getCore()->getScene()->cameraEntity->getComponent<CameraComponent>().getViewMatrix();
-    ubo.proj = vulkanRender.getCore()->getScene()->cameraEntity->getComponent<CameraComponent>().getViewProjection();
-    ubo.material.color = glm::vec4(1.0f); // Exemplos de valores
-    ubo.material.metallic = 0.5f;
-    ubo.material.roughness = 0.8f;
-    ubo.material.ambientOcclusion = 1.0f;
+    ubo.view = camera.getViewMatrix();
+    ubo.proj = camera.getProjectionMatrix();
+    ubo.cameraPos = glm::vec4(camera.position, 1.0f);
 
     return ubo;
 }
@@ -2,20 +2,66 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include <vector>
+#include <glm/glm.hpp>
 #include "../ecs/Registry.h"
 #include "../ecs/Entity.h"
 
 struct UBO;
 struct LightUBO;
 struct TransformComponent;
+struct MeshComponent;
+struct MaterialComponent;
+struct CameraComponent;
 class VulkanRenderer;
 
 class RenderSystem {
 public:
     RenderSystem() = default;
     ~RenderSystem() = default;
-    
-    void render(Registry& registry, VkCommandBuffer commandBuffer);
-    UBO prepareUBO(const TransformComponent &transform, VulkanRenderer &vulkanRender);
+
+    // Um draw visível do frame atual (já passou pelo teste de oclusão)
+    struct DrawItem {
+        const MeshComponent* mesh;
+        const MaterialComponent* material;
+        glm::mat4 model;
+        // Buffers da página do VulkanMeshPool (ou os do próprio mesh); firstIndex já inclui o início da faixa
+        VkBuffer vertexBuffer;
+        VkBuffer positionBuffer;
+        VkBuffer indexBuffer;
+        int32_t vertexOffset;
+        uint32_t firstIndex;
+        uint32_t indexCount;
+    };
+
+    // Seleção de LOD pelo erro geométrico projetado na tela
+    struct LodSettings {
+        bool enabled = true;
+        float pixelErrorThreshold = 1.0f; // erro máximo aceito, em pixels
+        float hysteresis = 0.25f;         // margem relativa para trocar de nível (evita popping)
+        int forcedLod = -1;               // >= 0 força um nível (debug)
+    };
+
+    // Chamado fora de render pass: atualiza os buffers do frame e monta a lista de draws
+    void prepareFrame(Registry& registry);
+    void renderDepthPrepass(VkCommandBuffer commandBuffer);
+    void render(VkCommandBuffer commandBuffer);
+
+    const glm::mat4& getViewProjection() const { return viewProjection; }
+    LodSettings& getLodSettings() { return lodSettings; }
+    uint32_t getTrianglesSubmitted() const { return trianglesSubmitted; }
+    UBO prepareUBO(VulkanRenderer &vulkanRender);
     LightUBO prepareLightUBO(VulkanRenderer &vulkanRender);
+
+private:
+    void setViewportAndScissor(VkCommandBuffer commandBuffer);
+    // Pixels por unidade de mundo no ponto da esfera envolvente mais próximo da câmera; scale = maior escala do model
+    float pixelsPerUnit(const MeshComponent& mesh, const glm::mat4& model, const CameraComponent& camera,
+                        float viewportHeight, float& scale) const;
+    uint32_t selectLod(MeshComponent& mesh, const glm::mat4& model, const CameraComponent& camera, float viewportHeight);
+
+    std::vector<DrawItem> drawList;
+    glm::mat4 viewProjection{1.0f};
+    LodSettings lodSettings;
+    uint32_t trianglesSubmitted = 0;
 };
\ No newline at end of file
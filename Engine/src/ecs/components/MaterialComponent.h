@@ -1,6 +1,7 @@
 #pragma once
 #include "../Component.h"
 #include "../../rendering/Texture.h"
+#include "../../core/VulkanTypes.h"
 #include <vulkan/vulkan.h>
 #include <memory>
 #include <glm/glm.hpp>
@@ -10,49 +11,12 @@ struct MaterialComponent : public Component
     MaterialComponent(std::shared_ptr<Entity> owner)
         : Component(owner) {}
 
+    // Layouts e pipeline pertencem ao VulkanPipelineCache; aqui só soltamos os handles
     void cleanup(VkDevice device)
     {
-        if (pipelineLayout != VK_NULL_HANDLE)
-        {
-            vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
-            pipelineLayout = VK_NULL_HANDLE;
-        }
-        
-        if (pipeline != VK_NULL_HANDLE)
-        {
-            vkDestroyPipeline(device, pipeline, nullptr);
-            pipeline = VK_NULL_HANDLE;
-        }
-        
-        if (descriptorSetLayout != VK_NULL_HANDLE)
-        {
-            vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
-            descriptorSetLayout = VK_NULL_HANDLE;
-        }
-        
-        if (uniformBuffer != VK_NULL_HANDLE)
-        {
-            vkDestroyBuffer(device, uniformBuffer, nullptr);
-            uniformBuffer = VK_NULL_HANDLE;
-        }
-        
-        if (uniformBufferMemory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(device, uniformBufferMemory, nullptr);
-            uniformBufferMemory = VK_NULL_HANDLE;
-        }
-        
-        if (lightBuffer != VK_NULL_HANDLE)
-        {
-            vkDestroyBuffer(device, lightBuffer, nullptr);
-            lightBuffer = VK_NULL_HANDLE;
-        }
-        
-        if (lightBufferMemory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(device, lightBufferMemory, nullptr);
-            lightBufferMemory = VK_NULL_HANDLE;
-        }
+        pipelineLayout = VK_NULL_HANDLE;
+        pipeline = VK_NULL_HANDLE;
+        descriptorSetLayout = VK_NULL_HANDLE;
     }
 
     std::shared_ptr<Texture> albedoMap;
@@ -67,16 +31,23 @@ struct MaterialComponent : public Component
     VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
     VkPipeline pipeline = VK_NULL_HANDLE;
 
-    // Mesh Buffer
-    VkBuffer uniformBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory uniformBufferMemory = VK_NULL_HANDLE;
-
-    // Light Buffer
-    VkBuffer lightBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory lightBufferMemory = VK_NULL_HANDLE;
+    // Índice enviado por push constant junto com a matriz do modelo
+    uint32_t materialIndex = 0;
 
+    // Multiplicam as texturas; sem mapa, a textura é a branca compartilhada e o fator é o valor final
     glm::vec4 baseColorFactor = glm::vec4(1.0f);
     float metallicFactor = 1.0f;
     float roughnessFactor = 1.0f;
     glm::vec3 emissiveFactor = glm::vec3(0.0f);
+
+    // Só os fatores; os índices de textura ficam com o VulkanBindless
+    GPUMaterial getGpuParameters() const
+    {
+        GPUMaterial gpuMaterial{};
+        gpuMaterial.baseColorFactor = baseColorFactor;
+        gpuMaterial.emissiveFactor = glm::vec4(emissiveFactor, 0.0f);
+        gpuMaterial.metallicFactor = metallicFactor;
+        gpuMaterial.roughnessFactor = roughnessFactor;
+        return gpuMaterial;
+    }
 };
\ No newline at end of file
@@ -1,27 +1,100 @@
 #pragma once
 
 #include "../Component.h"
+#include "../../core/RenderCounters.h"
+#include "../../core/VulkanAllocator.h"
+#include "../../core/VulkanMeshPool.h"
 #include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Um nível de detalhe: faixa do index buffer compartilhado
+struct MeshLod
+{
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    float error = 0.0f; // desvio geométrico aproximado em espaço local
+};
+
+// Como a geometria é atualizada depois de criada; decide onde os buffers ficam
+enum class MeshUsage : uint32_t
+{
+    Static,  // escrita uma vez: DEVICE_LOCAL, enviada por staging
+    Dynamic, // reescrita de vez em quando pela CPU: host-visible, mapeada
+    Stream   // reescrita todo frame: host-visible, mapeada
+};
 
 struct MeshComponent : public Component
 {
     MeshComponent(std::shared_ptr<Entity> owner)
         : Component(owner) {}
 
-    void Destroy(VkDevice device)
+    void Destroy(VkDevice device, VulkanAllocator &allocator, VulkanMeshPool &meshPool)
     {
-        vkDestroyBuffer(device, vertexBuffer, nullptr);
-        vkFreeMemory(device, vertexBufferMemory, nullptr);
-        
-        vkDestroyBuffer(device, indexBuffer, nullptr);
-        vkFreeMemory(device, indexBufferMemory, nullptr);
+        meshPool.free(geometry);
+        geometry = INVALID_MESH_HANDLE;
+        cpuVertices.clear();
+        cpuIndices.clear();
+        evicted = false;
+        restoreRequested = false;
+
+        for (VkBuffer buffer : {vertexBuffer, indexBuffer, positionBuffer})
+        {
+            if (buffer != VK_NULL_HANDLE)
+            {
+                RenderCounters::add(RenderCounter::BuffersDestroyed);
+                vkDestroyBuffer(device, buffer, nullptr);
+            }
+        }
+
+        allocator.free(vertexBufferMemory);
+        allocator.free(indexBufferMemory);
+        allocator.free(positionBufferMemory);
+
+        vertexBuffer = VK_NULL_HANDLE;
+        indexBuffer = VK_NULL_HANDLE;
+        positionBuffer = VK_NULL_HANDLE;
         
         indexCount = 0;
+        lods.clear();
+        currentLod = 0;
     }
 
-    VkBuffer vertexBuffer;
-    VkBuffer indexBuffer;
-    VkDeviceMemory vertexBufferMemory;
-    VkDeviceMemory indexBufferMemory;
-    uint32_t indexCount;
-};
\ No newline at end of file
+    MeshUsage usage = MeshUsage::Static;
+
+    // Só Dynamic/Stream têm mapped nas alocações
+    bool isHostVisible() const { return usage != MeshUsage::Static; }
+    bool hasGeometry() const { return geometry != INVALID_MESH_HANDLE || (vertexBuffer && indexBuffer); }
+    bool canEvict() const { return geometry != INVALID_MESH_HANDLE && !cpuVertices.empty(); }
+
+    // Static: faixa nos buffers compartilhados do VulkanMeshPool (sem buffers próprios)
+    MeshHandle geometry = INVALID_MESH_HANDLE;
+
+    // Cópia na CPU da geometria Static: o VulkanResidency despeja a faixa do pool e a recria daqui
+    std::vector<Vertex> cpuVertices;
+    std::vector<uint32_t> cpuIndices;
+    bool evicted = false;
+    bool restoreRequested = false;
+    uint64_t lastUsedFrame = 0;
+
+    // Dynamic/Stream: buffers próprios, host-visible
+    VkBuffer vertexBuffer = VK_NULL_HANDLE;
+    VkBuffer indexBuffer = VK_NULL_HANDLE;
+    GpuAllocation vertexBufferMemory;
+    GpuAllocation indexBufferMemory;
+    uint32_t indexCount = 0;
+
+    // Só posições (vec3), usado pelo depth prepass
+    VkBuffer positionBuffer = VK_NULL_HANDLE;
+    GpuAllocation positionBufferMemory;
+
+    // Caixa em espaço local, usada no teste de oclusão
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    // Unidades de UV por unidade local (média do mesh); 0 = desconhecida. Estima o mip que a tela pede
+    float uvDensity = 0.0f;
+
+    // lods[0] é o mesh original; os demais vêm em sequência no mesmo index buffer
+    std::vector<MeshLod> lods;
+    uint32_t currentLod = 0;
+};
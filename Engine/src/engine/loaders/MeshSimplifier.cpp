@@ -0,0 +1,337 @@
+#include "MeshSimplifier.h"
+#include <array>
+#include <map>
+#include <queue>
+#include <tuple>
+#include <cmath>
+#include <algorithm>
+#include <unordered_set>
+#include <limits>
+
+namespace
+{
+    // Peso dos planos de restrição nas bordas abertas: evita que o contorno do mesh encolha
+    constexpr double BOUNDARY_WEIGHT = 10.0;
+
+    // Matriz 4x4 simétrica guardada como 10 coeficientes
+    struct Quadric
+    {
+        double a2 = 0, ab = 0, ac = 0, ad = 0;
+        double b2 = 0, bc = 0, bd = 0;
+        double c2 = 0, cd = 0;
+        double d2 = 0;
+
+        static Quadric fromPlane(double a, double b, double c, double d, double weight)
+        {
+            Quadric q;
+            q.a2 = a * a * weight; q.ab = a * b * weight; q.ac = a * c * weight; q.ad = a * d * weight;
+            q.b2 = b * b * weight; q.bc = b * c * weight; q.bd = b * d * weight;
+            q.c2 = c * c * weight; q.cd = c * d * weight;
+            q.d2 = d * d * weight;
+            return q;
+        }
+
+        Quadric &operator+=(const Quadric &o)
+        {
+            a2 += o.a2; ab += o.ab; ac += o.ac; ad += o.ad;
+            b2 += o.b2; bc += o.bc; bd += o.bd;
+            c2 += o.c2; cd += o.cd;
+            d2 += o.d2;
+            return *this;
+        }
+
+        // v^T Q v com v = (x, y, z, 1): soma das distâncias ao quadrado aos planos acumulados
+        double evaluate(const glm::vec3 &p) const
+        {
+            double x = p.x, y = p.y, z = p.z;
+            return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x +
+                   b2 * y * y + 2 * bc * y * z + 2 * bd * y +
+                   c2 * z * z + 2 * cd * z +
+                   d2;
+        }
+    };
+
+    struct Collapse
+    {
+        double cost;
+        uint32_t from;
+        uint32_t to;
+        uint32_t fromVersion;
+        uint32_t toVersion;
+
+        bool operator>(const Collapse &o) const { return cost > o.cost; }
+    };
+}
+
+std::vector<uint32_t> MeshSimplifier::Simplify(const std::vector<Vertex> &vertices,
+                                               const std::vector<uint32_t> &indices,
+                                               size_t targetIndexCount,
+                                               float &outError)
+{
+    outError = 0.0f;
+
+    if (indices.size() % 3 != 0 || indices.size() <= targetIndexCount)
+        return indices;
+
+    // Vértices com a mesma posição (costuras de UV/normal) colapsam juntos para não abrir buracos
+    std::map<std::tuple<float, float, float>, uint32_t> positionLookup;
+    std::vector<uint32_t> positionOf(vertices.size());
+    std::vector<glm::vec3> positions;
+    std::vector<std::vector<uint32_t>> verticesAt;
+
+    for (uint32_t i = 0; i < vertices.size(); i++)
+    {
+        const glm::vec3 &p = vertices[i].position;
+        auto key = std::make_tuple(p.x, p.y, p.z);
+        auto it = positionLookup.find(key);
+        if (it == positionLookup.end())
+        {
+            it = positionLookup.emplace(key, static_cast<uint32_t>(positions.size())).first;
+            positions.push_back(p);
+            verticesAt.emplace_back();
+        }
+        positionOf[i] = it->second;
+        verticesAt[it->second].push_back(i);
+    }
+
+    const size_t positionCount = positions.size();
+    const size_t triangleCount = indices.size() / 3;
+
+    std::vector<std::array<uint32_t, 3>> triangles(triangleCount);
+    std::vector<bool> triangleAlive(triangleCount, true);
+    std::vector<std::vector<uint32_t>> trianglesAt(positionCount);
+    std::vector<Quadric> quadrics(positionCount);
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> edgeUse;
+
+    size_t liveIndexCount = 0;
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        triangles[t] = {indices[t * 3 + 0], indices[t * 3 + 1], indices[t * 3 + 2]};
+
+        uint32_t p0 = positionOf[triangles[t][0]];
+        uint32_t p1 = positionOf[triangles[t][1]];
+        uint32_t p2 = positionOf[triangles[t][2]];
+
+        // Triângulos já degenerados ficam de fora
+        if (p0 == p1 || p1 == p2 || p0 == p2)
+        {
+            triangleAlive[t] = false;
+            continue;
+        }
+
+        liveIndexCount += 3;
+
+        glm::dvec3 a(positions[p0]), b(positions[p1]), c(positions[p2]);
+        glm::dvec3 n = glm::cross(b - a, c - a);
+        double length = glm::length(n);
+        if (length > 0.0)
+        {
+            n /= length;
+            Quadric q = Quadric::fromPlane(n.x, n.y, n.z, -glm::dot(n, a), 1.0);
+            quadrics[p0] += q;
+            quadrics[p1] += q;
+            quadrics[p2] += q;
+        }
+
+        for (uint32_t k = 0; k < 3; k++)
+        {
+            uint32_t pa = positionOf[triangles[t][k]];
+            uint32_t pb = positionOf[triangles[t][(k + 1) % 3]];
+            trianglesAt[pa].push_back(static_cast<uint32_t>(t));
+            edgeUse[{std::min(pa, pb), std::max(pa, pb)}]++;
+        }
+    }
+
+    if (liveIndexCount <= targetIndexCount)
+        return indices;
+
+    // Bordas abertas: plano perpendicular ao triângulo passando pela aresta
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        if (!triangleAlive[t])
+            continue;
+
+        uint32_t p[3] = {positionOf[triangles[t][0]], positionOf[triangles[t][1]], positionOf[triangles[t][2]]};
+        glm::dvec3 faceNormal = glm::cross(glm::dvec3(positions[p[1]] - positions[p[0]]), glm::dvec3(positions[p[2]] - positions[p[0]]));
+
+        for (uint32_t k = 0; k < 3; k++)
+        {
+            uint32_t pa = p[k];
+            uint32_t pb = p[(k + 1) % 3];
+            if (edgeUse[{std::min(pa, pb), std::max(pa, pb)}] != 1)
+                continue;
+
+            glm::dvec3 edge = glm::dvec3(positions[pb]) - glm::dvec3(positions[pa]);
+            glm::dvec3 n = glm::cross(edge, faceNormal);
+            double length = glm::length(n);
+            if (length <= 0.0)
+                continue;
+
+            n /= length;
+            Quadric q = Quadric::fromPlane(n.x, n.y, n.z, -glm::dot(n, glm::dvec3(positions[pa])), BOUNDARY_WEIGHT);
+            quadrics[pa] += q;
+            quadrics[pb] += q;
+        }
+    }
+
+    std::vector<bool> positionAlive(positionCount, true);
+    std::vector<uint32_t> version(positionCount, 0);
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> heap;
+
+    auto pushEdge = [&](uint32_t pa, uint32_t pb) {
+        Quadric q = quadrics[pa];
+        q += quadrics[pb];
+
+        // Colapso para um dos extremos: os atributos do vértice que fica continuam válidos
+        double costToB = std::max(0.0, q.evaluate(positions[pb]));
+        double costToA = std::max(0.0, q.evaluate(positions[pa]));
+
+        if (costToB <= costToA)
+            heap.push({costToB, pa, pb, version[pa], version[pb]});
+        else
+            heap.push({costToA, pb, pa, version[pb], version[pa]});
+    };
+
+    for (const auto &[edge, count] : edgeUse)
+    {
+        pushEdge(edge.first, edge.second);
+    }
+
+    // Entre os vértices na posição de destino, o de atributos mais parecidos com o vértice removido
+    auto closestVertexAt = [&](uint32_t target, uint32_t original) {
+        const Vertex &v = vertices[original];
+        uint32_t best = verticesAt[target][0];
+        float bestDistance = std::numeric_limits<float>::max();
+        for (uint32_t candidate : verticesAt[target])
+        {
+            const Vertex &c = vertices[candidate];
+            float distance = glm::dot(c.texCoord - v.texCoord, c.texCoord - v.texCoord) +
+                             (1.0f - glm::dot(c.normal, v.normal));
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                best = candidate;
+            }
+        }
+        return best;
+    };
+
+    double maxCost = 0.0;
+
+    while (liveIndexCount > targetIndexCount && !heap.empty())
+    {
+        Collapse collapse = heap.top();
+        heap.pop();
+
+        uint32_t from = collapse.from;
+        uint32_t to = collapse.to;
+
+        if (!positionAlive[from] || !positionAlive[to] ||
+            version[from] != collapse.fromVersion || version[to] != collapse.toVersion)
+            continue;
+
+        // Rejeita colapsos que invertem algum triângulo restante
+        bool flips = false;
+        for (uint32_t t : trianglesAt[from])
+        {
+            if (!triangleAlive[t])
+                continue;
+
+            glm::vec3 before[3], after[3];
+            bool touchesTarget = false;
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                uint32_t p = positionOf[triangles[t][k]];
+                touchesTarget |= (p == to);
+                before[k] = positions[p];
+                after[k] = (p == from) ? positions[to] : positions[p];
+            }
+
+            if (touchesTarget)
+                continue;
+
+            glm::vec3 n0 = glm::cross(before[1] - before[0], before[2] - before[0]);
+            glm::vec3 n1 = glm::cross(after[1] - after[0], after[2] - after[0]);
+            if (glm::dot(n0, n1) <= 0.0f)
+            {
+                flips = true;
+                break;
+            }
+        }
+
+        if (flips)
+            continue;
+
+        for (uint32_t t : trianglesAt[from])
+        {
+            if (!triangleAlive[t])
+                continue;
+
+            bool touchesTarget = false;
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                touchesTarget |= (positionOf[triangles[t][k]] == to);
+            }
+
+            // Triângulos que contêm a aresta colapsada somem
+            if (touchesTarget)
+            {
+                triangleAlive[t] = false;
+                liveIndexCount -= 3;
+                continue;
+            }
+
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                if (positionOf[triangles[t][k]] == from)
+                {
+                    triangles[t][k] = closestVertexAt(to, triangles[t][k]);
+                }
+            }
+            trianglesAt[to].push_back(t);
+        }
+
+        positionAlive[from] = false;
+        trianglesAt[from].clear();
+        quadrics[to] += quadrics[from];
+        version[to]++;
+        maxCost = std::max(maxCost, collapse.cost);
+
+        // Remove referências mortas/duplicadas e recalcula o custo das arestas vizinhas
+        std::vector<uint32_t> &around = trianglesAt[to];
+        std::sort(around.begin(), around.end());
+        around.erase(std::unique(around.begin(), around.end()), around.end());
+        around.erase(std::remove_if(around.begin(), around.end(), [&](uint32_t t) { return !triangleAlive[t]; }), around.end());
+
+        std::unordered_set<uint32_t> neighbours;
+        for (uint32_t t : around)
+        {
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                uint32_t p = positionOf[triangles[t][k]];
+                if (p != to)
+                    neighbours.insert(p);
+            }
+        }
+
+        for (uint32_t n : neighbours)
+        {
+            pushEdge(to, n);
+        }
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(liveIndexCount);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        if (!triangleAlive[t])
+            continue;
+
+        result.push_back(triangles[t][0]);
+        result.push_back(triangles[t][1]);
+        result.push_back(triangles[t][2]);
+    }
+
+    outError = static_cast<float>(std::sqrt(maxCost));
+    return result;
+}
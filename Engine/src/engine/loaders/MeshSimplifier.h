@@ -0,0 +1,18 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "../../core/VulkanTypes.h"
+
+// Simplificação por colapso de arestas com métrica de erro quádrico (Garland & Heckbert).
+// Os vértices não são alterados: o resultado é um novo index buffer que referencia os mesmos vértices,
+// então todos os LODs podem compartilhar o vertex buffer do mesh.
+class MeshSimplifier
+{
+public:
+    // Reduz até targetIndexCount índices (ou até não haver colapso válido).
+    // outError recebe a maior distância aproximada (espaço local) introduzida pelos colapsos.
+    static std::vector<uint32_t> Simplify(const std::vector<Vertex> &vertices,
+                                          const std::vector<uint32_t> &indices,
+                                          size_t targetIndexCount,
+                                          float &outError);
+};
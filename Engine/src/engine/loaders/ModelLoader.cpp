@@ -1,8 +1,13 @@
 #include "ModelLoader.h"
+#include "MeshSimplifier.h"
 #include "../../VulkanRenderer.h"
+#include "../../core/CpuProfiler.h"
+#include "../../core/RenderCounters.h"
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <managers/FileManager.h>
+#include <cmath>
+#include <limits>
 
 
 
@@ -96,56 +101,131 @@ std::vector<uint32_t> EngineModelLoader::ExtractIndices(aiMesh *mesh)
     return indices;
 }
 
+void EngineModelLoader::CreateMeshBuffer(const void *data, VkDeviceSize size, VkBufferUsageFlags usage,
+                                         VkBuffer &buffer, GpuAllocation &memory)
+{
+    // Dynamic/Stream: a CPU reescreve direto na memória mapeada
+    VulkanCore *core = vulkanRenderer.getCore();
+    core->createBuffer(size, usage, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                       buffer, memory, GpuMemoryCategory::Mesh);
+    core->copyDataToBuffer(data, memory, size);
+}
+
 void EngineModelLoader::CreateVertexBuffer(MeshComponent &meshComponent, const std::vector<Vertex> &vertices)
 {
     VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
 
-    vulkanRenderer.getCore()->createBuffer(
-        bufferSize,
-        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        meshComponent.vertexBuffer,
-        meshComponent.vertexBufferMemory);
-
-    void *data;
-    vkMapMemory(vulkanRenderer.getCore()->getDevice(), meshComponent.vertexBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, vertices.data(), bufferSize);
-    vkUnmapMemory(vulkanRenderer.getCore()->getDevice(), meshComponent.vertexBufferMemory);
+    CreateMeshBuffer(vertices.data(), bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                     meshComponent.vertexBuffer, meshComponent.vertexBufferMemory);
 }
 
 void EngineModelLoader::CreateIndexBuffer(MeshComponent &meshComponent, const std::vector<uint32_t> &indices)
 {
     VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
 
-    vulkanRenderer.getCore()->createBuffer(
-        bufferSize,
-        VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        meshComponent.indexBuffer,
-        meshComponent.indexBufferMemory);
-
-    void *data;
-    vkMapMemory(vulkanRenderer.getCore()->getDevice(), meshComponent.indexBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, indices.data(), bufferSize);
-    vkUnmapMemory(vulkanRenderer.getCore()->getDevice(), meshComponent.indexBufferMemory);
+    CreateMeshBuffer(indices.data(), bufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                     meshComponent.indexBuffer, meshComponent.indexBufferMemory);
 
     meshComponent.indexCount = static_cast<uint32_t>(indices.size());
 }
 
+std::vector<glm::vec3> EngineModelLoader::ExtractPositions(MeshComponent &meshComponent, const std::vector<Vertex> &vertices)
+{
+    std::vector<glm::vec3> positions;
+    positions.reserve(vertices.size());
+
+    meshComponent.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+    meshComponent.boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+
+    for (const auto &vertex : vertices)
+    {
+        positions.push_back(vertex.position);
+        meshComponent.boundsMin = glm::min(meshComponent.boundsMin, vertex.position);
+        meshComponent.boundsMax = glm::max(meshComponent.boundsMax, vertex.position);
+    }
+
+    return positions;
+}
+
+void EngineModelLoader::CreatePositionBuffer(MeshComponent &meshComponent, const std::vector<glm::vec3> &positions)
+{
+    VkDeviceSize bufferSize = sizeof(positions[0]) * positions.size();
+
+    CreateMeshBuffer(positions.data(), bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                     meshComponent.positionBuffer, meshComponent.positionBufferMemory);
+}
+
+std::vector<uint32_t> EngineModelLoader::GenerateLods(MeshComponent &meshComponent, const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices)
+{
+    // Abaixo disso não compensa gerar níveis
+    constexpr size_t MIN_LOD_TRIANGLES = 64;
+
+    meshComponent.lods.clear();
+    meshComponent.lods.push_back({0, static_cast<uint32_t>(indices.size()), 0.0f});
+    meshComponent.currentLod = 0;
+
+    std::vector<uint32_t> allIndices = indices;
+    std::vector<uint32_t> previous = indices;
+
+    for (float target : lodTargets)
+    {
+        size_t targetIndexCount = static_cast<size_t>(indices.size() / 3 * target) * 3;
+        if (targetIndexCount / 3 < MIN_LOD_TRIANGLES)
+            break;
+
+        // Cada nível parte do anterior; o erro se acumula
+        float error = 0.0f;
+        auto lod = MeshSimplifier::Simplify(vertices, previous, targetIndexCount, error);
+
+        // Nível quase igual ao anterior (malha travada por bordas/flips): para a cadeia
+        if (lod.size() > previous.size() * 9 / 10)
+            break;
+
+        MeshLod level{};
+        level.firstIndex = static_cast<uint32_t>(allIndices.size());
+        level.indexCount = static_cast<uint32_t>(lod.size());
+        level.error = meshComponent.lods.back().error + error;
+        meshComponent.lods.push_back(level);
+
+        allIndices.insert(allIndices.end(), lod.begin(), lod.end());
+        previous = std::move(lod);
+    }
+
+    return allIndices;
+}
+
+void EngineModelLoader::ComputeUvDensity(MeshComponent &meshComponent, const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices)
+{
+    // Razão entre as áreas somadas em UV e em espaço local: raiz dá unidades de UV por unidade de comprimento
+    double uvArea = 0.0;
+    double localArea = 0.0;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const Vertex &a = vertices[indices[i]];
+        const Vertex &b = vertices[indices[i + 1]];
+        const Vertex &c = vertices[indices[i + 2]];
+
+        localArea += glm::length(glm::cross(b.position - a.position, c.position - a.position)) * 0.5;
+        glm::vec2 uvEdge1 = b.texCoord - a.texCoord;
+        glm::vec2 uvEdge2 = c.texCoord - a.texCoord;
+        uvArea += std::abs(uvEdge1.x * uvEdge2.y - uvEdge1.y * uvEdge2.x) * 0.5;
+    }
+
+    // Sem UV (ou mesh degenerado): 0 pede o nível mais detalhado
+    meshComponent.uvDensity = localArea > 0.0 && uvArea > 0.0 ? static_cast<float>(std::sqrt(uvArea / localArea)) : 0.0f;
+}
+
 void EngineModelLoader::ProcessMesh(aiMesh *mesh, const aiScene *scene, std::shared_ptr<Entity> entity)
 {
+    PROFILE_ZONE("EngineModelLoader::ProcessMesh");
+
     auto &meshComponent = entity->AddOrGetComponent<MeshComponent>();
     auto &materialComponent = entity->AddOrGetComponent<MaterialComponent>();
 
-    auto vertices = ExtractVertices(mesh);
-    auto indices = ExtractIndices(mesh);
-
-    CreateVertexBuffer(meshComponent, vertices);
-    CreateIndexBuffer(meshComponent, indices);
+    CreateGeometry(meshComponent, ExtractVertices(mesh), ExtractIndices(mesh));
 
     ProcessMaterial(mesh, scene, materialComponent);
-    CreateMaterialPipeline(materialComponent);
-    SetupDescriptors(materialComponent);
+    RegisterMaterial(materialComponent);
 
     // Set the entity name to the mesh name if it has one
     if (mesh->mName.length > 0) {
@@ -155,36 +235,109 @@ void EngineModelLoader::ProcessMesh(aiMesh *mesh, const aiScene *scene, std::sha
     }
 }
 
-void EngineModelLoader::CreateLightUniformBuffer(MaterialComponent &material)
+void EngineModelLoader::CreateGeometry(MeshComponent &meshComponent, std::vector<Vertex> vertices, const std::vector<uint32_t> &indices)
 {
-    VkDeviceSize bufferSize = sizeof(LightUBO);
-
-    // Cria o buffer para a luz
-    vulkanRenderer.getCore()->createBuffer(
-        bufferSize,
-        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        material.lightBuffer,  // Aqui seria o buffer da luz
-        material.lightBufferMemory);  // Aqui seria a memória do buffer da luz
+    meshComponent.usage = meshUsage;
+
+    // Todos os LODs vão para o mesmo index buffer; indexCount continua sendo o do LOD 0
+    auto lodIndices = GenerateLods(meshComponent, vertices, indices);
+
+    auto positions = ExtractPositions(meshComponent, vertices);
+    ComputeUvDensity(meshComponent, vertices, indices);
+
+    if (meshComponent.usage == MeshUsage::Static) {
+        // Faixa nos buffers compartilhados; as cópias vão no próximo lote de uploads
+        meshComponent.geometry = vulkanRenderer.getCore()->getMeshPool()->allocate(
+            vertices.data(), positions.data(), static_cast<uint32_t>(vertices.size()),
+            lodIndices.data(), static_cast<uint32_t>(lodIndices.size()));
+        // O VulkanResidency recria a faixa daqui depois de despejá-la
+        meshComponent.cpuVertices = std::move(vertices);
+        meshComponent.cpuIndices = std::move(lodIndices);
+    } else {
+        CreateVertexBuffer(meshComponent, vertices);
+        CreateIndexBuffer(meshComponent, lodIndices);
+        CreatePositionBuffer(meshComponent, positions);
+    }
+    meshComponent.indexCount = meshComponent.lods[0].indexCount;
+    if (VulkanResidency *residency = vulkanRenderer.getCore()->getResidency()) {
+        meshComponent.lastUsedFrame = residency->getFrame();
+    }
+}
+
+void EngineModelLoader::RegisterMaterial(MaterialComponent &material)
+{
+    // Bindless: o material é só uma entrada no buffer global; pipeline e set são compartilhados
+    VulkanBindless *bindless = vulkanRenderer.getCore()->getBindless();
+    if (bindless && bindless->isEnabled()) {
+        bindless->registerMaterial(material);
+    } else {
+        // Fatores no mesmo buffer de parâmetros, lidos pelo materialIndex da push constant
+        VulkanDescriptor *descriptor = vulkanRenderer.getCore()->getDescriptor();
+        material.materialIndex = descriptor->allocateMaterial();
+        descriptor->writeMaterial(material.materialIndex, material.getGpuParameters());
+
+        CreateMaterialPipeline(material);
+        SetupDescriptors(material);
+    }
 }
 
-void EngineModelLoader::CreateUniformBuffer(MaterialComponent &material)
+std::shared_ptr<Entity> EngineModelLoader::CreateTerrain(std::shared_ptr<Entity> entity, uint32_t resolution, float size,
+                                                         float uvTiling, std::shared_ptr<Texture> albedo)
 {
-    VkDeviceSize bufferSize = sizeof(UBO);
-    vulkanRenderer.getCore()->createBuffer(
-        bufferSize,
-        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        material.uniformBuffer,
-        material.uniformBufferMemory);
+    PROFILE_ZONE("EngineModelLoader::CreateTerrain");
+
+    // Grade plana em y = 0, centrada na origem; a textura repete uvTiling vezes em cada direção
+    std::vector<Vertex> vertices;
+    vertices.reserve(static_cast<size_t>(resolution + 1) * (resolution + 1));
+    for (uint32_t z = 0; z <= resolution; z++) {
+        for (uint32_t x = 0; x <= resolution; x++) {
+            float u = static_cast<float>(x) / resolution;
+            float v = static_cast<float>(z) / resolution;
+
+            Vertex vertex{};
+            vertex.position = {(u - 0.5f) * size, 0.0f, (v - 0.5f) * size};
+            vertex.normal = {0.0f, 1.0f, 0.0f};
+            vertex.texCoord = {u * uvTiling, v * uvTiling};
+            vertices.push_back(vertex);
+        }
+    }
+
+    std::vector<uint32_t> indices;
+    indices.reserve(static_cast<size_t>(resolution) * resolution * 6);
+    for (uint32_t z = 0; z < resolution; z++) {
+        for (uint32_t x = 0; x < resolution; x++) {
+            uint32_t i0 = z * (resolution + 1) + x;
+            uint32_t i1 = i0 + 1;
+            uint32_t i2 = i0 + resolution + 1;
+            uint32_t i3 = i2 + 1;
+            indices.insert(indices.end(), {i0, i2, i1, i1, i2, i3});
+        }
+    }
+
+    auto &meshComponent = entity->AddOrGetComponent<MeshComponent>();
+    auto &materialComponent = entity->AddOrGetComponent<MaterialComponent>();
+    entity->AddOrGetComponent<TransformComponent>();
+
+    CreateGeometry(meshComponent, std::move(vertices), indices);
+
+    CreateDefaultMaterial(materialComponent);
+    if (albedo) {
+        materialComponent.albedoMap = albedo;
+    }
+    RegisterMaterial(materialComponent);
+
+    entity->setName("Terrain");
+    return entity;
 }
 
 void EngineModelLoader::UpdateDescriptorSets(MaterialComponent &material, const std::array<VkDescriptorImageInfo, 5> &imageInfos)
 {
-    std::array<VkWriteDescriptorSet, 7> descriptorWrites{};  // Aumenta para 7, pois vamos adicionar o descriptor de luzes
+    std::array<VkWriteDescriptorSet, 8> descriptorWrites{};  // UBO, 5 texturas, luzes e materiais
+
+    auto descriptor = vulkanRenderer.getCore()->getDescriptor();
 
-    // Atualizar o descriptor para o uniforme do material
-    VkDescriptorBufferInfo bufferInfo{material.uniformBuffer, 0, sizeof(UBO)};
+    // UBO de câmera compartilhado por todos os materiais (atualizado uma vez por frame)
+    VkDescriptorBufferInfo bufferInfo{descriptor->uniformBuffer, 0, sizeof(UBO)};
     descriptorWrites[0] = {
         .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
         .dstSet = material.descriptorSet,
@@ -205,8 +358,8 @@ void EngineModelLoader::UpdateDescriptorSets(MaterialComponent &material, const
             .pImageInfo = &imageInfos[i]}; // Certifique-se de que imageInfos[i] contenha um VkDescriptorImageInfo válido
     }
 
-    // Atualizar o descriptor para o buffer de luzes
-    VkDescriptorBufferInfo lightBufferInfo{material.lightBuffer, 0, sizeof(LightUBO)};
+    // Atualizar o descriptor para o buffer de luzes (também compartilhado)
+    VkDescriptorBufferInfo lightBufferInfo{descriptor->lightBuffer, 0, sizeof(LightUBO)};
     descriptorWrites[6] = {
         .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
         .dstSet = material.descriptorSet,
@@ -216,6 +369,18 @@ void EngineModelLoader::UpdateDescriptorSets(MaterialComponent &material, const
         .pBufferInfo = &lightBufferInfo
     };
 
+    // Buffer de parâmetros dos materiais (compartilhado; o shader indexa por materialIndex)
+    VkDescriptorBufferInfo materialBufferInfo{descriptor->materialBuffer, 0,
+                                              sizeof(GPUMaterial) * VulkanDescriptor::MAX_MATERIALS};
+    descriptorWrites[7] = {
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = material.descriptorSet,
+        .dstBinding = 7,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .pBufferInfo = &materialBufferInfo
+    };
+
     // Garantir que o sampler seja válido antes de atualizar o descriptor set
     if (material.albedoMap && material.albedoMap->sampler != VK_NULL_HANDLE) {
         vkUpdateDescriptorSets(vulkanRenderer.getCore()->getDevice(),
@@ -227,80 +392,77 @@ void EngineModelLoader::UpdateDescriptorSets(MaterialComponent &material, const
 
 void EngineModelLoader::CreateDefaultMaterial(MaterialComponent &material)
 {
-    material.albedoMap = vulkanRenderer.getTextureManager()->createSolidColorTexture(glm::vec4(1.0f));
-    material.normalMap = vulkanRenderer.getTextureManager()->createDefaultNormalTexture();
-    material.metallicRoughnessMap = vulkanRenderer.getTextureManager()->createSolidColorTexture(glm::vec4(0.0f, 0.5f, 0.0f, 0.0f));
-    material.aoMap = vulkanRenderer.getTextureManager()->createSolidColorTexture(glm::vec4(1.0f));
-    material.emissiveMap = vulkanRenderer.getTextureManager()->createSolidColorTexture(glm::vec4(0.0f));
+    // Texturas padrão compartilhadas; os valores ficam nos fatores
+    TextureManager *textures = vulkanRenderer.getTextureManager();
+    material.albedoMap = textures->getWhiteTexture();
+    material.normalMap = textures->createDefaultNormalTexture();
+    material.metallicRoughnessMap = textures->getWhiteTexture();
+    material.aoMap = textures->getWhiteTexture();
+    material.emissiveMap = textures->getWhiteTexture();
+
+    material.baseColorFactor = glm::vec4(1.0f);
+    material.metallicFactor = 0.0f;
+    material.roughnessFactor = 0.5f;
+    material.emissiveFactor = glm::vec3(0.0f);
 }
 
 void EngineModelLoader::LoadMaterialTextures(aiMaterial *material, MaterialComponent &materialComponent)
 {
     aiString texturePath;
+    TextureManager *textures = vulkanRenderer.getTextureManager();
+
+    // Mapa ausente: textura branca compartilhada, o fator carrega o valor constante do material
+    CreateDefaultMaterial(materialComponent);
 
     if (material->GetTexture(aiTextureType_DIFFUSE, 0, &texturePath) == AI_SUCCESS)
     {
         std::string fullPath = directory + "/" + texturePath.C_Str();
-        materialComponent.albedoMap = vulkanRenderer.getTextureManager()->loadTexture(fullPath);
+        materialComponent.albedoMap = textures->loadTexture(fullPath, TextureUsage::Color);
     }
     else
     {
         aiColor4D baseColor(1.0f, 1.0f, 1.0f, 1.0f);
         material->Get(AI_MATKEY_COLOR_DIFFUSE, baseColor);
-        materialComponent.albedoMap = vulkanRenderer.getTextureManager()->createSolidColorTexture(
-            glm::vec4(baseColor.r, baseColor.g, baseColor.b, baseColor.a));
+        materialComponent.baseColorFactor = glm::vec4(baseColor.r, baseColor.g, baseColor.b, baseColor.a);
     }
 
     // Normal Map
     if (material->GetTexture(aiTextureType_NORMALS, 0, &texturePath) == AI_SUCCESS)
     {
         std::string fullPath = directory + "/" + texturePath.C_Str();
-        materialComponent.normalMap = vulkanRenderer.getTextureManager()->loadTexture(fullPath);
-    }
-    else
-    {
-        materialComponent.normalMap = vulkanRenderer.getTextureManager()->createDefaultNormalTexture();
+        materialComponent.normalMap = textures->loadTexture(fullPath, TextureUsage::Normal);
     }
 
-    // Metallic-Roughness Map
+    // Metallic-Roughness Map: com textura, os fatores (quando o formato tiver) a multiplicam
     if (material->GetTexture(aiTextureType_METALNESS, 0, &texturePath) == AI_SUCCESS)
     {
         std::string fullPath = directory + "/" + texturePath.C_Str();
-        materialComponent.metallicRoughnessMap = vulkanRenderer.getTextureManager()->loadTexture(fullPath);
-    }
-    else
-    {
-        float metallicFactor = 0.0f;
-        float roughnessFactor = 0.5f;
-        material->Get(AI_MATKEY_METALLIC_FACTOR, metallicFactor);
-        material->Get(AI_MATKEY_ROUGHNESS_FACTOR, roughnessFactor);
-        materialComponent.metallicRoughnessMap = vulkanRenderer.getTextureManager()->createSolidColorTexture(
-            glm::vec4(0.0f, roughnessFactor, metallicFactor, 0.0f));
+        materialComponent.metallicRoughnessMap = textures->loadTexture(fullPath, TextureUsage::Data);
+        materialComponent.metallicFactor = 1.0f;
+        materialComponent.roughnessFactor = 1.0f;
     }
+    material->Get(AI_MATKEY_METALLIC_FACTOR, materialComponent.metallicFactor);
+    material->Get(AI_MATKEY_ROUGHNESS_FACTOR, materialComponent.roughnessFactor);
 
     // Ambient Occlusion
     if (material->GetTexture(aiTextureType_AMBIENT_OCCLUSION, 0, &texturePath) == AI_SUCCESS)
     {
         std::string fullPath = directory + "/" + texturePath.C_Str();
-        materialComponent.aoMap = vulkanRenderer.getTextureManager()->loadTexture(fullPath);
-    }
-    else
-    {
-        materialComponent.aoMap = vulkanRenderer.getTextureManager()->createSolidColorTexture(glm::vec4(1.0f));
+        materialComponent.aoMap = textures->loadTexture(fullPath, TextureUsage::Data);
     }
 
     // Emissive Map
     if (material->GetTexture(aiTextureType_EMISSIVE, 0, &texturePath) == AI_SUCCESS)
     {
         std::string fullPath = directory + "/" + texturePath.C_Str();
-        materialComponent.emissiveMap = vulkanRenderer.getTextureManager()->loadTexture(fullPath);
+        materialComponent.emissiveMap = textures->loadTexture(fullPath, TextureUsage::Color);
+        materialComponent.emissiveFactor = glm::vec3(1.0f);
     }
     else
     {
         aiColor3D emissiveColor(0.0f, 0.0f, 0.0f);
         material->Get(AI_MATKEY_COLOR_EMISSIVE, emissiveColor);
-        materialComponent.emissiveMap = vulkanRenderer.getTextureManager()->createSolidColorTexture(
-            glm::vec4(emissiveColor.r, emissiveColor.g, emissiveColor.b, 1.0f));
+        materialComponent.emissiveFactor = glm::vec3(emissiveColor.r, emissiveColor.g, emissiveColor.b);
     }
 
     std::cout << "Material texture loading completed." << std::endl;
@@ -379,10 +541,18 @@ void EngineModelLoader::ProcessMaterial(aiMesh *mesh, const aiScene *scene, Mate
     }
 }
 
+void EngineModelLoader::RefreshMaterialDescriptors(MaterialComponent &material)
+{
+    if (material.descriptorSet == VK_NULL_HANDLE) {
+        return;
+    }
+
+    auto imageInfos = SetupImageInfos(material);
+    UpdateDescriptorSets(material, imageInfos);
+}
+
 void EngineModelLoader::SetupDescriptors(MaterialComponent &material)
 {
-    CreateUniformBuffer(material);
-    CreateLightUniformBuffer(material);
     AllocateDescriptorSet(material, material.descriptorSetLayout);
     auto imageInfos = SetupImageInfos(material);
     UpdateDescriptorSets(material, imageInfos);
@@ -390,8 +560,8 @@ void EngineModelLoader::SetupDescriptors(MaterialComponent &material)
 
 void EngineModelLoader::CreateMaterialPipeline(MaterialComponent &material)
 {
-    // Criação do descriptor set layout com um binding extra para o LightUBO
-    std::vector<VkDescriptorSetLayoutBinding> bindings(7); // 6 bindings + 1 para o LightUBO
+    // Criação do descriptor set layout com bindings extras para o LightUBO e os parâmetros dos materiais
+    std::vector<VkDescriptorSetLayoutBinding> bindings(8); // 6 bindings + LightUBO + materiais
 
     // Binding para o UBO
     bindings[0].binding = 0;
@@ -413,27 +583,16 @@ void EngineModelLoader::CreateMaterialPipeline(MaterialComponent &material)
     bindings[6].descriptorCount = 1;
     bindings[6].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT; // Apenas no fragment shader
 
-    // Criação do layout do descriptor set
-    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
-    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-    layoutInfo.pBindings = bindings.data();
-
-    if (vkCreateDescriptorSetLayout(vulkanRenderer.getCore()->getDevice(), &layoutInfo, nullptr, &material.descriptorSetLayout) != VK_SUCCESS) {
-        throw std::runtime_error("Falha ao criar descriptor set layout!");
-    }
+    // Binding para o buffer de parâmetros (GPUMaterial[], indexado por materialIndex)
+    bindings[7].binding = 7;
+    bindings[7].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[7].descriptorCount = 1;
+    bindings[7].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-    // Criação do pipeline layout
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &material.descriptorSetLayout;
+    // Layout compartilhado pelo cache: todos os materiais PBR usam o mesmo handle
+    material.descriptorSetLayout = vulkanRenderer.getCore()->getPipelineCache()->getDescriptorSetLayout(bindings);
 
-    if (vkCreatePipelineLayout(vulkanRenderer.getCore()->getDevice(), &pipelineLayoutInfo, nullptr, &material.pipelineLayout) != VK_SUCCESS) {
-        throw std::runtime_error("Falha ao criar pipeline layout!");
-    }
-
-    // Agora você pode criar o pipeline usando material.pipelineLayout
+    // O pipeline layout (com o range de push constants do modelo/material) é criado junto do pipeline
     material.pipeline = vulkanRenderer.getCore()->getPipeline()->createMaterialPipeline(
         material.pipelineLayout,
         material.descriptorSetLayout,
@@ -450,6 +609,7 @@ void EngineModelLoader::AllocateDescriptorSet(MaterialComponent &material, VkDes
     allocInfo.descriptorSetCount = 1;
     allocInfo.pSetLayouts = &layout; // Use o layout correto
 
+    RenderCounters::add(RenderCounter::DescriptorSetsAllocated, allocInfo.descriptorSetCount);
     if (vkAllocateDescriptorSets(vulkanRenderer.getCore()->getDevice(), &allocInfo, &material.descriptorSet) != VK_SUCCESS) {
         throw std::runtime_error("Falha ao alocar descriptor set!");
     }
@@ -471,6 +631,8 @@ std::array<VkDescriptorImageInfo, 5> EngineModelLoader::SetupImageInfos(Material
 
 std::shared_ptr<Entity> EngineModelLoader::LoadModel(const std::string &path, std::shared_ptr<Entity> parentEntity)
 {
+    PROFILE_ZONE("EngineModelLoader::LoadModel");
+
     Assimp::Importer importer;
     unsigned int flags = aiProcess_Triangulate |
                          aiProcess_GenNormals |
@@ -479,7 +641,11 @@ std::shared_ptr<Entity> EngineModelLoader::LoadModel(const std::string &path, st
                          aiProcess_OptimizeMeshes;
 
     std::string fullPath = FileManager::getInstance().getResourcePath(path);
-    const aiScene *scene = importer.ReadFile(fullPath, flags);
+    const aiScene *scene;
+    {
+        PROFILE_ZONE("Assimp::ReadFile");
+        scene = importer.ReadFile(fullPath, flags);
+    }
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
     {
         throw std::runtime_error("Falha ao carregar modelo: " + std::string(importer.GetErrorString()));
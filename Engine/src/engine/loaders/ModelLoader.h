@@ -20,23 +20,41 @@ public:
     EngineModelLoader(VulkanRenderer &renderer) : vulkanRenderer(renderer) {}
     std::shared_ptr<Entity> LoadModel(const std::string &path, std::shared_ptr<Entity> parentEntity = nullptr);
 
+    // Fração de triângulos de cada LOD gerado na importação (vazio = sem LODs)
+    void SetLodTargets(const std::vector<float> &targets) { lodTargets = targets; }
+    // Uso dos meshes criados pelas próximas cargas (padrão: Static, no VulkanMeshPool)
+    void SetMeshUsage(MeshUsage usage) { meshUsage = usage; }
+    // Reescreve as texturas no set do material (sem bindless), depois que uma delas trocou de imagem
+    void RefreshMaterialDescriptors(MaterialComponent &material);
+    // Terreno plano de resolution x resolution quads, com albedo repetido uvTiling vezes (cena de benchmark)
+    std::shared_ptr<Entity> CreateTerrain(std::shared_ptr<Entity> entity, uint32_t resolution, float size, float uvTiling,
+                                          std::shared_ptr<Texture> albedo);
+
 private:
     std::shared_ptr<Entity> ProcessNode(aiNode *node, const aiScene *scene, std::shared_ptr<Entity> parentEntity);
     void ProcessMesh(aiMesh *mesh, const aiScene *scene, std::shared_ptr<Entity> entity);
+    // LODs, buffers (pool ou próprios, conforme meshUsage) e bounds do mesh
+    void CreateGeometry(MeshComponent &meshComponent, std::vector<Vertex> vertices, const std::vector<uint32_t> &indices);
+    // Bindless ou pipeline + descriptor set próprios
+    void RegisterMaterial(MaterialComponent &material);
     void ProcessMaterial(aiMesh *mesh, const aiScene *scene, MaterialComponent &materialComponent);
     void ProcessTransform(aiNode *node, TransformComponent &transform);
 
     void ConfigureTransform(std::shared_ptr<Entity> entity);
     std::vector<Vertex> ExtractVertices(aiMesh *mesh);
     std::vector<uint32_t> ExtractIndices(aiMesh *mesh);
+    std::vector<glm::vec3> ExtractPositions(MeshComponent &meshComponent, const std::vector<Vertex> &vertices);
+    void CreateMeshBuffer(const void *data, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer &buffer, GpuAllocation &memory);
     void CreateVertexBuffer(MeshComponent &meshComponent, const std::vector<Vertex> &vertices);
     void CreateIndexBuffer(MeshComponent &meshComponent, const std::vector<uint32_t> &indices);
+    void CreatePositionBuffer(MeshComponent &meshComponent, const std::vector<glm::vec3> &positions);
+    std::vector<uint32_t> GenerateLods(MeshComponent &meshComponent, const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices);
+    // Densidade média de UV por unidade local (usada pelo streaming de mips)
+    void ComputeUvDensity(MeshComponent &meshComponent, const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices);
 
     void SetupDescriptors(MaterialComponent &material);
     void CreateMaterialPipeline(MaterialComponent &material);
     void AllocateDescriptorSet(MaterialComponent &material, VkDescriptorSetLayout layout);
-    void CreateUniformBuffer(MaterialComponent &material);
-    void CreateLightUniformBuffer(MaterialComponent &material);
     std::array<VkDescriptorImageInfo, 5> SetupImageInfos(MaterialComponent &material);
     void UpdateDescriptorSets(MaterialComponent &material, const std::array<VkDescriptorImageInfo, 5> &imageInfos);
     void CreateDefaultMaterial(MaterialComponent &material);
@@ -44,4 +62,6 @@ private:
 
     VulkanRenderer &vulkanRenderer;
     std::string directory;
+    std::vector<float> lodTargets = {0.5f, 0.25f, 0.12f};
+    MeshUsage meshUsage = MeshUsage::Static;
 };
@@ -1,4 +1,7 @@
 #include "VulkanRenderer.h"
+#include "core/CpuProfiler.h"
+#include "core/RenderCounters.h"
+#include <magic_enum.hpp>
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <fstream>
@@ -11,6 +14,11 @@
 #include "imgui_impl_glfw.h"
 #include <typeinfo>
 #include <chrono>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <numeric>
+#include <map>
 
 uint32_t WIDTH = 800;
 uint32_t HEIGHT = 600;
@@ -24,7 +32,337 @@ void showError(const std::string &message)
 #endif
 }
 
-int main()
+// --headless [--frames N] [--warmup N] [--width W] [--height H] [--model caminho] [--output arquivo.png] [--trace arquivo.json]
+//            [--memory-budget MB] [--scene terrain] [--no-mipmaps] [--no-streaming] [--texture-budget MB]
+//            [--no-texture-arrays] [--texture-cache MB]
+// --scene terrain: benchmark de texturas (terreno com detalhe repetido até o horizonte); rodar com e sem
+// --no-mipmaps e comparar o tempo do passo Scene e a memória de textura
+// --no-streaming: texturas comprimidas com todos os mips desde a carga (compara com o streaming por mip)
+// --no-texture-arrays: uma imagem por textura pequena (compara imagens/alocações com o empacotamento)
+struct HeadlessOptions
+{
+    bool enabled = false;
+    uint32_t frames = 300;
+    uint32_t warmup = 10;
+    uint32_t width = 1280;
+    uint32_t height = 720;
+    std::string model = "engine/models/plano.fbx";
+    std::string output;
+    std::string trace;
+    uint32_t memoryBudgetMb = 0; // 0 = automático
+    std::string scene = "model";   // model | terrain
+    bool mipmaps = true;
+    bool streaming = true;
+    uint32_t textureBudgetMb = 0; // 0 = padrão do TextureManager
+    bool textureArrays = true;
+    int64_t textureCacheMb = -1; // -1 = padrão do TextureManager
+};
+
+HeadlessOptions parseHeadlessOptions(int argc, char **argv)
+{
+    HeadlessOptions options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--headless")
+            options.enabled = true;
+        else if (arg == "--frames" && hasValue)
+            options.frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--warmup" && hasValue)
+            options.warmup = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--width" && hasValue)
+            options.width = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--height" && hasValue)
+            options.height = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--model" && hasValue)
+            options.model = argv[++i];
+        else if (arg == "--output" && hasValue)
+            options.output = argv[++i];
+        else if (arg == "--trace" && hasValue)
+            options.trace = argv[++i];
+        else if (arg == "--memory-budget" && hasValue)
+            options.memoryBudgetMb = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--scene" && hasValue)
+            options.scene = argv[++i];
+        else if (arg == "--no-mipmaps")
+            options.mipmaps = false;
+        else if (arg == "--no-streaming")
+            options.streaming = false;
+        else if (arg == "--texture-budget" && hasValue)
+            options.textureBudgetMb = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--no-texture-arrays")
+            options.textureArrays = false;
+        else if (arg == "--texture-cache" && hasValue)
+            options.textureCacheMb = static_cast<int64_t>(std::stoul(argv[++i]));
+        else
+            throw std::runtime_error("unknown argument: " + arg);
+    }
+
+    return options;
+}
+
+// Detalhe de alta frequência (xadrez fino + ruído): sem mips, cada pixel distante amostra texels espalhados
+std::shared_ptr<Texture> createTerrainDetailTexture(TextureManager &textures)
+{
+    const uint32_t size = 1024;
+    std::vector<uint8_t> pixels(static_cast<size_t>(size) * size * 4);
+
+    uint32_t seed = 12345;
+    for (uint32_t y = 0; y < size; y++)
+    {
+        for (uint32_t x = 0; x < size; x++)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            uint8_t noise = static_cast<uint8_t>(seed >> 26);
+            bool checker = ((x / 8) + (y / 8)) % 2 == 0;
+
+            uint8_t *pixel = &pixels[(static_cast<size_t>(y) * size + x) * 4];
+            pixel[0] = static_cast<uint8_t>((checker ? 150 : 60) + noise);
+            pixel[1] = static_cast<uint8_t>((checker ? 130 : 90) + noise);
+            pixel[2] = static_cast<uint8_t>((checker ? 70 : 40) + noise);
+            pixel[3] = 255;
+        }
+    }
+
+    return textures.createTexture("benchmark/terrain_detail", pixels.data(), size, size);
+}
+
+// Sem GLFW: renderiza N frames numa imagem offscreen e imprime os tempos no stdout (uma linha por frame + resumo)
+int runHeadless(const HeadlessOptions &options, std::ofstream &logFile)
+{
+    logFile << "[INFO] Modo headless " << options.width << "x" << options.height << ", " << options.frames << " frames\n";
+    PROFILE_THREAD_NAME("Main");
+
+    // Startup = init + carga do modelo: é onde os pipelines são compilados (cold) ou lidos do cache (warm)
+    auto startupBegin = std::chrono::high_resolution_clock::now();
+
+    VulkanRenderer &renderer = VulkanRenderer::getInstance();
+    renderer.initHeadless({options.width, options.height}, !options.output.empty());
+    renderer.getCore()->getResidency()->setBudget(static_cast<VkDeviceSize>(options.memoryBudgetMb) * 1024 * 1024);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(renderer.getCore()->getPhysicalDevice(), &properties);
+    std::cout << "device: " << properties.deviceName << std::endl;
+
+    Scene *scene = renderer.getCore()->getScene();
+
+    renderer.getTextureManager()->setMipmapsEnabled(options.mipmaps);
+    renderer.getTextureManager()->setPackingEnabled(options.textureArrays);
+    if (options.textureCacheMb >= 0)
+        renderer.getTextureManager()->setCacheBudget(static_cast<VkDeviceSize>(options.textureCacheMb) * 1024 * 1024);
+    TextureStreamingSettings &streamingSettings = renderer.getTextureManager()->getStreamingSettings();
+    streamingSettings.enabled = options.streaming;
+    if (options.textureBudgetMb > 0)
+        streamingSettings.budget = static_cast<VkDeviceSize>(options.textureBudgetMb) * 1024 * 1024;
+    std::cout << "scene: " << options.scene << ", mipmaps " << (options.mipmaps ? "on" : "off") << std::endl;
+
+    std::shared_ptr<Entity> model = scene->createEntity();
+    if (options.scene == "terrain")
+    {
+        renderer.getModelLoader()->CreateTerrain(model, 128, 1000.0f, 400.0f,
+                                                 createTerrainDetailTexture(*renderer.getTextureManager()));
+    }
+    else if (options.scene != "model")
+    {
+        throw std::runtime_error("unknown scene: " + options.scene);
+    }
+    else if (!renderer.getModelLoader()->LoadModel(options.model, model))
+    {
+        throw std::runtime_error("failed to load model: " + options.model);
+    }
+
+    // Decodificação roda nos workers: mede com as imagens reais, não com os placeholders
+    renderer.getTextureManager()->waitForLoads();
+
+    {
+        double startupMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startupBegin).count();
+        const PipelineCacheStats &cacheStats = renderer.getCore()->getPipelineCache()->getStats();
+        std::cout << "startup: " << startupMs << " ms, pipeline cache " << (cacheStats.warmStart ? "warm" : "cold")
+                  << " (" << cacheStats.loadedBytes << " bytes), " << cacheStats.compiledPipelines << " pipelines in "
+                  << cacheStats.compileMs << " ms" << std::endl;
+
+        // Segunda execução: tudo vem do .ktx2 (cooked 0)
+        TextureManager *textures = renderer.getTextureManager();
+        std::cout << "textures: " << (textures->isCompressionSupported() ? "BC" : "RGBA8") << ", "
+                  << textures->getCookedCount() << " cooked, " << textures->getCacheHitCount() << " from cache, "
+                  << textures->getLoadProgress().completed << " loaded on " << textures->getWorkerCount()
+                  << " workers (" << textures->getLoadProgress().failed << " failed)" << std::endl;
+    }
+
+    std::shared_ptr<Entity> cameraEntity = scene->createEntity();
+    cameraEntity->setName("Camera");
+    CameraComponent &camera = cameraEntity->addComponent<CameraComponent>();
+    camera.setAspectRatio(static_cast<float>(options.width), static_cast<float>(options.height));
+    if (options.scene == "terrain")
+    {
+        // Rente ao chão, olhando para o horizonte: a minificação cresce com a distância
+        camera.position = glm::vec3(0.0f, 2.0f, 450.0f);
+        camera.front = glm::normalize(glm::vec3(0.0f, -0.15f, -1.0f));
+    }
+    scene->cameraEntity = cameraEntity;
+
+    scene->createLightEntity();
+
+    // Com um frame em voo, o intervalo entre dois renderFrame inclui a espera pela GPU do frame anterior
+    std::vector<double> frameTimes;
+    frameTimes.reserve(options.frames);
+
+    // Soma dos tempos de GPU por escopo (resolvidos com alguns frames de atraso)
+    VulkanProfiler *profiler = renderer.getCore()->getProfiler();
+    std::vector<std::string> gpuScopeOrder;
+    std::map<std::string, std::pair<double, uint32_t>> gpuScopeTotals;
+
+    auto previous = std::chrono::high_resolution_clock::now();
+    for (uint32_t frame = 0; frame < options.warmup + options.frames; frame++)
+    {
+        PROFILE_ZONE("Frame");
+        scene->updateCamera();
+        renderer.getCore()->renderFrame();
+
+        auto now = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(now - previous).count();
+        previous = now;
+
+        if (frame < options.warmup)
+            continue;
+
+        frameTimes.push_back(ms);
+        std::cout << "frame " << frameTimes.size() - 1 << ": " << ms << " ms";
+        if (profiler && profiler->isSupported())
+        {
+            std::cout << " gpu: " << profiler->getFrameTime() << " ms";
+            for (const auto &timing : profiler->getTimings())
+            {
+                auto &total = gpuScopeTotals[timing.name];
+                if (total.second == 0)
+                    gpuScopeOrder.push_back(timing.name);
+                total.first += timing.milliseconds;
+                total.second++;
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    renderer.getCore()->waitIdle();
+
+    if (!frameTimes.empty())
+    {
+        std::vector<double> sorted = frameTimes;
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&](double p) {
+            return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+        };
+
+        double average = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+        std::cout << "frames: " << sorted.size()
+                  << " avg: " << average << " ms"
+                  << " min: " << sorted.front() << " ms"
+                  << " p50: " << percentile(0.50) << " ms"
+                  << " p95: " << percentile(0.95) << " ms"
+                  << " p99: " << percentile(0.99) << " ms"
+                  << " max: " << sorted.back() << " ms"
+                  << " fps: " << 1000.0 / average << std::endl;
+    }
+
+    for (const auto &name : gpuScopeOrder)
+    {
+        const auto &total = gpuScopeTotals[name];
+        std::cout << "gpu " << name << ": avg: " << total.first / total.second << " ms" << std::endl;
+    }
+
+    // Contadores do último frame; o total inclui o carregamento e o warmup
+    for (RenderCounter counter : magic_enum::enum_values<RenderCounter>())
+    {
+        if (counter == RenderCounter::Count)
+            continue;
+        std::cout << "counter " << magic_enum::enum_name(counter) << ": " << RenderCounters::get(counter)
+                  << " total: " << RenderCounters::total(counter) << std::endl;
+    }
+
+    if (profiler && profiler->isPipelineStatisticsSupported())
+    {
+        const PipelineStatistics &statistics = profiler->getPipelineStatistics();
+        std::cout << "pipeline statistics: vertex invocations: " << statistics.vertexInvocations
+                  << " fragment invocations: " << statistics.fragmentInvocations
+                  << " clipping primitives: " << statistics.clippingPrimitives << std::endl;
+    }
+
+    {
+        GpuMemoryStats memory = renderer.getCore()->getAllocator()->getStats();
+        std::cout << "gpu memory: " << memory.deviceMemoryCount << " device allocations ("
+                  << memory.dedicatedCount << " dedicated) for " << memory.allocationCount << " resources, "
+                  << memory.usedBytes << " / " << memory.reservedBytes << " bytes" << std::endl;
+        for (const GpuMemoryPoolStats &pool : memory.pools)
+        {
+            std::cout << "gpu memory type " << pool.memoryType << " " << magic_enum::enum_name(pool.kind)
+                      << ": blocks: " << pool.blockCount << " allocations: " << pool.allocationCount
+                      << " free ranges: " << pool.freeRangeCount << " fragmentation: " << pool.fragmentation << std::endl;
+        }
+        for (size_t i = 0; i < memory.categoryBytes.size(); i++)
+        {
+            std::cout << "gpu memory " << magic_enum::enum_name(static_cast<GpuMemoryCategory>(i)) << ": "
+                      << memory.categoryCounts[i] << " resources, " << memory.categoryBytes[i] << " bytes" << std::endl;
+        }
+
+        std::vector<GpuHeapBudget> heaps = renderer.getCore()->getAllocator()->queryBudget();
+        for (size_t i = 0; i < heaps.size(); i++)
+        {
+            std::cout << "gpu heap " << i << (heaps[i].deviceLocal ? " (device local)" : "") << ": usage " << heaps[i].usage
+                      << " / budget " << heaps[i].budget << " / size " << heaps[i].size << ", tracked " << heaps[i].tracked
+                      << std::endl;
+        }
+
+        const ResidencyStats &residency = renderer.getCore()->getResidency()->getStats();
+        std::cout << "residency: budget " << residency.budget << " usage " << residency.usage << ", evicted "
+                  << residency.evictedTextures << " textures / " << residency.evictedMeshes << " meshes, evictions "
+                  << residency.textureEvictions + residency.meshEvictions << " (" << residency.emergencyEvictions
+                  << " out of memory), restores " << residency.restores << std::endl;
+
+        const TextureStreamingStats &streaming = renderer.getTextureManager()->getStreamingStats();
+        std::cout << "texture streaming: " << (options.streaming ? "on" : "off") << ", " << streaming.streamedTextures
+                  << " textures, resident " << streaming.residentBytes << " / requested " << streaming.requestedBytes
+                  << " bytes, " << streaming.starvedTextures << " starved, upgrades " << streaming.upgrades
+                  << ", downgrades " << streaming.downgrades << std::endl;
+
+        const TextureCacheStats &cache = renderer.getTextureManager()->getCacheStats();
+        std::cout << "texture cache: " << cache.textures << " textures (" << cache.referenced << " referenced), "
+                  << cache.bytes << " bytes, hits " << cache.hits << ", misses " << cache.misses << ", same content "
+                  << cache.contentHits << ", evictions " << cache.evictions << std::endl;
+
+        const TextureArrayStats arrays = renderer.getTextureManager()->getArrayStats();
+        std::cout << "texture arrays: " << (options.textureArrays ? "on" : "off") << ", " << arrays.arrayCount
+                  << " arrays, " << arrays.usedLayers << " / " << arrays.layerCapacity << " layers, " << arrays.bytes
+                  << " bytes" << std::endl;
+    }
+
+    {
+        const UploadStats &uploads = renderer.getCore()->getUploadContext()->getStats();
+        std::cout << "uploads: " << uploads.submittedBatches << " batches, " << uploads.uploadedBytes << " bytes, "
+                  << uploads.stallCount << " staging stalls, "
+                  << (uploads.dedicatedTransferQueue ? "dedicated transfer queue" : "graphics queue") << std::endl;
+    }
+
+    if (!options.output.empty())
+    {
+        renderer.getCore()->saveReadbackImage(options.output);
+        std::cout << "saved: " << options.output << std::endl;
+    }
+
+    // Toda a execução (limitada pelo ring buffer de cada thread)
+    if (!options.trace.empty())
+    {
+        size_t events = CpuProfiler::captureTrace(options.trace, 1e6);
+        std::cout << "trace: " << options.trace << " (" << events << " zones)" << std::endl;
+    }
+
+    logFile << "[INFO] Headless finalizado\n";
+    return 0;
+}
+
+int main(int argc, char **argv)
 {
     std::ofstream logFile("engine_log.txt", std::ios::app);
     if (logFile.is_open()) {
@@ -34,6 +372,19 @@ int main()
     }
 
     try {
+        HeadlessOptions headlessOptions = parseHeadlessOptions(argc, argv);
+        if (headlessOptions.enabled) {
+            // Sem MessageBox no headless: a execução é automatizada
+            try {
+                return runHeadless(headlessOptions, logFile);
+            }
+            catch (const std::exception &e) {
+                logFile << "[ERRO FATAL] Headless: " << e.what() << "\n";
+                std::cerr << "Error: " << e.what() << std::endl;
+                return 1;
+            }
+        }
+
         logFile << "[INFO] Inicializando GLFW...\n";
         if (!glfwInit()) {
             logFile << "[ERRO] Falha ao inicializar GLFW\n";
@@ -121,8 +472,13 @@ int main()
             std::shared_ptr<Entity> lightEntity = scene->createLightEntity();
 
             logFile << "[INFO] Iniciando loop principal...\n";
+            PROFILE_THREAD_NAME("Main");
             while (!glfwWindowShouldClose(window)) {
-                glfwPollEvents();
+                PROFILE_ZONE("Frame");
+                {
+                    PROFILE_ZONE("PollEvents");
+                    glfwPollEvents();
+                }
 
                 // ImGui input handling
                 ImGuiIO &io = ImGui::GetIO();
@@ -0,0 +1,258 @@
+#include "Ktx2File.h"
+#include "TextureCompressor.h"
+#include "../core/CpuProfiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    const uint8_t IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+    const char AVERAGE_COLOR_KEY[] = "averageColor";
+
+    struct Header
+    {
+        uint8_t identifier[12];
+        uint32_t vkFormat;
+        uint32_t typeSize;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t layerCount;
+        uint32_t faceCount;
+        uint32_t levelCount;
+        uint32_t supercompressionScheme;
+        uint32_t dfdByteOffset;
+        uint32_t dfdByteLength;
+        uint32_t kvdByteOffset;
+        uint32_t kvdByteLength;
+        uint64_t sgdByteOffset;
+        uint64_t sgdByteLength;
+    };
+    static_assert(sizeof(Header) == 80, "KTX2 header layout");
+
+    struct LevelIndex
+    {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+
+    uint64_t alignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // Descritor básico do Khronos Data Format: modelo de cor BCn, bloco 4x4, um sample cobrindo o bloco
+    std::vector<uint32_t> buildDataFormatDescriptor(VkFormat format)
+    {
+        uint32_t colorModel = 0;
+        switch (format)
+        {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            colorModel = 128;
+            break;
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+            colorModel = 130;
+            break;
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+            colorModel = 131;
+            break;
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+            colorModel = 132;
+            break;
+        default:
+            colorModel = 134;
+            break;
+        }
+
+        const bool srgb = format == VK_FORMAT_BC1_RGB_SRGB_BLOCK || format == VK_FORMAT_BC3_SRGB_BLOCK ||
+                          format == VK_FORMAT_BC7_SRGB_BLOCK;
+        const uint32_t blockBits = TextureCompressor::BlockSize(format) * 8;
+
+        // dfdTotalSize + cabeçalho do bloco (6 palavras) + um sample (4 palavras)
+        std::vector<uint32_t> words(1 + 6 + 4, 0);
+        words[0] = static_cast<uint32_t>(words.size() * 4);
+        words[1] = 0;                               // vendorId Khronos, descriptorType básico
+        words[2] = 2 | ((static_cast<uint32_t>(words.size() - 1) * 4) << 16); // versão 1.3, tamanho do bloco
+        words[3] = colorModel | (1u << 8) | ((srgb ? 2u : 1u) << 16); // primaries BT709, transfer
+        words[4] = 3 | (3 << 8);                    // bloco 4x4 (dimensão - 1)
+        words[5] = TextureCompressor::BlockSize(format);
+        words[7] = ((blockBits - 1) << 16);         // bitOffset 0, bitLength, canal 0
+        words[9] = 0;
+        words[10] = 0xFFFFFFFFu;
+        return words;
+    }
+}
+
+bool Ktx2File::Write(const std::string &path, const Ktx2Image &image)
+{
+    PROFILE_ZONE("Ktx2File::Write");
+
+    if (image.firstLevel != 0)
+        return false;
+
+    const uint32_t levelCount = static_cast<uint32_t>(image.levelOffsets.size());
+    std::vector<uint32_t> dfd = buildDataFormatDescriptor(image.format);
+
+    // Par chave/valor: comprimento, "chave\0valor", preenchido até 4 bytes
+    std::vector<uint8_t> kvd;
+    const uint32_t keyValueLength = sizeof(AVERAGE_COLOR_KEY) + 4;
+    kvd.resize(4 + alignUp(keyValueLength, 4), 0);
+    memcpy(kvd.data(), &keyValueLength, 4);
+    memcpy(kvd.data() + 4, AVERAGE_COLOR_KEY, sizeof(AVERAGE_COLOR_KEY));
+    memcpy(kvd.data() + 4 + sizeof(AVERAGE_COLOR_KEY), image.averageColor.data(), 4);
+
+    Header header{};
+    memcpy(header.identifier, IDENTIFIER, sizeof(IDENTIFIER));
+    header.vkFormat = image.format;
+    header.typeSize = 1;
+    header.pixelWidth = image.width;
+    header.pixelHeight = image.height;
+    header.faceCount = 1;
+    header.levelCount = levelCount;
+    header.dfdByteOffset = static_cast<uint32_t>(sizeof(Header) + levelCount * sizeof(LevelIndex));
+    header.dfdByteLength = static_cast<uint32_t>(dfd.size() * 4);
+    header.kvdByteOffset = header.dfdByteOffset + header.dfdByteLength;
+    header.kvdByteLength = static_cast<uint32_t>(kvd.size());
+
+    // Os níveis ficam do menor para o maior no arquivo, cada um alinhado ao tamanho do bloco (16 cobre todos)
+    std::vector<LevelIndex> levels(levelCount);
+    uint64_t offset = header.kvdByteOffset + header.kvdByteLength;
+    for (uint32_t level = levelCount; level-- > 0;)
+    {
+        uint64_t end = level + 1 < levelCount ? image.levelOffsets[level + 1] : image.data.size();
+        offset = alignUp(offset, 16);
+        levels[level] = {offset, end - image.levelOffsets[level], end - image.levelOffsets[level]};
+        offset += levels[level].byteLength;
+    }
+
+    // Escreve num temporário e renomeia: um cook interrompido não deixa um cache truncado
+    const std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(levels.data()), levels.size() * sizeof(LevelIndex));
+        file.write(reinterpret_cast<const char *>(dfd.data()), dfd.size() * 4);
+        file.write(reinterpret_cast<const char *>(kvd.data()), kvd.size());
+
+        uint64_t written = header.kvdByteOffset + header.kvdByteLength;
+        for (uint32_t level = levelCount; level-- > 0;)
+        {
+            static const char padding[16] = {};
+            file.write(padding, levels[level].byteOffset - written);
+            file.write(reinterpret_cast<const char *>(image.data.data() + image.levelOffsets[level]),
+                       levels[level].byteLength);
+            written = levels[level].byteOffset + levels[level].byteLength;
+        }
+
+        if (!file)
+            return false;
+    }
+
+    std::remove(path.c_str());
+    return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
+
+uint32_t Ktx2File::FirstLevelFor(uint32_t width, uint32_t height, uint32_t levelCount, uint32_t maxDimension)
+{
+    if (maxDimension == 0)
+        return 0;
+
+    uint32_t level = 0;
+    while (level + 1 < levelCount && std::max(width >> level, height >> level) > maxDimension)
+        level++;
+    return level;
+}
+
+bool Ktx2File::Read(const std::string &path, Ktx2Image &image, uint32_t maxDimension)
+{
+    PROFILE_ZONE("Ktx2File::Read");
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+
+    const uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    if (fileSize < sizeof(Header))
+        return false;
+    file.seekg(0);
+
+    Header header{};
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!file || memcmp(header.identifier, IDENTIFIER, sizeof(IDENTIFIER)) != 0)
+        return false;
+
+    const VkFormat format = static_cast<VkFormat>(header.vkFormat);
+    if (!TextureCompressor::IsSupported(format) || header.pixelDepth != 0 || header.layerCount > 1 ||
+        header.faceCount != 1 || header.supercompressionScheme != 0 || header.levelCount == 0 ||
+        header.pixelWidth == 0 || header.pixelHeight == 0)
+    {
+        return false;
+    }
+
+    std::vector<LevelIndex> levels(header.levelCount);
+    file.read(reinterpret_cast<char *>(levels.data()), levels.size() * sizeof(LevelIndex));
+    if (!file)
+        return false;
+
+    image.format = format;
+    image.width = header.pixelWidth;
+    image.height = header.pixelHeight;
+    image.levelCount = header.levelCount;
+    image.firstLevel = FirstLevelFor(header.pixelWidth, header.pixelHeight, header.levelCount, maxDimension);
+    image.averageColor = {255, 255, 255, 255};
+
+    if (header.kvdByteLength > 0 && header.kvdByteOffset + static_cast<uint64_t>(header.kvdByteLength) <= fileSize)
+    {
+        std::vector<uint8_t> kvd(header.kvdByteLength);
+        file.seekg(header.kvdByteOffset);
+        file.read(reinterpret_cast<char *>(kvd.data()), kvd.size());
+
+        size_t position = 0;
+        while (file && position + 4 <= kvd.size())
+        {
+            uint32_t length;
+            memcpy(&length, kvd.data() + position, 4);
+            if (position + 4 + length > kvd.size())
+                break;
+
+            const uint8_t *entry = kvd.data() + position + 4;
+            if (length == sizeof(AVERAGE_COLOR_KEY) + 4 && memcmp(entry, AVERAGE_COLOR_KEY, sizeof(AVERAGE_COLOR_KEY)) == 0)
+                memcpy(image.averageColor.data(), entry + sizeof(AVERAGE_COLOR_KEY), 4);
+            position += 4 + alignUp(length, 4);
+        }
+    }
+
+    // Tamanho de cada nível conferido contra o formato: um arquivo inconsistente é recozido
+    image.levelOffsets.clear();
+    VkDeviceSize total = 0;
+    for (uint32_t level = 0; level < header.levelCount; level++)
+    {
+        const VkDeviceSize expected = TextureCompressor::LevelSize(format, std::max(1u, image.width >> level),
+                                                                   std::max(1u, image.height >> level));
+        if (levels[level].byteLength != expected || levels[level].byteOffset + levels[level].byteLength > fileSize)
+            return false;
+
+        if (level >= image.firstLevel)
+        {
+            image.levelOffsets.push_back(total);
+            total += expected;
+        }
+    }
+
+    image.data.resize(total);
+    for (uint32_t level = image.firstLevel; level < header.levelCount; level++)
+    {
+        file.seekg(levels[level].byteOffset);
+        file.read(reinterpret_cast<char *>(image.data.data() + image.levelOffsets[level - image.firstLevel]),
+                  levels[level].byteLength);
+    }
+    return static_cast<bool>(file);
+}
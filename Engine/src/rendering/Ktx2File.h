@@ -0,0 +1,33 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Imagem 2D com a cadeia de mips, na ordem do upload (nível firstLevel primeiro)
+struct Ktx2Image
+{
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint32_t width = 0;  // do nível 0, mesmo que ele não esteja em data
+    uint32_t height = 0;
+    uint32_t levelCount = 1; // da cadeia inteira
+    uint32_t firstLevel = 0; // data começa neste nível (leitura parcial para o streaming)
+    std::vector<uint8_t> data;
+    std::vector<VkDeviceSize> levelOffsets; // início de cada nível carregado em data
+    std::array<uint8_t, 4> averageColor{255, 255, 255, 255};
+};
+
+// Subconjunto do KTX 2.0 usado pelo cache de texturas: 2D, uma camada, uma face, sem supercompressão.
+// A cor média vai num par chave/valor ("averageColor") para o despejo não precisar ler os texels.
+class Ktx2File
+{
+public:
+    // Só imagens com a cadeia inteira (firstLevel 0)
+    static bool Write(const std::string &path, const Ktx2Image &image);
+    // false se o arquivo não existir ou não for algo que Write produziria. Com maxDimension, lê só os
+    // níveis cujo maior lado cabe nele (sempre pelo menos o último): os menores ficam no início do arquivo
+    static bool Read(const std::string &path, Ktx2Image &image, uint32_t maxDimension = 0);
+    // Primeiro nível cujo maior lado cabe em maxDimension (0 = nível 0)
+    static uint32_t FirstLevelFor(uint32_t width, uint32_t height, uint32_t levelCount, uint32_t maxDimension);
+};
@@ -0,0 +1,153 @@
+#include "MipmapGenerator.h"
+#include "../core/CpuProfiler.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIPMAP_USE_SSE2 1
+#endif
+
+namespace
+{
+    // sRGB 8 bits -> linear 16 bits e linear 12 bits -> sRGB 8 bits
+    struct SrgbTables
+    {
+        std::array<uint16_t, 256> toLinear;
+        std::array<uint8_t, 4096> fromLinear;
+
+        SrgbTables()
+        {
+            for (int i = 0; i < 256; i++)
+            {
+                float c = i / 255.0f;
+                float l = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                toLinear[i] = static_cast<uint16_t>(l * 65535.0f + 0.5f);
+            }
+            for (int i = 0; i < 4096; i++)
+            {
+                float l = i / 4095.0f;
+                float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+                fromLinear[i] = static_cast<uint8_t>(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+            }
+        }
+    };
+
+    const SrgbTables &srgbTables()
+    {
+        static const SrgbTables tables;
+        return tables;
+    }
+
+    uint8_t averageSrgb(const SrgbTables &tables, uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    {
+        uint32_t sum = tables.toLinear[a] + tables.toLinear[b] + tables.toLinear[c] + tables.toLinear[d];
+        return tables.fromLinear[(sum / 4) >> 4];
+    }
+
+    uint8_t averageLinear(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    {
+        return static_cast<uint8_t>((a + b + c + d + 2) / 4);
+    }
+
+    // Pixels [firstX, dstWidth) de uma linha do nível seguinte; alpha sempre linear
+    void downsampleRowScalar(const uint8_t *row0, const uint8_t *row1, uint8_t *dst, uint32_t srcWidth,
+                             uint32_t firstX, uint32_t dstWidth, bool srgb)
+    {
+        const SrgbTables &tables = srgbTables();
+        for (uint32_t x = firstX; x < dstWidth; x++)
+        {
+            uint32_t x0 = std::min(2 * x, srcWidth - 1) * 4;
+            uint32_t x1 = std::min(2 * x + 1, srcWidth - 1) * 4;
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                uint8_t a = row0[x0 + c], b = row0[x1 + c], d = row1[x0 + c], e = row1[x1 + c];
+                dst[x * 4 + c] = srgb && c < 3 ? averageSrgb(tables, a, b, d, e) : averageLinear(a, b, d, e);
+            }
+        }
+    }
+
+#ifdef MIPMAP_USE_SSE2
+    // Dois pixels de saída por iteração: 4 pixels de cada linha de origem somados em 16 bits
+    uint32_t downsampleRowSse2(const uint8_t *row0, const uint8_t *row1, uint8_t *dst, uint32_t dstWidth)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i rounding = _mm_set1_epi16(2);
+
+        uint32_t x = 0;
+        for (; x + 2 <= dstWidth; x += 2)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + x * 8));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + x * 8));
+
+            // Soma vertical: pixels 0-1 em lo, 2-3 em hi
+            __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+            // Soma horizontal dos pares: resultado nos 4 lanes de baixo de cada metade
+            lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+            hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+
+            __m128i sum = _mm_unpacklo_epi64(lo, hi);
+            sum = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 2);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + x * 4), _mm_packus_epi16(sum, zero));
+        }
+        return x;
+    }
+#endif
+
+    void downsample(const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight, uint8_t *dst, bool srgb)
+    {
+        uint32_t dstWidth = std::max(1u, srcWidth / 2);
+        uint32_t dstHeight = std::max(1u, srcHeight / 2);
+
+        for (uint32_t y = 0; y < dstHeight; y++)
+        {
+            const uint8_t *row0 = src + static_cast<size_t>(std::min(2 * y, srcHeight - 1)) * srcWidth * 4;
+            const uint8_t *row1 = src + static_cast<size_t>(std::min(2 * y + 1, srcHeight - 1)) * srcWidth * 4;
+            uint8_t *out = dst + static_cast<size_t>(y) * dstWidth * 4;
+
+            uint32_t done = 0;
+#ifdef MIPMAP_USE_SSE2
+            // Coluna ímpar da origem (largura 1) precisa do clamp do caminho escalar
+            if (!srgb && srcWidth >= 2)
+                done = downsampleRowSse2(row0, row1, out, dstWidth);
+#endif
+            downsampleRowScalar(row0, row1, out, srcWidth, done, dstWidth, srgb);
+        }
+    }
+}
+
+uint32_t MipmapGenerator::LevelCount(uint32_t width, uint32_t height)
+{
+    uint32_t levels = 1;
+    for (uint32_t size = std::max(width, height); size > 1; size /= 2)
+        levels++;
+    return levels;
+}
+
+std::vector<uint8_t> MipmapGenerator::BuildChainRGBA8(const uint8_t *pixels, uint32_t width, uint32_t height,
+                                                      uint32_t levels, bool srgb,
+                                                      std::vector<VkDeviceSize> &outLevelOffsets)
+{
+    PROFILE_ZONE("MipmapGenerator::BuildChainRGBA8");
+
+    outLevelOffsets.resize(levels);
+    VkDeviceSize total = 0;
+    for (uint32_t level = 0; level < levels; level++)
+    {
+        outLevelOffsets[level] = total;
+        total += static_cast<VkDeviceSize>(std::max(1u, width >> level)) * std::max(1u, height >> level) * 4;
+    }
+
+    std::vector<uint8_t> chain(static_cast<size_t>(total));
+    memcpy(chain.data(), pixels, static_cast<size_t>(width) * height * 4);
+
+    for (uint32_t level = 1; level < levels; level++)
+    {
+        downsample(chain.data() + outLevelOffsets[level - 1], std::max(1u, width >> (level - 1)),
+                   std::max(1u, height >> (level - 1)), chain.data() + outLevelOffsets[level], srgb);
+    }
+    return chain;
+}
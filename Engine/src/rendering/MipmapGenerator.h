@@ -0,0 +1,18 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+// Cadeia de mips na CPU, para formatos sem blit linear na GPU: filtro box 2x2 sobre RGBA8.
+// Em sRGB a média das cores é feita em espaço linear (tabelas); nos demais formatos direto nos bytes, com SSE2.
+class MipmapGenerator
+{
+public:
+    // Níveis até 1x1
+    static uint32_t LevelCount(uint32_t width, uint32_t height);
+
+    // Todos os níveis em sequência, a partir de uma cópia do nível 0; outLevelOffsets[i] é o início do nível i
+    static std::vector<uint8_t> BuildChainRGBA8(const uint8_t *pixels, uint32_t width, uint32_t height,
+                                                uint32_t levels, bool srgb,
+                                                std::vector<VkDeviceSize> &outLevelOffsets);
+};
@@ -1,23 +1,57 @@
 #pragma once
 #include <vulkan/vulkan.h>
+#include "../core/RenderCounters.h"
+#include "../core/VulkanAllocator.h"
+#include <array>
+#include <string>
 
 class Texture
 {
 public:
     VkImage image = VK_NULL_HANDLE;
-    VkDeviceMemory imageMemory = VK_NULL_HANDLE;
+    GpuAllocation imageMemory;
     VkImageView imageView = VK_NULL_HANDLE;
-    VkSampler sampler = VK_NULL_HANDLE;
+    VkSampler sampler = VK_NULL_HANDLE; // do cache de samplers do VulkanCore
 
-    void Destroy(VkDevice device)
+    // Dados para despejar/recarregar (VulkanResidency); sem sourcePath a textura fica sempre residente
+    std::string sourcePath;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mipLevels = 1; // da imagem atual (o 1x1 de uma textura despejada tem um só)
+    VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+    std::array<uint8_t, 4> averageColor{255, 255, 255, 255};
+    // Despejada: image é um 1x1 com averageColor até voltar
+    bool evicted = false;
+    // Decodificando nos workers: image é o placeholder 1x1 até TextureManager::update
+    bool loading = false;
+
+    // Streaming por mip (só do cache .ktx2): width/height são do nível 0, a imagem guarda [residentMip, fullMipLevels)
+    bool streamed = false;
+    bool streaming = false; // leitura de outros níveis nos workers; a imagem atual continua valendo
+    uint32_t fullMipLevels = 1;
+    uint32_t residentMip = 0;
+    uint32_t requestedMip = UINT32_MAX; // nível mais detalhado pedido pelos draws do frame
+    uint64_t mipNeededFrame = 0;        // último frame em que residentMip (ou melhor) foi pedido
+
+    // Camada de um array do TextureArrayPool: image fica nulo, só a view (da camada) é da textura
+    static constexpr uint32_t NOT_PACKED = UINT32_MAX;
+    uint32_t arrayIndex = NOT_PACKED;
+    uint32_t arrayLayer = 0;
+    bool isPacked() const { return arrayIndex != NOT_PACKED; }
+    uint64_t lastUsedFrame = 0;
+    uint64_t uploadTicket = 0; // UploadTicket do lote que escreveu a imagem atual
+
+    void Destroy(VkDevice device, VulkanAllocator &allocator)
     {
-        // Destruir o sampler (se existir)
-        if (sampler != VK_NULL_HANDLE)
-        {
-            vkDestroySampler(device, sampler, nullptr);
-            sampler = VK_NULL_HANDLE;
-        }
+        // O sampler é compartilhado (cache do VulkanCore): só solta o handle
+        sampler = VK_NULL_HANDLE;
 
+        DestroyImage(device, allocator);
+    }
+
+    // Só a imagem e a view; o sampler continua para a próxima imagem
+    void DestroyImage(VkDevice device, VulkanAllocator &allocator)
+    {
         // Destruir a image view (se existir)
         if (imageView != VK_NULL_HANDLE)
         {
@@ -28,16 +62,13 @@ public:
         // Destruir a imagem (se existir)
         if (image != VK_NULL_HANDLE)
         {
+            RenderCounters::add(RenderCounter::ImagesDestroyed);
             vkDestroyImage(device, image, nullptr);
             image = VK_NULL_HANDLE;
         }
 
-        // Liberar a memória da imagem (se existir)
-        if (imageMemory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(device, imageMemory, nullptr);
-            imageMemory = VK_NULL_HANDLE;
-        }
+        // Devolver a faixa da imagem ao alocador
+        allocator.free(imageMemory);
     }
 
     VkDescriptorImageInfo getDescriptorInfo() const
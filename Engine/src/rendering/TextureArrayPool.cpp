@@ -0,0 +1,121 @@
+#include "TextureArrayPool.h"
+#include "Texture.h"
+#include "../core/VulkanCore.h"
+#include "../core/VulkanUploadContext.h"
+#include "../core/VulkanDeletionQueue.h"
+#include "../core/CpuProfiler.h"
+#include <algorithm>
+
+TextureArrayPool::TextureArrayPool(VulkanCore &core) : core(core)
+{
+}
+
+void TextureArrayPool::pack(Texture &texture, VkFormat format, uint32_t width, uint32_t height, const void *data,
+                            VkDeviceSize size, const std::vector<VkDeviceSize> &levelOffsets)
+{
+    PROFILE_ZONE("TextureArrayPool::pack");
+
+    const uint32_t mipLevels = static_cast<uint32_t>(levelOffsets.size());
+    const uint32_t index = findOrCreateArray(format, width, height, mipLevels);
+    Array &array = arrays[index];
+
+    const uint32_t layer = array.freeLayers.back();
+    array.freeLayers.pop_back();
+
+    // A camada sai de UNDEFINED sozinha: as vizinhas continuam em SHADER_READ_ONLY
+    VulkanUploadContext *uploads = core.getUploadContext();
+    uploads->uploadImageLevels(array.image, width, height, data, size, levelOffsets, layer);
+
+    texture.arrayIndex = index;
+    texture.arrayLayer = layer;
+    texture.uploadTicket = uploads->getOpenTicket();
+    texture.mipLevels = mipLevels;
+    texture.imageView = core.createImageView(array.image, format, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels, layer);
+}
+
+void TextureArrayPool::release(Texture &texture)
+{
+    if (!texture.isPacked())
+        return;
+
+    // A camada só volta para a pilha depois que nenhum frame em voo a amostra
+    const uint32_t index = texture.arrayIndex;
+    const uint32_t layer = texture.arrayLayer;
+    core.getDeletionQueue()->destroyImageView(texture.imageView);
+    core.getDeletionQueue()->push([this, index, layer] {
+        Array &array = arrays[index];
+        array.freeLayers.push_back(layer);
+
+        // Vazio: nenhuma view aponta para ele e os frames que o usaram já terminaram. O slot fica para o
+        // próximo array, porque as texturas guardam o índice.
+        if (array.freeLayers.size() == LAYERS_PER_ARRAY)
+        {
+            core.destroyImage(array.image, array.memory);
+            array = Array();
+        }
+    });
+
+    texture.arrayIndex = Texture::NOT_PACKED;
+    texture.arrayLayer = 0;
+}
+
+void TextureArrayPool::cleanup()
+{
+    // As views das camadas são das texturas e saem com elas
+    for (Array &array : arrays)
+        core.destroyImage(array.image, array.memory);
+    arrays.clear();
+}
+
+TextureArrayStats TextureArrayPool::getStats() const
+{
+    TextureArrayStats stats;
+    for (const Array &array : arrays)
+    {
+        if (array.image == VK_NULL_HANDLE)
+            continue;
+
+        stats.arrayCount++;
+        stats.usedLayers += LAYERS_PER_ARRAY - static_cast<uint32_t>(array.freeLayers.size());
+        stats.layerCapacity += LAYERS_PER_ARRAY;
+        stats.bytes += array.memory.size;
+    }
+    return stats;
+}
+
+uint32_t TextureArrayPool::findOrCreateArray(VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevels)
+{
+    uint32_t index = static_cast<uint32_t>(arrays.size());
+    for (uint32_t i = 0; i < arrays.size(); i++)
+    {
+        const Array &array = arrays[i];
+        if (array.image == VK_NULL_HANDLE)
+        {
+            index = std::min(index, i);
+            continue;
+        }
+        if (array.format == format && array.width == width && array.height == height && array.mipLevels == mipLevels &&
+            !array.freeLayers.empty())
+        {
+            return i;
+        }
+    }
+
+    Array array;
+    array.format = format;
+    array.width = width;
+    array.height = height;
+    array.mipLevels = mipLevels;
+    core.createImage(width, height, format, VK_IMAGE_TILING_OPTIMAL,
+                     VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                     array.image, array.memory, mipLevels, GpuMemoryCategory::Texture, LAYERS_PER_ARRAY);
+
+    for (uint32_t layer = LAYERS_PER_ARRAY; layer-- > 0;)
+        array.freeLayers.push_back(layer);
+
+    if (index == arrays.size())
+        arrays.push_back(std::move(array));
+    else
+        arrays[index] = std::move(array);
+    return index;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include "../core/VulkanAllocator.h"
+#include <cstdint>
+#include <vector>
+
+class VulkanCore;
+class Texture;
+
+struct TextureArrayStats
+{
+    uint32_t arrayCount = 0;
+    uint32_t usedLayers = 0;
+    uint32_t layerCapacity = 0;
+    VkDeviceSize bytes = 0;
+};
+
+// Texturas pequenas com o mesmo formato, tamanho e número de mips dividem uma imagem 2D array: uma
+// VkImage e uma alocação por array em vez de uma por textura. Cada textura fica com uma view 2D da sua
+// camada, então materiais, sets bindless e shaders continuam iguais.
+class TextureArrayPool
+{
+public:
+    static constexpr uint32_t LAYERS_PER_ARRAY = 64;
+
+    explicit TextureArrayPool(VulkanCore &core);
+
+    // Envia os níveis (levelOffsets[i] = início do nível i em data) para uma camada livre de um array
+    // compatível, criando um se preciso, e dá à textura a view dessa camada. Não mexe em texture.image.
+    void pack(Texture &texture, VkFormat format, uint32_t width, uint32_t height, const void *data, VkDeviceSize size,
+              const std::vector<VkDeviceSize> &levelOffsets);
+    // Devolve a camada e destrói a view pela fila de destruição (o frame em voo pode estar amostrando);
+    // o array que fica sem nenhuma camada em uso é destruído junto
+    void release(Texture &texture);
+    // Destrói as imagens dos arrays. Só com a GPU ociosa e a fila de destruição já executada:
+    // release empurra lambdas que usam o pool
+    void cleanup();
+
+    TextureArrayStats getStats() const;
+
+private:
+    struct Array
+    {
+        VkImage image = VK_NULL_HANDLE;
+        GpuAllocation memory;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t mipLevels = 1;
+        std::vector<uint32_t> freeLayers; // pilha; as camadas mais baixas saem primeiro
+    };
+
+    uint32_t findOrCreateArray(VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevels);
+
+    VulkanCore &core;
+    std::vector<Array> arrays; // image nula = slot livre
+};
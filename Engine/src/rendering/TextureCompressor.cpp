@@ -0,0 +1,391 @@
+#include "TextureCompressor.h"
+#include "../core/CpuProfiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    // Bits gravados a partir do bit menos significativo do byte 0 (ordem do BC7)
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(uint8_t *out) : out(out) { memset(out, 0, 16); }
+
+        void write(uint32_t value, uint32_t bits)
+        {
+            for (uint32_t i = 0; i < bits; i++, position++)
+            {
+                if (value & (1u << i))
+                    out[position / 8] |= static_cast<uint8_t>(1u << (position % 8));
+            }
+        }
+
+    private:
+        uint8_t *out;
+        uint32_t position = 0;
+    };
+
+    // Texels de um bloco, com clamp nas bordas
+    void loadBlock(const uint8_t *pixels, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY,
+                   uint8_t block[16][4])
+    {
+        for (uint32_t y = 0; y < 4; y++)
+        {
+            uint32_t py = std::min(blockY * 4 + y, height - 1);
+            for (uint32_t x = 0; x < 4; x++)
+            {
+                uint32_t px = std::min(blockX * 4 + x, width - 1);
+                memcpy(block[y * 4 + x], pixels + (static_cast<size_t>(py) * width + px) * 4, 4);
+            }
+        }
+    }
+
+    // Eixo principal (iteração de potência na covariância) e extremos das projeções sobre ele
+    template <int N>
+    void fitEndpoints(const uint8_t block[16][4], float minPoint[N], float maxPoint[N])
+    {
+        float mean[N] = {};
+        for (int i = 0; i < 16; i++)
+            for (int c = 0; c < N; c++)
+                mean[c] += block[i][c] / 16.0f;
+
+        float covariance[N][N] = {};
+        for (int i = 0; i < 16; i++)
+            for (int a = 0; a < N; a++)
+                for (int b = 0; b < N; b++)
+                    covariance[a][b] += (block[i][a] - mean[a]) * (block[i][b] - mean[b]);
+
+        float axis[N];
+        for (int c = 0; c < N; c++)
+            axis[c] = 1.0f;
+        for (int iteration = 0; iteration < 8; iteration++)
+        {
+            float next[N] = {};
+            for (int a = 0; a < N; a++)
+                for (int b = 0; b < N; b++)
+                    next[a] += covariance[a][b] * axis[b];
+
+            float length = 0.0f;
+            for (int c = 0; c < N; c++)
+                length = std::max(length, std::fabs(next[c]));
+            if (length < 1e-6f)
+                break;
+            for (int c = 0; c < N; c++)
+                axis[c] = next[c] / length;
+        }
+
+        float minT = 0.0f, maxT = 0.0f;
+        for (int i = 0; i < 16; i++)
+        {
+            float t = 0.0f;
+            for (int c = 0; c < N; c++)
+                t += (block[i][c] - mean[c]) * axis[c];
+            minT = i == 0 ? t : std::min(minT, t);
+            maxT = i == 0 ? t : std::max(maxT, t);
+        }
+
+        float axisLength2 = 0.0f;
+        for (int c = 0; c < N; c++)
+            axisLength2 += axis[c] * axis[c];
+        if (axisLength2 > 0.0f)
+        {
+            minT /= axisLength2;
+            maxT /= axisLength2;
+        }
+
+        for (int c = 0; c < N; c++)
+        {
+            minPoint[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+            maxPoint[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+        }
+    }
+
+    uint16_t packRgb565(const float color[3])
+    {
+        uint32_t r = static_cast<uint32_t>(color[0] * 31.0f / 255.0f + 0.5f);
+        uint32_t g = static_cast<uint32_t>(color[1] * 63.0f / 255.0f + 0.5f);
+        uint32_t b = static_cast<uint32_t>(color[2] * 31.0f / 255.0f + 0.5f);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void unpackRgb565(uint16_t packed, int color[3])
+    {
+        int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    // Bloco de cor BC1 no modo de 4 cores (também a metade de cor do BC3)
+    void encodeColorBlock(const uint8_t block[16][4], uint8_t *out)
+    {
+        float minColor[3], maxColor[3];
+        fitEndpoints<3>(block, minColor, maxColor);
+
+        uint16_t color0 = packRgb565(maxColor);
+        uint16_t color1 = packRgb565(minColor);
+        if (color0 < color1)
+            std::swap(color0, color1);
+
+        uint32_t indices = 0;
+        if (color0 != color1)
+        {
+            int palette[4][3];
+            unpackRgb565(color0, palette[0]);
+            unpackRgb565(color1, palette[1]);
+            for (int c = 0; c < 3; c++)
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+
+            for (int i = 0; i < 16; i++)
+            {
+                int best = 0, bestError = INT32_MAX;
+                for (int p = 0; p < 4; p++)
+                {
+                    int error = 0;
+                    for (int c = 0; c < 3; c++)
+                    {
+                        int d = block[i][c] - palette[p][c];
+                        error += d * d;
+                    }
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        best = p;
+                    }
+                }
+                indices |= static_cast<uint32_t>(best) << (i * 2);
+            }
+        }
+
+        out[0] = static_cast<uint8_t>(color0);
+        out[1] = static_cast<uint8_t>(color0 >> 8);
+        out[2] = static_cast<uint8_t>(color1);
+        out[3] = static_cast<uint8_t>(color1 >> 8);
+        memcpy(out + 4, &indices, 4);
+    }
+
+    // Um canal, modo de 8 valores (BC4; alpha do BC3; cada metade do BC5)
+    void encodeChannelBlock(const uint8_t block[16][4], int channel, uint8_t *out)
+    {
+        int high = 0, low = 255;
+        for (int i = 0; i < 16; i++)
+        {
+            high = std::max(high, static_cast<int>(block[i][channel]));
+            low = std::min(low, static_cast<int>(block[i][channel]));
+        }
+
+        out[0] = static_cast<uint8_t>(high);
+        out[1] = static_cast<uint8_t>(low);
+
+        uint64_t indices = 0;
+        if (high != low)
+        {
+            int palette[8] = {high, low};
+            for (int p = 1; p < 7; p++)
+                palette[p + 1] = ((7 - p) * high + p * low) / 7;
+
+            for (int i = 0; i < 16; i++)
+            {
+                int best = 0, bestError = INT32_MAX;
+                for (int p = 0; p < 8; p++)
+                {
+                    int error = std::abs(block[i][channel] - palette[p]);
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        best = p;
+                    }
+                }
+                indices |= static_cast<uint64_t>(best) << (i * 3);
+            }
+        }
+
+        for (int b = 0; b < 6; b++)
+            out[2 + b] = static_cast<uint8_t>(indices >> (b * 8));
+    }
+
+    // Endpoint de 7 bits por canal + p-bit compartilhado: o p-bit que erra menos
+    void quantizeMode6Endpoint(const float endpoint[4], int quantized[4], int &pBit, int restored[4])
+    {
+        int bestError = INT32_MAX;
+        for (int p = 0; p < 2; p++)
+        {
+            int candidate[4], error = 0;
+            for (int c = 0; c < 4; c++)
+            {
+                candidate[c] = std::clamp(static_cast<int>(std::lround((endpoint[c] - p) / 2.0f)), 0, 127);
+                int d = ((candidate[c] << 1) | p) - static_cast<int>(endpoint[c] + 0.5f);
+                error += d * d;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                pBit = p;
+                for (int c = 0; c < 4; c++)
+                {
+                    quantized[c] = candidate[c];
+                    restored[c] = (candidate[c] << 1) | p;
+                }
+            }
+        }
+    }
+
+    void encodeBc7Mode6(const uint8_t block[16][4], uint8_t *out)
+    {
+        static const int WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+        float endpoints[2][4];
+        fitEndpoints<4>(block, endpoints[0], endpoints[1]);
+
+        int quantized[2][4], restored[2][4], pBits[2];
+        for (int e = 0; e < 2; e++)
+            quantizeMode6Endpoint(endpoints[e], quantized[e], pBits[e], restored[e]);
+
+        int palette[16][4];
+        for (int w = 0; w < 16; w++)
+            for (int c = 0; c < 4; c++)
+                palette[w][c] = ((64 - WEIGHTS[w]) * restored[0][c] + WEIGHTS[w] * restored[1][c] + 32) >> 6;
+
+        int indices[16];
+        for (int i = 0; i < 16; i++)
+        {
+            int best = 0, bestError = INT32_MAX;
+            for (int w = 0; w < 16; w++)
+            {
+                int error = 0;
+                for (int c = 0; c < 4; c++)
+                {
+                    int d = block[i][c] - palette[w][c];
+                    error += d * d;
+                }
+                if (error < bestError)
+                {
+                    bestError = error;
+                    best = w;
+                }
+            }
+            indices[i] = best;
+        }
+
+        // O índice do texel 0 tem o bit mais alto implícito em 0: se precisar dele, troca os endpoints
+        if (indices[0] >= 8)
+        {
+            std::swap(quantized[0], quantized[1]);
+            std::swap(pBits[0], pBits[1]);
+            for (int &index : indices)
+                index = 15 - index;
+        }
+
+        BitWriter writer(out);
+        writer.write(1u << 6, 7); // modo 6
+        for (int c = 0; c < 4; c++)
+        {
+            writer.write(quantized[0][c], 7);
+            writer.write(quantized[1][c], 7);
+        }
+        writer.write(pBits[0], 1);
+        writer.write(pBits[1], 1);
+        writer.write(indices[0], 3);
+        for (int i = 1; i < 16; i++)
+            writer.write(indices[i], 4);
+    }
+}
+
+bool TextureCompressor::IsSupported(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool TextureCompressor::IsCompressed(VkFormat format)
+{
+    return format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK;
+}
+
+uint32_t TextureCompressor::BlockSize(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+    case VK_FORMAT_BC4_SNORM_BLOCK:
+        return 8;
+    default:
+        return 16;
+    }
+}
+
+VkDeviceSize TextureCompressor::LevelSize(VkFormat format, uint32_t width, uint32_t height)
+{
+    return static_cast<VkDeviceSize>((width + 3) / 4) * ((height + 3) / 4) * BlockSize(format);
+}
+
+std::vector<uint8_t> TextureCompressor::Compress(VkFormat format, const uint8_t *pixels, uint32_t width, uint32_t height)
+{
+    PROFILE_ZONE("TextureCompressor::Compress");
+
+    if (!IsSupported(format))
+    {
+        throw std::runtime_error("unsupported block compression format!");
+    }
+
+    const uint32_t blocksX = (width + 3) / 4;
+    const uint32_t blocksY = (height + 3) / 4;
+    const uint32_t blockSize = BlockSize(format);
+    std::vector<uint8_t> output(static_cast<size_t>(blocksX) * blocksY * blockSize);
+
+    uint8_t block[16][4];
+    for (uint32_t by = 0; by < blocksY; by++)
+    {
+        for (uint32_t bx = 0; bx < blocksX; bx++)
+        {
+            loadBlock(pixels, width, height, bx, by, block);
+            uint8_t *out = output.data() + (static_cast<size_t>(by) * blocksX + bx) * blockSize;
+
+            switch (format)
+            {
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                encodeColorBlock(block, out);
+                break;
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+                encodeChannelBlock(block, 3, out);
+                encodeColorBlock(block, out + 8);
+                break;
+            case VK_FORMAT_BC4_UNORM_BLOCK:
+                encodeChannelBlock(block, 0, out);
+                break;
+            case VK_FORMAT_BC5_UNORM_BLOCK:
+                encodeChannelBlock(block, 0, out);
+                encodeChannelBlock(block, 1, out + 8);
+                break;
+            default:
+                encodeBc7Mode6(block, out);
+                break;
+            }
+        }
+    }
+
+    return output;
+}
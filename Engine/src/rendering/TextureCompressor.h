@@ -0,0 +1,20 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+// Codificadores de blocos 4x4 (BCn) a partir de RGBA8. Rápidos, não ótimos: endpoints pelo eixo principal
+// das cores do bloco e índices pelo mais próximo. BC7 usa só o modo 6 (um subset, RGBA, índices de 4 bits).
+class TextureCompressor
+{
+public:
+    // Formatos aceitos por Compress (as variantes SRGB/UNORM só mudam a decodificação)
+    static bool IsSupported(VkFormat format);
+    static bool IsCompressed(VkFormat format);
+    // Bytes de um bloco 4x4
+    static uint32_t BlockSize(VkFormat format);
+    static VkDeviceSize LevelSize(VkFormat format, uint32_t width, uint32_t height);
+
+    // Imagem inteira; blocos das bordas repetem o último texel
+    static std::vector<uint8_t> Compress(VkFormat format, const uint8_t *pixels, uint32_t width, uint32_t height);
+};
@@ -4,72 +4,881 @@
 #include "../core/VulkanDescriptor.h"
 #include "../core/VulkanPipeline.h" 
 #include "../core/VulkanSwapChain.h"
+#include "../core/VulkanUploadContext.h"
+#include "../core/VulkanResidency.h"
+#include "../core/VulkanDeletionQueue.h"
+#include "../core/WorkerPool.h"
+#include "../core/CpuProfiler.h"
+#include "../core/RenderCounters.h"
+#include "../core/VulkanBindless.h"
+#include "../ecs/components/MaterialComponent.h"
+#include "../VulkanRenderer.h"
+#include "MipmapGenerator.h"
+#include "TextureCompressor.h"
+#include "Ktx2File.h"
 
 #include <stb_image.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 
-TextureManager::TextureManager(VulkanCore* core) : vulkanCore(core) {}
+namespace {
+    // Cor média: é o que fica na GPU enquanto a textura estiver despejada
+    std::array<uint8_t, 4> averageColorOf(const uint8_t* pixels, uint32_t width, uint32_t height) {
+        std::array<uint64_t, 4> sum{};
+        const uint64_t pixelCount = static_cast<uint64_t>(width) * height;
+        for (uint64_t i = 0; i < pixelCount * 4; i += 4) {
+            for (int c = 0; c < 4; c++) {
+                sum[c] += pixels[i + c];
+            }
+        }
+        std::array<uint8_t, 4> average{};
+        for (int c = 0; c < 4; c++) {
+            average[c] = static_cast<uint8_t>(sum[c] / pixelCount);
+        }
+        return average;
+    }
+
+    bool formatMatchesUsage(VkFormat format, TextureUsage usage) {
+        switch (usage) {
+        case TextureUsage::Normal:
+            return format == VK_FORMAT_BC5_UNORM_BLOCK;
+        case TextureUsage::Data:
+            return format == VK_FORMAT_BC7_UNORM_BLOCK;
+        default:
+            return format == VK_FORMAT_BC1_RGB_SRGB_BLOCK || format == VK_FORMAT_BC7_SRGB_BLOCK;
+        }
+    }
+
+    TextureUsage usageOf(VkFormat format) {
+        if (format == VK_FORMAT_BC5_UNORM_BLOCK) {
+            return TextureUsage::Normal;
+        }
+        return format == VK_FORMAT_BC7_UNORM_BLOCK ? TextureUsage::Data : TextureUsage::Color;
+    }
+
+    // Enquanto carrega: branco na cor, normal para cima, AO 1 / roughness 0.5 / metal 0 nos dados
+    std::array<uint8_t, 4> placeholderColor(TextureUsage usage) {
+        switch (usage) {
+        case TextureUsage::Normal:
+            return {128, 128, 255, 255};
+        case TextureUsage::Data:
+            return {255, 128, 0, 255};
+        default:
+            return {255, 255, 255, 255};
+        }
+    }
+
+    // FNV-1a de 64 bits do arquivo inteiro; 0 se não der para ler
+    uint64_t hashFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return 0;
+        }
+
+        uint64_t hash = 1469598103934665603ull;
+        std::vector<char> buffer(1 << 16);
+        while (file) {
+            file.read(buffer.data(), buffer.size());
+            const std::streamsize count = file.gcount();
+            for (std::streamsize i = 0; i < count; i++) {
+                hash = (hash ^ static_cast<uint8_t>(buffer[i])) * 1099511628211ull;
+            }
+        }
+        return hash;
+    }
+
+    // Sufixo do .ktx2 e da chave do cache; cor fica sem, como antes
+    const char* usageSuffix(TextureUsage usage) {
+        switch (usage) {
+        case TextureUsage::Normal:
+            return ".normal";
+        case TextureUsage::Data:
+            return ".data";
+        default:
+            return "";
+        }
+    }
+
+    // O mesmo arquivo como cor e como dado vira formatos diferentes: o uso entra na chave
+    uint64_t contentKey(uint64_t hash, TextureUsage usage) {
+        return hash ^ ((static_cast<uint64_t>(usage) + 1) * 0x9E3779B97F4A7C15ull);
+    }
+
+    // O cook produz a cadeia inteira: descarta os níveis maiores que maxDimension
+    void keepLevelsUpTo(Ktx2Image& image, uint32_t maxDimension) {
+        const uint32_t firstLevel = Ktx2File::FirstLevelFor(image.width, image.height, image.levelCount, maxDimension);
+        if (firstLevel == image.firstLevel) {
+            return;
+        }
+
+        const uint32_t skipped = firstLevel - image.firstLevel;
+        const VkDeviceSize start = image.levelOffsets[skipped];
+        image.data.erase(image.data.begin(), image.data.begin() + start);
+        image.levelOffsets.erase(image.levelOffsets.begin(), image.levelOffsets.begin() + skipped);
+        for (VkDeviceSize& offset : image.levelOffsets) {
+            offset -= start;
+        }
+        image.firstLevel = firstLevel;
+    }
+
+    // O 1x1 de uma textura comprimida despejada é RGBA8 no mesmo espaço de cor
+    VkFormat uncompressedFormat(VkFormat format) {
+        if (!TextureCompressor::IsCompressed(format)) {
+            return format;
+        }
+        return usageOf(format) == TextureUsage::Color ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+TextureManager::TextureManager(VulkanCore* core)
+    : vulkanCore(core), arrays(std::make_unique<TextureArrayPool>(*core)),
+      workers(std::make_unique<WorkerPool>("Texture decode")) {}
 
 TextureManager::~TextureManager() {
     cleanup();
 }
 
 void TextureManager::cleanup() {
+    // Workers primeiro: nenhuma carga termina depois daqui
+    workers.reset();
+
+    // Os arrays só saem com a fila executada; na segunda chamada (destrutor) já estão vazios
+    if (arrays && arrays->getStats().arrayCount > 0) {
+        vkDeviceWaitIdle(vulkanCore->getDevice());
+        if (VulkanDeletionQueue* deletionQueue = vulkanCore->getDeletionQueue()) {
+            deletionQueue->flush();
+        }
+        arrays->cleanup();
+    }
+
+    finishedLoads.clear();
     textureCache.clear();
+    pathAliases.clear();
+    contentIndex.clear();
+}
+
+std::string TextureManager::CanonicalPath(const std::string& path)
+{
+    // weakly_canonical resolve "..", "." e links mesmo se o arquivo não existir
+    std::error_code error;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+    if (error) {
+        canonical = std::filesystem::path(path).lexically_normal();
+    }
+    return canonical.generic_string();
 }
 
-std::shared_ptr<Texture> TextureManager::loadTexture(const std::string& path) 
+std::string TextureManager::CookedPath(const std::string& path, TextureUsage usage)
 {
-    std::cout << "\nLoading texture: " << path << std::endl;
+    return path + usageSuffix(usage) + ".ktx2";
+}
+
+std::string TextureManager::CacheKey(const std::string& canonicalPath, TextureUsage usage)
+{
+    return canonicalPath + usageSuffix(usage);
+}
+
+std::shared_ptr<Texture> TextureManager::loadTexture(const std::string& path, TextureUsage usage)
+{
+    PROFILE_ZONE("TextureManager::loadTexture");
+
+    // Verifica se a textura já está carregada (ou carregando), por este caminho ou por outro com o mesmo conteúdo
+    const std::string sourcePath = CanonicalPath(path);
+    std::string key = CacheKey(sourcePath, usage);
+    auto alias = pathAliases.find(key);
+    if (alias != pathAliases.end()) {
+        key = alias->second;
+    }
 
-    // Verifica se a textura já está carregada
-    auto it = textureCache.find(path);
+    auto it = textureCache.find(key);
     if (it != textureCache.end()) {
+        cacheStats.hits++;
+        if (VulkanResidency* residency = vulkanCore->getResidency()) {
+            it->second->lastUsedFrame = residency->getFrame();
+        }
         return it->second;
     }
+    cacheStats.misses++;
+
+    std::cout << "\nLoading texture: " << sourcePath << std::endl;
+
+    auto texture = std::make_shared<Texture>();
+    texture->sourcePath = sourcePath;
+    texture->format = usage == TextureUsage::Color ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    texture->averageColor = placeholderColor(usage);
+    createTextureImage(*texture, texture->averageColor.data(), 4, 1, 1, texture->format);
+    texture->width = 1;
+    texture->height = 1;
+    texture->loading = true;
+    if (VulkanResidency* residency = vulkanCore->getResidency()) {
+        texture->lastUsedFrame = residency->getFrame();
+    }
+    createSampler(*texture);
+    textureCache[key] = texture;
+
+    auto load = std::make_shared<PendingLoad>();
+    load->texture = texture;
+    load->path = sourcePath;
+    load->key = key;
+    load->usage = usage;
+    load->mipmaps = mipmapsEnabled;
+    load->compressed = isCompressionSupported();
+    load->pack = packingEnabled;
+    // Com streaming, só os níveis pequenos; requestMips pede o resto quando a textura aparecer
+    load->maxDimension = load->compressed && streamingSettings.enabled ? streamingSettings.baseSize : 0;
+    loadProgress.requested++;
+
+    workers->submit([this, load] {
+        decodeTexture(*load);
+        std::lock_guard<std::mutex> lock(finishedMutex);
+        finishedLoads.push_back(load);
+    });
+
+    return texture;
+}
+
+void TextureManager::decodeTexture(PendingLoad& load)
+{
+    PROFILE_ZONE("TextureManager::decodeTexture");
+
+    try {
+        if (load.stream) {
+            load.failed = !Ktx2File::Read(CookedPath(load.path, load.usage), load.image, load.maxDimension);
+            return;
+        }
+
+        // Da fonte ou, distribuída só com o .ktx2, do cache em disco
+        load.contentHash = hashFile(load.path);
+        if (load.contentHash == 0) {
+            load.contentHash = hashFile(CookedPath(load.path, load.usage));
+        }
+
+        if (load.compressed) {
+            load.failed = !prepareCompressed(load.path, load.usage, load.mipmaps, load.image, load.maxDimension);
+
+            // Pequena o bastante para um array: a cadeia inteira, sem streaming
+            Ktx2Image& image = load.image;
+            if (!load.failed && load.pack && image.firstLevel > 0 &&
+                std::max(image.width, image.height) <= PACK_MAX_SIZE) {
+                Ktx2Image full;
+                if (Ktx2File::Read(CookedPath(load.path, load.usage), full)) {
+                    image = std::move(full);
+                }
+            }
+            return;
+        }
+
+        // Carrega a imagem usando stb_image
+        int width, height, channels;
+        stbi_uc* pixels = stbi_load(load.path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels) {
+            load.failed = true;
+            return;
+        }
+
+        const size_t imageSize = static_cast<size_t>(width) * height * 4;
+        load.image.format = load.usage == TextureUsage::Color ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+        load.image.width = width;
+        load.image.height = height;
+        load.image.data.assign(pixels, pixels + imageSize);
+        load.image.levelOffsets = {0};
+        load.image.averageColor = averageColorOf(pixels, width, height);
+        stbi_image_free(pixels);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        load.failed = true;
+    }
+}
+
+void TextureManager::update()
+{
+    PROFILE_ZONE("TextureManager::update");
+
+    std::vector<std::shared_ptr<PendingLoad>> finished;
+    {
+        std::lock_guard<std::mutex> lock(finishedMutex);
+        finished.swap(finishedLoads);
+    }
+
+    for (const std::shared_ptr<PendingLoad>& load : finished) {
+        if (load->stream) {
+            finishStreamJob(*load);
+            continue;
+        }
+
+        Texture& texture = *load->texture;
+        texture.loading = false;
+
+        if (load->failed) {
+            // Fica com o placeholder de vez, fora do despejo
+            std::cerr << "Failed to load texture image: " << load->path << std::endl;
+            texture.sourcePath.clear();
+            loadProgress.failed++;
+            continue;
+        }
+
+        // Mesmo conteúdo já no cache por outro caminho: os materiais trocam para ela e esta sai. Se alguém
+        // além dos materiais segura esta (cache + carga = 2), ela fica e segue como uma textura normal.
+        if (load->contentHash != 0) {
+            const uint64_t content = contentKey(load->contentHash, load->usage);
+            auto duplicate = contentIndex.find(content);
+            auto existing = duplicate != contentIndex.end() ? textureCache.find(duplicate->second) : textureCache.end();
+            if (existing != textureCache.end() && existing->second != load->texture) {
+                replaceInMaterials(load->texture, existing->second);
+                if (load->texture.use_count() <= 2) {
+                    pathAliases[load->key] = duplicate->second;
+                    dropTexture(load->key);
+                    cacheStats.contentHits++;
+                    loadProgress.completed++;
+                    continue;
+                }
+            } else {
+                contentIndex[content] = load->key;
+            }
+        }
+
+        // O placeholder pode estar no frame em voo
+        VulkanDeletionQueue* deletionQueue = vulkanCore->getDeletionQueue();
+        deletionQueue->destroyImageView(texture.imageView);
+        deletionQueue->destroyImage(texture.image, texture.imageMemory);
+
+        const Ktx2Image& image = load->image;
+        const bool packed = load->pack && image.firstLevel == 0 && canPack(image.width, image.height, image.format);
+        if (packed) {
+            packTexture(texture, image);
+        } else if (load->compressed) {
+            createCompressedImage(texture, image);
+        } else {
+            createTextureImage(texture, image.data.data(), image.data.size(), image.width, image.height, image.format);
+        }
+        texture.width = image.width;
+        texture.height = image.height;
+        texture.format = image.format;
+        texture.averageColor = image.averageColor;
+        texture.streamed = !packed && load->maxDimension > 0 && image.levelCount > 1;
+        texture.mipNeededFrame = streamingFrame;
+
+        if (VulkanResidency* residency = vulkanCore->getResidency()) {
+            residency->refreshTexture(texture);
+        }
+        loadProgress.completed++;
+    }
+    finished.clear();
+
+    trimCache();
+    updateStreaming();
+}
+
+VkDeviceSize TextureManager::textureBytes(const Texture& texture) const
+{
+    if (!texture.isPacked()) {
+        return texture.imageMemory.size;
+    }
+
+    // A camada não tem alocação própria: o tamanho da cadeia dela
+    VkDeviceSize size = 0;
+    for (uint32_t level = 0; level < texture.mipLevels; level++) {
+        const uint32_t width = std::max(1u, texture.width >> level);
+        const uint32_t height = std::max(1u, texture.height >> level);
+        size += TextureCompressor::IsCompressed(texture.format) ? TextureCompressor::LevelSize(texture.format, width, height)
+                                                                : static_cast<VkDeviceSize>(width) * height * 4;
+    }
+    return size;
+}
+
+void TextureManager::trimCache()
+{
+    PROFILE_ZONE("TextureManager::trimCache");
+
+    // Referência viva = qualquer shared_ptr além do do cache (materiais, cargas, recargas do VulkanResidency)
+    std::vector<std::pair<uint64_t, std::string>> unreferenced;
+    cacheStats.textures = static_cast<uint32_t>(textureCache.size());
+    cacheStats.referenced = 0;
+    cacheStats.bytes = 0;
+    for (const auto& [key, texture] : textureCache) {
+        cacheStats.bytes += textureBytes(*texture);
+        if (texture.use_count() > 1) {
+            cacheStats.referenced++;
+        } else {
+            unreferenced.emplace_back(texture->lastUsedFrame, key);
+        }
+    }
+
+    if (cacheStats.bytes <= cacheBudget) {
+        return;
+    }
+
+    std::sort(unreferenced.begin(), unreferenced.end());
+    for (const auto& [lastUsedFrame, key] : unreferenced) {
+        if (cacheStats.bytes <= cacheBudget) {
+            break;
+        }
+
+        cacheStats.bytes -= std::min(cacheStats.bytes, textureBytes(*textureCache[key]));
+        dropTexture(key);
+        cacheStats.textures--;
+        cacheStats.evictions++;
+    }
+}
+
+void TextureManager::dropTexture(const std::string& key)
+{
+    auto it = textureCache.find(key);
+    if (it == textureCache.end()) {
+        return;
+    }
+
+    std::shared_ptr<Texture> texture = it->second;
+    textureCache.erase(it);
+
+    // Caminhos e hashes que levavam a ela passam a carregar de novo
+    for (auto alias = pathAliases.begin(); alias != pathAliases.end();) {
+        alias = alias->second == key ? pathAliases.erase(alias) : std::next(alias);
+    }
+    for (auto content = contentIndex.begin(); content != contentIndex.end();) {
+        content = content->second == key ? contentIndex.erase(content) : std::next(content);
+    }
+
+    // O frame em voo pode ter amostrado a imagem
+    if (VulkanBindless* bindless = vulkanCore->getBindless()) {
+        bindless->releaseTexture(*texture);
+    }
+    if (texture->isPacked()) {
+        arrays->release(*texture);
+    } else {
+        VulkanDeletionQueue* deletionQueue = vulkanCore->getDeletionQueue();
+        deletionQueue->destroyImageView(texture->imageView);
+        deletionQueue->destroyImage(texture->image, texture->imageMemory);
+    }
+    texture->sampler = VK_NULL_HANDLE;
+}
+
+void TextureManager::replaceInMaterials(const std::shared_ptr<Texture>& from, const std::shared_ptr<Texture>& to)
+{
+    Scene* scene = vulkanCore->getScene();
+    if (!scene) {
+        return;
+    }
+
+    VulkanBindless* bindless = vulkanCore->getBindless();
+    EngineModelLoader* modelLoader = VulkanRenderer::getInstance().getModelLoader();
+    scene->forEachEntity([&](const std::shared_ptr<Entity>& entity) {
+        if (!entity->hasComponent<MaterialComponent>()) {
+            return;
+        }
+
+        auto& material = entity->getComponent<MaterialComponent>();
+        bool changed = false;
+        for (std::shared_ptr<Texture>* map : {&material.albedoMap, &material.normalMap, &material.metallicRoughnessMap,
+                                              &material.aoMap, &material.emissiveMap}) {
+            if (*map == from) {
+                *map = to;
+                changed = true;
+            }
+        }
+
+        if (!changed) {
+            return;
+        }
+        if (bindless && bindless->isEnabled()) {
+            bindless->updateMaterial(material);
+        } else {
+            modelLoader->RefreshMaterialDescriptors(material);
+        }
+    });
+}
+
+void TextureManager::requestMips(const MaterialComponent& material, float uvPerPixel)
+{
+    for (const auto* map : {&material.albedoMap, &material.normalMap, &material.metallicRoughnessMap,
+                            &material.aoMap, &material.emissiveMap}) {
+        Texture* texture = map->get();
+        if (!texture || !texture->streamed) {
+            continue;
+        }
+
+        // Nível cujo texel cobre no máximo um pixel: log2 de texels por pixel no nível 0
+        uint32_t mip = 0;
+        if (uvPerPixel > 0.0f) {
+            const float level = std::log2(std::max(texture->width, texture->height) * uvPerPixel) + streamingSettings.mipBias;
+            if (level > 0.0f) {
+                mip = std::min(static_cast<uint32_t>(level), texture->fullMipLevels - 1);
+            }
+        }
+        texture->requestedMip = std::min(texture->requestedMip, mip);
+    }
+}
+
+uint32_t TextureManager::baseMip(const Texture& texture) const
+{
+    return Ktx2File::FirstLevelFor(texture.width, texture.height, texture.fullMipLevels, streamingSettings.baseSize);
+}
+
+VkDeviceSize TextureManager::streamedSize(const Texture& texture, uint32_t firstMip) const
+{
+    VkDeviceSize size = 0;
+    for (uint32_t level = firstMip; level < texture.fullMipLevels; level++) {
+        size += TextureCompressor::LevelSize(texture.format, std::max(1u, texture.width >> level),
+                                             std::max(1u, texture.height >> level));
+    }
+    return size;
+}
+
+void TextureManager::updateStreaming()
+{
+    PROFILE_ZONE("TextureManager::updateStreaming");
+
+    struct Candidate {
+        std::shared_ptr<Texture> texture;
+        uint32_t mip;
+    };
+    std::vector<Candidate> upgrades;
+    std::vector<Candidate> downgrades;
+
+    streamingFrame++;
+    streamingStats.streamedTextures = 0;
+    streamingStats.starvedTextures = 0;
+    streamingStats.residentBytes = 0;
+    streamingStats.requestedBytes = 0;
+
+    for (const auto& [path, texture] : textureCache) {
+        if (!texture->streamed) {
+            continue;
+        }
+
+        // Sem pedido no frame (fora da tela): só o piso
+        const uint32_t floorMip = baseMip(*texture);
+        const uint32_t wanted = std::min(texture->requestedMip, floorMip);
+        texture->requestedMip = UINT32_MAX;
+
+        streamingStats.streamedTextures++;
+        if (!texture->evicted) {
+            streamingStats.residentBytes += streamedSize(*texture, texture->residentMip);
+        }
+        streamingStats.requestedBytes += streamedSize(*texture, wanted);
+        if (wanted <= texture->residentMip) {
+            texture->mipNeededFrame = streamingFrame;
+        }
+        if (wanted < texture->residentMip) {
+            streamingStats.starvedTextures++;
+        }
+
+        if (!streamingSettings.enabled || texture->streaming || texture->loading || texture->evicted) {
+            continue;
+        }
+
+        if (wanted < texture->residentMip) {
+            upgrades.push_back({texture, wanted});
+        } else if (wanted > texture->residentMip && streamingFrame - texture->mipNeededFrame > streamingSettings.dropDelayFrames) {
+            downgrades.push_back({texture, wanted});
+        }
+    }
+
+    if (!streamingSettings.enabled) {
+        return;
+    }
+
+    int64_t projected = static_cast<int64_t>(streamingStats.residentBytes) + streamingPendingBytes;
+    const int64_t budget = static_cast<int64_t>(streamingSettings.budget);
+
+    // Acima do orçamento: também desce, um nível por vez, quem está há mais tempo sem pedir o nível residente
+    if (projected > budget) {
+        std::vector<Candidate> idle;
+        for (const auto& [path, texture] : textureCache) {
+            if (texture->streamed && !texture->streaming && !texture->loading && !texture->evicted &&
+                texture->residentMip < baseMip(*texture) && texture->mipNeededFrame < streamingFrame) {
+                idle.push_back({texture, texture->residentMip + 1});
+            }
+        }
+        std::sort(idle.begin(), idle.end(), [](const Candidate& a, const Candidate& b) {
+            return a.texture->mipNeededFrame < b.texture->mipNeededFrame;
+        });
+        for (const Candidate& candidate : idle) {
+            if (std::none_of(downgrades.begin(), downgrades.end(),
+                             [&](const Candidate& d) { return d.texture == candidate.texture; })) {
+                downgrades.push_back(candidate);
+            }
+        }
+    }
+
+    for (const Candidate& candidate : downgrades) {
+        if (streamingStats.jobsInFlight >= streamingSettings.maxJobs) {
+            return;
+        }
+        projected += static_cast<int64_t>(streamedSize(*candidate.texture, candidate.mip)) -
+                     static_cast<int64_t>(streamedSize(*candidate.texture, candidate.texture->residentMip));
+        submitStreamJob(candidate.texture, candidate.mip);
+    }
+
+    // Maior falta primeiro; sem espaço para o nível pedido, tenta os intermediários
+    std::sort(upgrades.begin(), upgrades.end(), [](const Candidate& a, const Candidate& b) {
+        return a.texture->residentMip - a.mip > b.texture->residentMip - b.mip;
+    });
+    for (const Candidate& candidate : upgrades) {
+        if (streamingStats.jobsInFlight >= streamingSettings.maxJobs) {
+            return;
+        }
+
+        const Texture& texture = *candidate.texture;
+        const int64_t current = static_cast<int64_t>(streamedSize(texture, texture.residentMip));
+        for (uint32_t mip = candidate.mip; mip < texture.residentMip; mip++) {
+            const int64_t growth = static_cast<int64_t>(streamedSize(texture, mip)) - current;
+            if (projected + growth <= budget) {
+                projected += growth;
+                submitStreamJob(candidate.texture, mip);
+                break;
+            }
+        }
+    }
+}
+
+void TextureManager::submitStreamJob(const std::shared_ptr<Texture>& texture, uint32_t mip)
+{
+    auto load = std::make_shared<PendingLoad>();
+    load->texture = texture;
+    load->path = texture->sourcePath;
+    load->usage = usageOf(texture->format);
+    load->compressed = true;
+    load->stream = true;
+    load->maxDimension = std::max(texture->width, texture->height) >> mip;
+    load->byteDelta = static_cast<int64_t>(streamedSize(*texture, mip)) -
+                      static_cast<int64_t>(streamedSize(*texture, texture->residentMip));
+
+    texture->streaming = true;
+    streamingPendingBytes += load->byteDelta;
+    streamingStats.jobsInFlight++;
+
+    workers->submit([this, load] {
+        decodeTexture(*load);
+        std::lock_guard<std::mutex> lock(finishedMutex);
+        finishedLoads.push_back(load);
+    });
+}
+
+void TextureManager::finishStreamJob(PendingLoad& load)
+{
+    Texture& texture = *load.texture;
+    texture.streaming = false;
+    streamingPendingBytes -= load.byteDelta;
+    streamingStats.jobsInFlight--;
+
+    // Cache reescrito com outra cadeia (fonte mudou): para o streaming e fica com o que tem
+    const Ktx2Image& image = load.image;
+    if (load.failed || image.format != texture.format || image.levelCount != texture.fullMipLevels ||
+        image.width != texture.width || image.height != texture.height) {
+        std::cerr << "Failed to stream texture: " << load.path << std::endl;
+        texture.streamed = false;
+        return;
+    }
+
+    // A imagem atual pode estar no frame em voo
+    VulkanDeletionQueue* deletionQueue = vulkanCore->getDeletionQueue();
+    deletionQueue->destroyImageView(texture.imageView);
+    deletionQueue->destroyImage(texture.image, texture.imageMemory);
+
+    const uint32_t previousMip = texture.residentMip;
+    createCompressedImage(texture, image);
+    if (texture.residentMip < previousMip) {
+        streamingStats.upgrades++;
+    } else {
+        streamingStats.downgrades++;
+    }
+
+    if (VulkanResidency* residency = vulkanCore->getResidency()) {
+        residency->refreshTexture(texture);
+    }
+}
+
+uint32_t TextureManager::getWorkerCount() const
+{
+    return workers ? workers->getThreadCount() : 0;
+}
+
+void TextureManager::waitForLoads()
+{
+    workers->waitIdle();
+    update();
+}
+
+bool TextureManager::isCompressionSupported() const
+{
+    return vulkanCore->getEnabledFeatures().textureCompressionBC == VK_TRUE;
+}
+
+bool TextureManager::prepareCompressed(const std::string& path, TextureUsage usage, bool mipmaps, Ktx2Image& image,
+                                       uint32_t maxDimension)
+{
+    const std::string cookedPath = CookedPath(path, usage);
+
+    // Sem a fonte, um cache existente basta (assets distribuídos só com o .ktx2)
+    std::error_code error;
+    const bool hasSource = std::filesystem::exists(path, error);
+    bool fresh = std::filesystem::exists(cookedPath, error);
+    if (fresh && hasSource) {
+        fresh = std::filesystem::last_write_time(cookedPath, error) >= std::filesystem::last_write_time(path, error) && !error;
+    }
+
+    if (fresh && Ktx2File::Read(cookedPath, image, maxDimension) && formatMatchesUsage(image.format, usage) &&
+        image.levelCount == (mipmaps ? MipmapGenerator::LevelCount(image.width, image.height) : 1)) {
+        cacheHitCount++;
+        return true;
+    }
+
+    if (!hasSource) {
+        return false;
+    }
+
+    cookTexture(path, usage, mipmaps, image);
+    if (!Ktx2File::Write(cookedPath, image)) {
+        // Sem permissão de escrita ao lado do asset: funciona, só recomprime na próxima execução
+        std::cerr << "Failed to write texture cache: " << cookedPath << std::endl;
+    }
+    cookedCount++;
+    keepLevelsUpTo(image, maxDimension);
+    return true;
+}
+
+void TextureManager::cookTexture(const std::string& path, TextureUsage usage, bool mipmaps, Ktx2Image& image)
+{
+    PROFILE_ZONE("TextureManager::cookTexture");
 
-    // Carrega a imagem usando stb_image
     int width, height, channels;
     stbi_uc* pixels = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
-    
     if (!pixels) {
         throw std::runtime_error("Failed to load texture image: " + path);
     }
 
-    VkDeviceSize imageSize = width * height * 4;
-    
-    // Cria a textura
-    auto texture = createTextureFromData(pixels, imageSize, width, height);
-    
-    // Libera os pixels
+    image.width = width;
+    image.height = height;
+    image.averageColor = averageColorOf(pixels, width, height);
+
+    bool hasAlpha = false;
+    for (size_t i = 3; i < static_cast<size_t>(width) * height * 4 && !hasAlpha; i += 4) {
+        hasAlpha = pixels[i] != 255;
+    }
+
+    switch (usage) {
+    case TextureUsage::Normal:
+        image.format = VK_FORMAT_BC5_UNORM_BLOCK;
+        break;
+    case TextureUsage::Data:
+        image.format = VK_FORMAT_BC7_UNORM_BLOCK;
+        break;
+    default:
+        image.format = hasAlpha ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+        break;
+    }
+
+    // Mips filtrados em RGBA8 (cor em espaço linear) e comprimidos nível a nível
+    const uint32_t mipLevels = mipmaps ? MipmapGenerator::LevelCount(width, height) : 1;
+    std::vector<VkDeviceSize> chainOffsets;
+    std::vector<uint8_t> chain = MipmapGenerator::BuildChainRGBA8(pixels, width, height, mipLevels,
+                                                                  usage == TextureUsage::Color, chainOffsets);
     stbi_image_free(pixels);
-    
-    // Cache a textura
-    textureCache[path] = texture;
-    
+
+    image.levelCount = mipLevels;
+    image.firstLevel = 0;
+    image.data.clear();
+    image.levelOffsets.clear();
+    for (uint32_t level = 0; level < mipLevels; level++) {
+        std::vector<uint8_t> blocks = TextureCompressor::Compress(
+            image.format, chain.data() + chainOffsets[level], std::max(1, width >> level), std::max(1, height >> level));
+        image.levelOffsets.push_back(image.data.size());
+        image.data.insert(image.data.end(), blocks.begin(), blocks.end());
+    }
+}
+
+void TextureManager::createCompressedImage(Texture& texture, const Ktx2Image& image)
+{
+    // Leitura parcial: o nível firstLevel vira o nível 0 da imagem
+    const uint32_t width = std::max(1u, image.width >> image.firstLevel);
+    const uint32_t height = std::max(1u, image.height >> image.firstLevel);
+    vulkanCore->validateImageDimensions(width, height);
+
+    const uint32_t mipLevels = static_cast<uint32_t>(image.levelOffsets.size());
+    vulkanCore->createImage(
+        width,
+        height,
+        image.format,
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        texture.image,
+        texture.imageMemory,
+        mipLevels,
+        GpuMemoryCategory::Texture
+    );
+
+    // Blocos copiados como estão: nenhuma decodificação no caminho de carga
+    VulkanUploadContext* uploads = vulkanCore->getUploadContext();
+    uploads->uploadImageLevels(texture.image, width, height, image.data.data(), image.data.size(),
+                               image.levelOffsets);
+    texture.uploadTicket = uploads->getOpenTicket();
+    texture.mipLevels = mipLevels;
+    texture.residentMip = image.firstLevel;
+    texture.fullMipLevels = image.levelCount;
+
+    texture.imageView = vulkanCore->createImageView(texture.image, image.format, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels);
+}
+
+bool TextureManager::canPack(uint32_t width, uint32_t height, VkFormat format) const
+{
+    // RGBA8 precisa dos mips da CPU (MipmapGenerator); BCn já vem com a cadeia
+    return std::max(width, height) <= PACK_MAX_SIZE &&
+           (TextureCompressor::IsCompressed(format) || format == VK_FORMAT_R8G8B8A8_SRGB ||
+            format == VK_FORMAT_R8G8B8A8_UNORM);
+}
+
+void TextureManager::packTexture(Texture& texture, const Ktx2Image& image)
+{
+    if (TextureCompressor::IsCompressed(image.format)) {
+        arrays->pack(texture, image.format, image.width, image.height, image.data.data(), image.data.size(),
+                     image.levelOffsets);
+    } else {
+        // Blit por camada não compensa nesses tamanhos: a cadeia sai da CPU
+        const uint32_t mipLevels = mipmapsEnabled ? MipmapGenerator::LevelCount(image.width, image.height) : 1;
+        std::vector<VkDeviceSize> levelOffsets;
+        std::vector<uint8_t> chain = MipmapGenerator::BuildChainRGBA8(
+            image.data.data(), image.width, image.height, mipLevels, image.format == VK_FORMAT_R8G8B8A8_SRGB, levelOffsets);
+        arrays->pack(texture, image.format, image.width, image.height, chain.data(), chain.size(), levelOffsets);
+    }
+    texture.residentMip = 0;
+    texture.fullMipLevels = texture.mipLevels;
+}
+
+std::shared_ptr<Texture> TextureManager::createTexture(const std::string& name, const void* pixels, uint32_t width,
+                                                       uint32_t height, VkFormat format)
+{
+    auto it = textureCache.find(name);
+    if (it != textureCache.end()) {
+        return it->second;
+    }
+
+    auto texture = createTextureFromData(pixels, static_cast<VkDeviceSize>(width) * height * 4, width, height, format);
+    textureCache[name] = texture;
     return texture;
 }
 
 std::shared_ptr<Texture> TextureManager::createSolidColorTexture(const glm::vec4& color) {
-    const uint32_t width = 1;
-    const uint32_t height = 1;
-    unsigned char data[4];
-    
     // Converte cor float para RGBA 8-bit
-    data[0] = static_cast<unsigned char>(color.r * 255.0f);
-    data[1] = static_cast<unsigned char>(color.g * 255.0f);
-    data[2] = static_cast<unsigned char>(color.b * 255.0f);
-    data[3] = static_cast<unsigned char>(color.a * 255.0f);
-    
-    return createTextureFromData(data, 4, width, height);
+    unsigned char data[4];
+    for (int c = 0; c < 4; c++) {
+        data[c] = static_cast<unsigned char>(std::clamp(color[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "solid:%02x%02x%02x%02x", data[0], data[1], data[2], data[3]);
+    return createTexture(name, data, 1, 1);
 }
 
 std::shared_ptr<Texture> TextureManager::createDefaultNormalTexture() {
-    const uint32_t width = 1;
-    const uint32_t height = 1;
     unsigned char data[4] = {128, 128, 255, 255}; // Normal apontando para cima (0,0,1)
-    
-    return createTextureFromData(data, 4, width, height);
+    return createTexture("default:normal", data, 1, 1, VK_FORMAT_R8G8B8A8_UNORM);
 }
 
 std::shared_ptr<Texture> TextureManager::createTextureFromData(
@@ -79,46 +888,32 @@ std::shared_ptr<Texture> TextureManager::createTextureFromData(
     uint32_t height,
     VkFormat format
 ) {
-    // Validar dimensões antes de criar a textura
-    vulkanCore->validateImageDimensions(width, height);
-    
     auto texture = std::make_shared<Texture>();
+    if (packingEnabled && canPack(width, height, format)) {
+        Ktx2Image image;
+        image.format = format;
+        image.width = width;
+        image.height = height;
+        image.data.assign(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+        image.levelOffsets = {0};
+        packTexture(*texture, image);
+    } else {
+        createTextureImage(*texture, data, size, width, height, format);
+    }
+    texture->width = width;
+    texture->height = height;
+    texture->format = format;
+    if (VulkanResidency* residency = vulkanCore->getResidency()) {
+        texture->lastUsedFrame = residency->getFrame();
+    }
     
-    // Criação do buffer temporário
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    
-    vulkanCore->createBuffer(
-        size,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        stagingBuffer,
-        stagingBufferMemory
-    );
-    
-    // Copia dados para o buffer
-    vulkanCore->copyDataToBuffer(data, stagingBufferMemory, size);
+    createSampler(*texture);
     
-    // Criação da imagem
-    vulkanCore->createImage(
-        width,
-        height,
-        format,
-        VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        texture->image,
-        texture->imageMemory
-    );
+    return texture;
+}
 
-    // Transição de layout e cópia
-    vulkanCore->transitionImageLayout(texture->image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    vulkanCore->copyBufferToImage(stagingBuffer, texture->image, width, height);
-    vulkanCore->transitionImageLayout(texture->image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-    
-    // Criação da image view
-    texture->imageView = vulkanCore->createImageView(texture->image, format, VK_IMAGE_ASPECT_COLOR_BIT);
-    
+void TextureManager::createSampler(Texture& texture)
+{
     // Configuração do sampler
     VkSamplerCreateInfo samplerInfo{};
     samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -135,14 +930,119 @@ std::shared_ptr<Texture> TextureManager::createTextureFromData(
     samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
     samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
     samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = 0.0f;
+    // Sem limite: a imagem troca (placeholder, despejo) e a view de cada uma limita os níveis
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
     samplerInfo.mipLodBias = 0.0f;
 
-    texture->sampler = vulkanCore->createTextureSampler(samplerInfo);
-    
-    // Limpeza dos recursos temporários
-    vkDestroyBuffer(vulkanCore->getDevice(), stagingBuffer, nullptr);
-    vkFreeMemory(vulkanCore->getDevice(), stagingBufferMemory, nullptr);
-    
-    return texture;
-}
\ No newline at end of file
+    texture.sampler = vulkanCore->createTextureSampler(samplerInfo);
+}
+
+void TextureManager::createTextureImage(Texture& texture, const void* data, VkDeviceSize size,
+                                        uint32_t width, uint32_t height, VkFormat format)
+{
+    // Validar dimensões antes de criar a textura
+    vulkanCore->validateImageDimensions(width, height);
+
+    uint32_t mipLevels = mipmapsEnabled ? MipmapGenerator::LevelCount(width, height) : 1;
+    bool gpuMips = mipLevels > 1 && vulkanCore->supportsLinearBlit(format);
+    bool cpuMips = mipLevels > 1 && !gpuMips &&
+                   (format == VK_FORMAT_R8G8B8A8_SRGB || format == VK_FORMAT_R8G8B8A8_UNORM);
+    if (!gpuMips && !cpuMips) {
+        mipLevels = 1;
+    }
+
+    // Criação da imagem
+    vulkanCore->createImage(
+        width,
+        height,
+        format,
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        texture.image,
+        texture.imageMemory,
+        mipLevels,
+        GpuMemoryCategory::Texture
+    );
+
+    // Cópia, blits e transições entram no lote de uploads; o lote é submetido antes do próximo frame
+    VulkanUploadContext* uploads = vulkanCore->getUploadContext();
+    if (gpuMips) {
+        uploads->uploadImageGenerateMips(texture.image, width, height, data, size, mipLevels);
+    } else if (cpuMips) {
+        std::vector<VkDeviceSize> levelOffsets;
+        std::vector<uint8_t> chain = MipmapGenerator::BuildChainRGBA8(
+            static_cast<const uint8_t*>(data), width, height, mipLevels, format == VK_FORMAT_R8G8B8A8_SRGB, levelOffsets);
+        uploads->uploadImageLevels(texture.image, width, height, chain.data(), chain.size(), levelOffsets);
+    } else {
+        uploads->uploadImage(texture.image, width, height, data, size);
+    }
+    texture.uploadTicket = uploads->getOpenTicket();
+    texture.mipLevels = mipLevels;
+
+    // Criação da image view
+    texture.imageView = vulkanCore->createImageView(texture.image, format, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels);
+}
+
+VkDeviceSize TextureManager::evictTexture(Texture& texture)
+{
+    if (texture.evicted || texture.loading || texture.streaming || texture.isPacked() || texture.sourcePath.empty()) {
+        return 0;
+    }
+
+    // Quem chama garante que nenhum frame em voo (nem o lote de uploads) usa a imagem
+    VkDeviceSize freed = texture.imageMemory.size;
+    texture.DestroyImage(vulkanCore->getDevice(), *vulkanCore->getAllocator());
+    createTextureImage(texture, texture.averageColor.data(), 4, 1, 1, uncompressedFormat(texture.format));
+    texture.evicted = true;
+    return freed;
+}
+
+bool TextureManager::restoreTexture(Texture& texture)
+{
+    if (!texture.evicted) {
+        return true;
+    }
+
+    PROFILE_ZONE("TextureManager::restoreTexture");
+
+    if (TextureCompressor::IsCompressed(texture.format)) {
+        // Com streaming volta só o piso; os draws pedem o resto de novo
+        Ktx2Image cooked;
+        const uint32_t maxDimension = texture.streamed ? streamingSettings.baseSize : 0;
+        if (!prepareCompressed(texture.sourcePath, usageOf(texture.format), mipmapsEnabled, cooked, maxDimension)) {
+            // Fonte e cache sumiram: fica com a cor média de vez, fora do despejo
+            std::cerr << "Failed to restore texture: " << texture.sourcePath << std::endl;
+            texture.sourcePath.clear();
+            texture.evicted = false;
+            return false;
+        }
+
+        texture.DestroyImage(vulkanCore->getDevice(), *vulkanCore->getAllocator());
+        createCompressedImage(texture, cooked);
+        texture.width = cooked.width;
+        texture.height = cooked.height;
+        texture.format = cooked.format;
+        texture.evicted = false;
+        return true;
+    }
+
+    int width, height, channels;
+    stbi_uc* pixels = stbi_load(texture.sourcePath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels) {
+        // Arquivo sumiu: fica com a cor média de vez, fora do despejo
+        std::cerr << "Failed to restore texture: " << texture.sourcePath << std::endl;
+        texture.sourcePath.clear();
+        texture.evicted = false;
+        return false;
+    }
+
+    texture.DestroyImage(vulkanCore->getDevice(), *vulkanCore->getAllocator());
+    createTextureImage(texture, pixels, static_cast<VkDeviceSize>(width) * height * 4, width, height, texture.format);
+    stbi_image_free(pixels);
+
+    texture.width = width;
+    texture.height = height;
+    texture.evicted = false;
+    return true;
+}
@@ -1,25 +1,190 @@
 #pragma once
+#include "Ktx2File.h"
+#include "TextureArrayPool.h"
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
 
 // Forward declarations
 class VulkanCore;
+class WorkerPool;
 struct Texture;
+struct MaterialComponent;
+
+// Como a textura é amostrada: decide o formato BCn do cache
+enum class TextureUsage {
+    Color,  // albedo/emissive: sRGB, BC1 (opaca) ou BC7 (com alpha)
+    Normal, // BC5: só XY, o shader reconstrói Z
+    Data    // ORM/AO: linear, BC7
+};
+
+struct TextureLoadProgress {
+    uint32_t requested = 0;
+    uint32_t completed = 0; // imagem real já no lugar do placeholder
+    uint32_t failed = 0;    // ficam com o placeholder
+
+    uint32_t pending() const { return requested - completed - failed; }
+};
+
+// Streaming por mip das texturas comprimidas: a carga traz só os níveis até baseSize e os draws pedem
+// o nível que a tela precisa; o restante entra e sai nos workers dentro do orçamento
+struct TextureStreamingSettings {
+    bool enabled = true;            // vale para as cargas seguintes
+    uint32_t baseSize = 128;        // carga inicial e piso: níveis com o maior lado até isto ficam sempre
+    VkDeviceSize budget = 512ull * 1024 * 1024; // soma das imagens com streaming
+    uint32_t maxJobs = 4;           // leituras de níveis em andamento
+    uint64_t dropDelayFrames = 120; // sem pedir o nível residente por isto, a textura desce
+    float mipBias = 0.0f;           // positivo pede menos detalhe
+};
+
+struct TextureStreamingStats {
+    uint32_t streamedTextures = 0;
+    uint32_t starvedTextures = 0;   // pedem mais detalhe do que está residente
+    uint32_t jobsInFlight = 0;
+    VkDeviceSize residentBytes = 0;
+    VkDeviceSize requestedBytes = 0; // se todas tivessem o nível pedido
+    uint64_t upgrades = 0;
+    uint64_t downgrades = 0;
+};
+
+// Cache de texturas carregadas (não confundir com o .ktx2 em disco)
+struct TextureCacheStats {
+    uint64_t hits = 0;        // caminho já no cache
+    uint64_t misses = 0;      // carga nova
+    uint64_t contentHits = 0; // caminho novo com o mesmo conteúdo de outra textura: os materiais passam a usar ela
+    uint64_t evictions = 0;   // sem referência e acima do teto
+    uint32_t textures = 0;
+    uint32_t referenced = 0;  // seguradas por algum material (ou carga, ou recarga pendente)
+    VkDeviceSize bytes = 0;
+};
 
 class TextureManager {
 public:
     explicit TextureManager(VulkanCore* core);
     ~TextureManager();
 
-    std::shared_ptr<Texture> loadTexture(const std::string& path);
+    // Devolve na hora uma textura com um placeholder 1x1 neutro para o uso; a decodificação roda nos
+    // workers e update() troca a imagem. Pedidos pelo mesmo arquivo (caminho canônico) devolvem a mesma
+    // textura; caminhos diferentes com o mesmo conteúdo viram uma só quando o hash sai do worker.
+    // Com BC disponível, lê path + ".ktx2" (já comprimido e com mips); se o cache não existir ou for
+    // mais antigo que o arquivo, decodifica, comprime e grava o cache antes
+    std::shared_ptr<Texture> loadTexture(const std::string& path, TextureUsage usage = TextureUsage::Color);
+    // Uma vez por frame, depois da fence: cargas terminadas entram no lote de uploads e os materiais
+    // (ou o set bindless) passam a apontar para a imagem real; depois, o streaming dos mips
+    void update();
+    // Chamado pelo prepareFrame para cada draw visível: uvPerPixel é quanto de UV um pixel cobre no
+    // ponto mais próximo do mesh (0 = desconhecido, pede o nível 0)
+    void requestMips(const MaterialComponent& material, float uvPerPixel);
+    // Teto do cache: acima dele, texturas que só o cache segura saem da menos para a mais recentemente
+    // usada (0 = nenhuma fica sem referência). As referenciadas nunca saem.
+    void setCacheBudget(VkDeviceSize bytes) { cacheBudget = bytes; }
+    VkDeviceSize getCacheBudget() const { return cacheBudget; }
+    const TextureCacheStats& getCacheStats() const { return cacheStats; }
+    TextureStreamingSettings& getStreamingSettings() { return streamingSettings; }
+    const TextureStreamingStats& getStreamingStats() const { return streamingStats; }
+    // Bloqueia até os workers terminarem e aplica o resultado (headless, antes de medir)
+    void waitForLoads();
+    const TextureLoadProgress& getLoadProgress() const { return loadProgress; }
+    bool isLoading() const { return loadProgress.pending() > 0; }
+    uint32_t getWorkerCount() const;
+    // 1x1 compartilhados (um por cor, no cache): mapas ausentes usam o branco e o valor vem dos fatores do material
     std::shared_ptr<Texture> createSolidColorTexture(const glm::vec4& color);
+    std::shared_ptr<Texture> getWhiteTexture() { return createSolidColorTexture(glm::vec4(1.0f)); }
+    // Normal (0,0,1) em UNORM, também compartilhada
     std::shared_ptr<Texture> createDefaultNormalTexture();
     void cleanup();
 
+    // Troca a imagem por um 1x1 com a cor média (só texturas carregadas de arquivo); devolve os bytes liberados
+    VkDeviceSize evictTexture(Texture& texture);
+    // Recarrega do disco (do cache .ktx2 se a textura for comprimida) a imagem de uma textura despejada
+    bool restoreTexture(Texture& texture);
+
+    const std::unordered_map<std::string, std::shared_ptr<Texture>>& getTextures() const { return textureCache; }
+
+    // Pixels RGBA8 gerados pelo chamador (sem arquivo: nunca despejada); fica no cache com o nome dado
+    std::shared_ptr<Texture> createTexture(const std::string& name, const void* pixels, uint32_t width, uint32_t height,
+                                           VkFormat format = VK_FORMAT_R8G8B8A8_SRGB);
+
+    // Cadeia completa de mips nas texturas criadas daqui em diante (desligar só para comparação)
+    void setMipmapsEnabled(bool enabled) { mipmapsEnabled = enabled; }
+    bool isMipmapsEnabled() const { return mipmapsEnabled; }
+
+    // Texturas de até PACK_MAX_SIZE criadas daqui em diante vão para camadas de arrays compartilhados
+    // (TextureArrayPool) em vez de uma imagem cada; ficam fora do streaming e do despejo
+    static constexpr uint32_t PACK_MAX_SIZE = 256;
+    void setPackingEnabled(bool enabled) { packingEnabled = enabled; }
+    bool isPackingEnabled() const { return packingEnabled; }
+    TextureArrayStats getArrayStats() const { return arrays->getStats(); }
+
+    // Sem textureCompressionBC no device, loadTexture continua em RGBA8
+    bool isCompressionSupported() const;
+    uint32_t getCookedCount() const { return cookedCount; }
+    uint32_t getCacheHitCount() const { return cacheHitCount; }
+
+    // Um .ktx2 por uso: a mesma fonte como cor e como normal/dados vira formatos diferentes
+    static std::string CookedPath(const std::string& path, TextureUsage usage);
+    // Absoluto, normalizado e com "/"
+    static std::string CanonicalPath(const std::string& path);
+    // Chave do cache: caminho canônico mais o uso (sRGB e linear são texturas diferentes)
+    static std::string CacheKey(const std::string& canonicalPath, TextureUsage usage);
+
 private:
+    // Uma carga em andamento; os campos de saída só são lidos depois que o worker a publica
+    struct PendingLoad {
+        std::shared_ptr<Texture> texture; // só a thread principal mexe
+        std::string path;
+        std::string key; // no cache (vazia no streaming)
+        TextureUsage usage = TextureUsage::Color;
+        bool mipmaps = true;
+        bool compressed = false;
+        bool stream = false;       // níveis de uma textura já carregada (só lê o .ktx2)
+        bool pack = false;         // pequena: cadeia inteira numa camada de array
+        uint32_t maxDimension = 0; // só os níveis com o maior lado até isto (0 = todos)
+        int64_t byteDelta = 0;     // streaming: tamanho novo menos o atual
+        uint64_t contentHash = 0;  // do arquivo lido (0 = sem arquivo)
+
+        bool failed = false;
+        Ktx2Image image; // BCn com mips ou, sem compressão, só o nível 0 em RGBA8
+    };
+
+    // Roda num worker: nada de Vulkan aqui
+    void decodeTexture(PendingLoad& load);
+
+    // Imagem + view com os dados de data (RGBA8), enviados pelo lote de uploads. Com mips, os níveis são
+    // gerados por blit na GPU quando o formato permite e, senão, na CPU (MipmapGenerator)
+    void createTextureImage(Texture& texture, const void* data, VkDeviceSize size,
+                            uint32_t width, uint32_t height, VkFormat format);
+
+    // Cache válido (mais novo que a fonte, formato e mips esperados) ou um novo, comprimido aqui;
+    // com maxDimension, só os níveis que cabem nele ficam em image
+    bool prepareCompressed(const std::string& path, TextureUsage usage, bool mipmaps, Ktx2Image& image,
+                           uint32_t maxDimension = 0);
+    void cookTexture(const std::string& path, TextureUsage usage, bool mipmaps, Ktx2Image& image);
+    void createCompressedImage(Texture& texture, const Ktx2Image& image);
+    // Cadeia inteira (BCn) ou só o nível 0 (RGBA8, mips gerados na CPU) numa camada do TextureArrayPool
+    void packTexture(Texture& texture, const Ktx2Image& image);
+    bool canPack(uint32_t width, uint32_t height, VkFormat format) const;
+    void createSampler(Texture& texture);
+
+    void trimCache();
+    // Tira do cache e destrói pela fila de destruição; quem ainda segura o ponteiro fica com uma view inválida
+    void dropTexture(const std::string& key);
+    // Materiais da cena que usam from passam a usar to (sets ou entradas bindless reescritos)
+    void replaceInMaterials(const std::shared_ptr<Texture>& from, const std::shared_ptr<Texture>& to);
+    VkDeviceSize textureBytes(const Texture& texture) const;
+
+    void updateStreaming();
+    void submitStreamJob(const std::shared_ptr<Texture>& texture, uint32_t mip);
+    void finishStreamJob(PendingLoad& load);
+    // Bytes da imagem com os níveis [firstMip, fullMipLevels)
+    VkDeviceSize streamedSize(const Texture& texture, uint32_t firstMip) const;
+    uint32_t baseMip(const Texture& texture) const;
+
     std::shared_ptr<Texture> createTextureFromData(
         const void* data, 
         VkDeviceSize size,
@@ -29,5 +194,24 @@ private:
     );
 
     VulkanCore* vulkanCore;
+    bool mipmapsEnabled = true;
+    bool packingEnabled = true;
+    std::atomic<uint32_t> cookedCount{0};
+    std::atomic<uint32_t> cacheHitCount{0};
     std::unordered_map<std::string, std::shared_ptr<Texture>> textureCache;
+    std::unordered_map<std::string, std::string> pathAliases; // chave → chave com o mesmo conteúdo
+    std::unordered_map<uint64_t, std::string> contentIndex;   // hash do conteúdo e do uso → chave
+    VkDeviceSize cacheBudget = 512ull * 1024 * 1024;
+    TextureCacheStats cacheStats;
+
+    std::unique_ptr<TextureArrayPool> arrays;
+    std::unique_ptr<WorkerPool> workers;
+    std::mutex finishedMutex;
+    std::vector<std::shared_ptr<PendingLoad>> finishedLoads;
+    TextureLoadProgress loadProgress;
+
+    TextureStreamingSettings streamingSettings;
+    TextureStreamingStats streamingStats;
+    uint64_t streamingFrame = 0;
+    int64_t streamingPendingBytes = 0; // variação de tamanho das leituras em andamento
 };
\ No newline at end of file
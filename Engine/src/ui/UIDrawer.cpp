@@ -2,12 +2,27 @@
 #include "../ecs/Entity.h"
 #include "../core/VulkanCore.h"
 #include "../core/VulkanPipeline.h"
+#include "../core/VulkanDescriptor.h"
+#include "../core/VulkanOcclusion.h"
+#include "../core/VulkanBindless.h"
+#include "../core/VulkanProfiler.h"
+#include "../core/VulkanPipelineCache.h"
+#include "../core/VulkanUploadContext.h"
+#include "../core/VulkanMeshPool.h"
+#include "../core/VulkanResidency.h"
+#include "../core/VulkanDeletionQueue.h"
+#include "../core/CpuProfiler.h"
+#include "../core/RenderCounters.h"
+#include "../core/RenderGraph.h"
+#include "../VulkanRenderer.h"
 #include "../project/projectManagment.h"
 #include "Scene.h"
 #include <managers/FileManager.h>
 #include <ecs/components/TransformComponent.h>
 #include <ecs/components/LightComponent.h>
 #include <iostream>
+#include <algorithm>
+#include <magic_enum.hpp>
 #include <boost/hana.hpp>
 #include "ImGuiFileDialog.h"
 #include <core/VulkanImGui.h>
@@ -50,6 +65,13 @@ void UIDrawer::drawMainMenuBar()
             }
             ImGui::EndMenu();
         }
+        ImGui::Separator();
+        if (ImGui::BeginMenu("View"))
+        {
+            ImGui::MenuItem("Statistics", nullptr, &showStatistics);
+            ImGui::MenuItem("Debug", nullptr, &showDebugWindow);
+            ImGui::EndMenu();
+        }
         ImGui::EndMenuBar();
     }
 }
@@ -59,11 +81,13 @@ void UIDrawer::drawSceneWindow(VkDescriptorSet sceneDescriptorSet, std::shared_p
     ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
     ImGui::Begin("Scene", nullptr, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
     
-    // Obter o tamanho e posição da janela
-    ImVec2 windowPos = ImGui::GetWindowPos();
-    ImVec2 windowSize = ImGui::GetWindowSize();
-    
-    // Renderizar a textura da cena
+    // Obter o tamanho e posição da área da cena (sem a barra de título)
+    ImVec2 windowPos = ImGui::GetCursorScreenPos();
+    ImVec2 windowSize = ImGui::GetContentRegionAvail();
+
+    // A cena é renderizada no tamanho desta área vezes a escala; o ImGui estica a imagem (filtro linear)
+    core->setSceneViewportSize({static_cast<uint32_t>(std::max(1.0f, windowSize.x)),
+                                static_cast<uint32_t>(std::max(1.0f, windowSize.y))});
     ImGui::Image((ImTextureID)sceneDescriptorSet, windowSize);
     
     Scene* scene = core->getScene();
@@ -332,6 +356,296 @@ void UIDrawer::drawStatisticsWindow()
     ImGui::Begin("Statistics", &showStatistics);
     ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
     ImGui::Text("Frame Time: %.3f ms", 1000.0f / ImGui::GetIO().Framerate);
+
+    if (Scene *scene = core->getScene())
+    {
+        ImGui::Text("Triangles: %u", scene->renderSystem->getTrianglesSubmitted());
+    }
+
+    // Último frame completo; criações/destruições fora do frame aparecem no total
+    if (ImGui::CollapsingHeader("Frame Counters"))
+    {
+        for (RenderCounter counter : magic_enum::enum_values<RenderCounter>())
+        {
+            if (counter == RenderCounter::Count)
+                continue;
+
+            ImGui::Text("%s: %llu (total %llu)", std::string(magic_enum::enum_name(counter)).c_str(),
+                        static_cast<unsigned long long>(RenderCounters::get(counter)),
+                        static_cast<unsigned long long>(RenderCounters::total(counter)));
+        }
+
+        VulkanProfiler *profiler = core->getProfiler();
+        if (profiler && profiler->isPipelineStatisticsSupported())
+        {
+            const PipelineStatistics &statistics = profiler->getPipelineStatistics();
+            ImGui::Text("Input Primitives: %llu", static_cast<unsigned long long>(statistics.inputAssemblyPrimitives));
+            ImGui::Text("Vertex Invocations: %llu", static_cast<unsigned long long>(statistics.vertexInvocations));
+            ImGui::Text("Clipping Primitives: %llu", static_cast<unsigned long long>(statistics.clippingPrimitives));
+            ImGui::Text("Fragment Invocations: %llu", static_cast<unsigned long long>(statistics.fragmentInvocations));
+            ImGui::Text("Compute Invocations: %llu", static_cast<unsigned long long>(statistics.computeInvocations));
+        }
+        else
+        {
+            ImGui::TextDisabled("Pipeline statistics: pipelineStatisticsQuery not supported");
+        }
+    }
+
+    if (VulkanAllocator *allocator = core->getAllocator())
+    {
+        if (ImGui::CollapsingHeader("GPU Memory"))
+        {
+            GpuMemoryStats stats = allocator->getStats();
+            ImGui::Text("vkAllocateMemory: %u live (%u dedicated)", stats.deviceMemoryCount, stats.dedicatedCount);
+            ImGui::Text("Allocations: %u, %.2f / %.2f MB", stats.allocationCount,
+                        stats.usedBytes / (1024.0 * 1024.0), stats.reservedBytes / (1024.0 * 1024.0));
+
+            for (const GpuMemoryPoolStats &pool : stats.pools)
+            {
+                ImGui::Text("Type %u %s%s: %u blocks, %u allocs, %.2f / %.2f MB, %u free ranges, frag %.0f%%",
+                            pool.memoryType, std::string(magic_enum::enum_name(pool.kind)).c_str(),
+                            pool.hostVisible ? " (host)" : "", pool.blockCount, pool.allocationCount,
+                            pool.usedBytes / (1024.0 * 1024.0), pool.blockBytes / (1024.0 * 1024.0),
+                            pool.freeRangeCount, pool.fragmentation * 100.0f);
+            }
+
+            ImGui::Separator();
+            for (size_t i = 0; i < stats.categoryBytes.size(); i++)
+            {
+                ImGui::Text("%s: %llu resources, %.2f MB", std::string(magic_enum::enum_name(static_cast<GpuMemoryCategory>(i))).c_str(),
+                            static_cast<unsigned long long>(stats.categoryCounts[i]), stats.categoryBytes[i] / (1024.0 * 1024.0));
+            }
+
+            // Com VK_EXT_memory_budget, usage - tracked é o que não passa pelo allocator (driver, backend do ImGui)
+            ImGui::Separator();
+            std::vector<GpuHeapBudget> heaps = allocator->queryBudget();
+            for (size_t i = 0; i < heaps.size(); i++)
+            {
+                const GpuHeapBudget &heap = heaps[i];
+                VkDeviceSize untracked = heap.usage > heap.tracked ? heap.usage - heap.tracked : 0;
+                ImGui::Text("Heap %zu%s: %.0f / %.0f MB (size %.0f MB), untracked %.0f MB", i, heap.deviceLocal ? " (device)" : "",
+                            heap.usage / (1024.0 * 1024.0), heap.budget / (1024.0 * 1024.0), heap.size / (1024.0 * 1024.0),
+                            untracked / (1024.0 * 1024.0));
+            }
+            if (!core->isMemoryBudgetEnabled())
+                ImGui::TextDisabled("VK_EXT_memory_budget not supported: usage is tracked allocations only");
+
+            if (VulkanResidency *residency = core->getResidency())
+            {
+                const ResidencyStats &residencyStats = residency->getStats();
+                ImGui::Separator();
+                int budgetMb = static_cast<int>(residency->getBudgetOverride() / (1024 * 1024));
+                if (ImGui::SliderInt("Budget (MB, 0 = auto)", &budgetMb, 0, 16384))
+                    residency->setBudget(static_cast<VkDeviceSize>(budgetMb) * 1024 * 1024);
+                ImGui::Text("Budget: %.0f MB, usage %.0f MB%s", residencyStats.budget / (1024.0 * 1024.0),
+                            residencyStats.usage / (1024.0 * 1024.0), residencyStats.overBudget ? " (over)" : "");
+                ImGui::Text("Evicted: %u textures, %u meshes", residencyStats.evictedTextures, residencyStats.evictedMeshes);
+                ImGui::Text("Evictions: %llu textures, %llu meshes (%llu out of memory), restores: %llu",
+                            static_cast<unsigned long long>(residencyStats.textureEvictions),
+                            static_cast<unsigned long long>(residencyStats.meshEvictions),
+                            static_cast<unsigned long long>(residencyStats.emergencyEvictions),
+                            static_cast<unsigned long long>(residencyStats.restores));
+            }
+
+            if (VulkanDeletionQueue *deletionQueue = core->getDeletionQueue())
+            {
+                DeletionQueueStats deletionStats = deletionQueue->getStats();
+                ImGui::Text("Deferred deletions: %u pending, %llu executed", deletionStats.pending,
+                            static_cast<unsigned long long>(deletionStats.executed));
+            }
+
+            if (TextureManager *textures = VulkanRenderer::getInstance().getTextureManager())
+            {
+                const TextureLoadProgress &loads = textures->getLoadProgress();
+                ImGui::Text("Texture loads: %u/%u done, %u failed (%u workers)", loads.completed, loads.requested,
+                            loads.failed, textures->getWorkerCount());
+
+                const TextureCacheStats &cache = textures->getCacheStats();
+                int cacheMb = static_cast<int>(textures->getCacheBudget() / (1024 * 1024));
+                if (ImGui::SliderInt("Texture cache (MB)", &cacheMb, 0, 8192))
+                    textures->setCacheBudget(static_cast<VkDeviceSize>(cacheMb) * 1024 * 1024);
+                ImGui::Text("Texture cache: %u textures (%u referenced), %.1f MB", cache.textures, cache.referenced,
+                            cache.bytes / (1024.0 * 1024.0));
+                ImGui::Text("Hits: %llu, misses: %llu, same content: %llu, evictions: %llu",
+                            static_cast<unsigned long long>(cache.hits), static_cast<unsigned long long>(cache.misses),
+                            static_cast<unsigned long long>(cache.contentHits),
+                            static_cast<unsigned long long>(cache.evictions));
+
+                TextureStreamingSettings &streamingSettings = textures->getStreamingSettings();
+                const TextureStreamingStats &streaming = textures->getStreamingStats();
+                ImGui::Checkbox("Mip streaming", &streamingSettings.enabled);
+                int streamingMb = static_cast<int>(streamingSettings.budget / (1024 * 1024));
+                if (ImGui::SliderInt("Streaming budget (MB)", &streamingMb, 16, 8192))
+                    streamingSettings.budget = static_cast<VkDeviceSize>(streamingMb) * 1024 * 1024;
+                ImGui::SliderFloat("Mip bias", &streamingSettings.mipBias, -2.0f, 4.0f);
+                ImGui::Text("Streamed: %u textures, %.1f MB resident (%.1f MB requested), %u starved, %u reads",
+                            streaming.streamedTextures, streaming.residentBytes / (1024.0 * 1024.0),
+                            streaming.requestedBytes / (1024.0 * 1024.0), streaming.starvedTextures, streaming.jobsInFlight);
+                ImGui::Text("Mip upgrades: %llu, downgrades: %llu", static_cast<unsigned long long>(streaming.upgrades),
+                            static_cast<unsigned long long>(streaming.downgrades));
+
+                const TextureArrayStats arrayStats = textures->getArrayStats();
+                ImGui::Text("Texture arrays: %u (%u/%u layers, %.1f MB)", arrayStats.arrayCount, arrayStats.usedLayers,
+                            arrayStats.layerCapacity, arrayStats.bytes / (1024.0 * 1024.0));
+            }
+        }
+    }
+
+    if (VulkanMeshPool *meshPool = core->getMeshPool())
+    {
+        if (ImGui::CollapsingHeader("Mesh Pool"))
+        {
+            MeshPoolStats stats = meshPool->getStats();
+            ImGui::Text("Pages: %u, meshes: %u", stats.pageCount, stats.meshCount);
+            ImGui::Text("Vertices: %llu / %llu", static_cast<unsigned long long>(stats.vertexUsed),
+                        static_cast<unsigned long long>(stats.vertexCapacity));
+            ImGui::Text("Indices: %llu / %llu", static_cast<unsigned long long>(stats.indexUsed),
+                        static_cast<unsigned long long>(stats.indexCapacity));
+            ImGui::Text("Fragmentation: %.0f%%", stats.fragmentation * 100.0f);
+            ImGui::Text("Compactions: %u (%.2f MB moved)", stats.compactions, stats.compactedBytes / (1024.0 * 1024.0));
+            if (ImGui::Button("Defragment"))
+                meshPool->requestDefragment();
+        }
+    }
+
+    if (VulkanUploadContext *uploads = core->getUploadContext())
+    {
+        const UploadStats &stats = uploads->getStats();
+        if (ImGui::CollapsingHeader("Uploads"))
+        {
+            ImGui::Text("Queue: %s", stats.dedicatedTransferQueue ? "dedicated transfer" : "graphics");
+            ImGui::Text("Batches: %llu submitted, %u in flight", static_cast<unsigned long long>(stats.submittedBatches),
+                        stats.inFlightBatches);
+            ImGui::Text("Uploaded: %.2f MB", stats.uploadedBytes / (1024.0 * 1024.0));
+            ImGui::Text("Staging ring: %.2f / %.2f MB, %u stalls", stats.stagingUsed / (1024.0 * 1024.0),
+                        stats.stagingCapacity / (1024.0 * 1024.0), stats.stallCount);
+        }
+    }
+
+    if (VulkanPipelineCache *pipelineCache = core->getPipelineCache())
+    {
+        const PipelineCacheStats &stats = pipelineCache->getStats();
+        if (ImGui::CollapsingHeader("Pipeline Cache"))
+        {
+            ImGui::Text("Pipelines: %u (hits %u, misses %u)", stats.pipelineCount, stats.hits, stats.misses);
+            ImGui::Text("Pipeline Layouts: %u", stats.pipelineLayoutCount);
+            ImGui::Text("Set Layouts: %u", stats.setLayoutCount);
+            ImGui::Text("Shader Modules: %u", stats.shaderModuleCount);
+            ImGui::Text("VkPipelineCache: %s (%zu bytes loaded, %zu saved)", stats.warmStart ? "warm" : "cold",
+                        stats.loadedBytes, stats.savedBytes);
+            ImGui::Text("Compiled: %u pipelines in %.2f ms", stats.compiledPipelines, stats.compileMs);
+            if (ImGui::Button("Save Pipeline Cache"))
+                pipelineCache->save();
+        }
+    }
+
+    if (VulkanOcclusion *occlusion = core->getOcclusion())
+    {
+        const OcclusionStats &stats = occlusion->getStats();
+
+        ImGui::Separator();
+        ImGui::Text("Occlusion: %s", std::string(magic_enum::enum_name(occlusion->getMode())).c_str());
+        ImGui::Text("Prepass Draws: %u", stats.prepassDraws);
+        ImGui::Text("Color Draws: %u", stats.colorDraws);
+        ImGui::Text("Objects Tested: %u", stats.objectsTested);
+        ImGui::Text("Objects Occluded: %u", stats.objectsOccluded);
+
+        if (stats.overdrawAvailable)
+        {
+            ImGui::Text("Samples Shaded: %llu", static_cast<unsigned long long>(stats.samplesShaded));
+            ImGui::Text("Overdraw: %.2fx", stats.overdraw);
+        }
+        else
+        {
+            ImGui::TextDisabled("Overdraw: occlusionQueryPrecise not supported");
+        }
+    }
+
+    if (VulkanBindless *bindless = core->getBindless())
+    {
+        ImGui::Separator();
+        if (bindless->isEnabled())
+        {
+            const BindlessStats &stats = bindless->getStats();
+            ImGui::Text("Bindless Textures: %u / %u", stats.textureCount, stats.textureCapacity);
+            ImGui::Text("Bindless Materials: %u / %u", stats.materialCount, stats.materialCapacity);
+        }
+        else
+        {
+            ImGui::TextDisabled("Bindless: descriptor indexing not supported");
+        }
+    }
+
+    if (VulkanDescriptor *descriptor = core->getDescriptor())
+    {
+        ImGui::Text("Material parameters: %u / %u, samplers: %u", descriptor->getMaterialCount(),
+                    VulkanDescriptor::MAX_MATERIALS, core->getSamplerCount());
+    }
+
+    if (RenderGraph *graph = core->getRenderGraph())
+    {
+        const RenderGraphStats &stats = graph->getStats();
+        const float toMiB = 1.0f / (1024.0f * 1024.0f);
+
+        ImGui::Separator();
+        ImGui::Text("Render Graph Passes: %u (%u culled)", stats.passCount, stats.culledPassCount);
+        ImGui::Text("Barriers: %u", stats.barrierCount);
+        ImGui::Text("Transient Images: %u in %u blocks", stats.transientImageCount, stats.memoryBlockCount);
+        ImGui::Text("Transient Memory: %.2f MiB (%.2f MiB without aliasing)",
+                    stats.transientAllocated * toMiB, stats.transientRequested * toMiB);
+
+        for (const auto &pass : graph->getPasses())
+        {
+            if (pass->isCulled())
+                ImGui::TextDisabled("  %s (culled)", pass->getName().c_str());
+            else
+                ImGui::Text("  %s", pass->getName().c_str());
+        }
+    }
+
+    if (VulkanProfiler *profiler = core->getProfiler())
+    {
+        ImGui::Separator();
+        if (profiler->isSupported())
+        {
+            const float cpuFrameTime = 1000.0f / ImGui::GetIO().Framerate;
+            const float gpuFrameTime = profiler->getFrameTime();
+
+            // A GPU ocupando quase todo o intervalo entre frames indica gargalo na GPU
+            ImGui::Text("GPU Frame Time: %.3f ms (%s)", gpuFrameTime,
+                        gpuFrameTime >= cpuFrameTime * 0.9f ? "GPU bound" : "CPU bound");
+
+            const std::deque<float> &history = profiler->getFrameHistory();
+            if (!history.empty())
+            {
+                std::vector<float> values(history.begin(), history.end());
+                float maxValue = *std::max_element(values.begin(), values.end());
+                ImGui::PlotLines("##GpuFrameHistory", values.data(), static_cast<int>(values.size()), 0,
+                                 "GPU ms", 0.0f, maxValue * 1.2f, ImVec2(0, 60));
+            }
+
+            // Barra proporcional ao frame inteiro para cada pass/escopo
+            for (const auto &timing : profiler->getTimings())
+            {
+                if (timing.depth == 0)
+                    continue;
+
+                char overlay[64];
+                snprintf(overlay, sizeof(overlay), "%.3f ms", timing.milliseconds);
+
+                ImGui::Indent(12.0f * timing.depth);
+                ImGui::ProgressBar(gpuFrameTime > 0.0f ? timing.milliseconds / gpuFrameTime : 0.0f,
+                                   ImVec2(140, 0), overlay);
+                ImGui::SameLine();
+                ImGui::Text("%s", timing.name.c_str());
+                ImGui::Unindent(12.0f * timing.depth);
+            }
+        }
+        else
+        {
+            ImGui::TextDisabled("GPU Timings: timestamp queries not supported");
+        }
+    }
     ImGui::End();
 }
 
@@ -349,6 +663,72 @@ void UIDrawer::drawDebugWindow()
         core->getPipeline()->setWireframeMode(wireframeMode);
     }
 
+    if (VulkanOcclusion *occlusion = core->getOcclusion())
+    {
+        const char *modes[] = {"Off", "Depth Prepass", "Depth Prepass + Hi-Z"};
+        int currentMode = static_cast<int>(occlusion->getMode());
+        if (ImGui::Combo("Occlusion", &currentMode, modes, IM_ARRAYSIZE(modes)))
+        {
+            occlusion->setMode(static_cast<OcclusionMode>(currentMode));
+        }
+        ImGui::Text("Hi-Z Levels: %u", occlusion->getHiZMipLevels());
+    }
+
+    if (Scene *scene = core->getScene())
+    {
+        auto &lod = scene->renderSystem->getLodSettings();
+        ImGui::Separator();
+        ImGui::Checkbox("Mesh LOD", &lod.enabled);
+        ImGui::SliderFloat("LOD Pixel Error", &lod.pixelErrorThreshold, 0.1f, 16.0f, "%.1f px");
+        ImGui::SliderFloat("LOD Hysteresis", &lod.hysteresis, 0.0f, 0.9f);
+        ImGui::SliderInt("Forced LOD", &lod.forcedLod, -1, 3);
+    }
+
+    ImGui::Separator();
+    float renderScale = core->getRenderScale();
+    DynamicResolutionSettings &dynamicResolution = core->getDynamicResolution();
+    ImGui::BeginDisabled(dynamicResolution.enabled);
+    if (ImGui::SliderFloat("Render Scale", &renderScale, 0.25f, 2.0f, "%.2fx"))
+    {
+        core->setRenderScale(renderScale);
+    }
+    ImGui::EndDisabled();
+    ImGui::Checkbox("Dynamic Resolution", &dynamicResolution.enabled);
+    if (dynamicResolution.enabled)
+    {
+        ImGui::SliderFloat("Target GPU Time", &dynamicResolution.targetGpuMs, 4.0f, 33.3f, "%.1f ms");
+        ImGui::DragFloatRange2("Scale Range", &dynamicResolution.minScale, &dynamicResolution.maxScale, 0.01f, 0.25f, 2.0f, "%.2fx");
+    }
+    VkExtent2D sceneExtent = core->getSceneExtent();
+    ImGui::Text("Scene Resolution: %ux%u (%.2fx)", sceneExtent.width, sceneExtent.height, core->getRenderScale());
+
+    ImGui::Separator();
+#ifdef ENGINE_PROFILING
+    static float traceSeconds = 5.0f;
+    static std::string traceStatus;
+    ImGui::SliderFloat("Trace Seconds", &traceSeconds, 1.0f, 30.0f, "%.0f s");
+    if (ImGui::Button("Capture CPU Trace"))
+    {
+        // Abrir em chrome://tracing ou ui.perfetto.dev
+        try
+        {
+            size_t events = CpuProfiler::captureTrace("cpu_trace.json", traceSeconds);
+            traceStatus = "cpu_trace.json: " + std::to_string(events) + " zones";
+        }
+        catch (const std::exception &e)
+        {
+            traceStatus = e.what();
+        }
+    }
+    if (!traceStatus.empty())
+    {
+        ImGui::SameLine();
+        ImGui::Text("%s", traceStatus.c_str());
+    }
+#else
+    ImGui::TextDisabled("CPU Trace: profiling disabled in this build");
+#endif
+
     ImGui::End();
 }
 
@@ -543,7 +923,9 @@ void UIDrawer::DrawEntityNode(std::shared_ptr<Entity> &selectedEntity, std::shar
     {
         if (ImGui::MenuItem("Delete"))
         {
-            // core->getScene()->removeEntity(entity);
+            core->getScene()->destroyEntity(entity);
+            if (selectedEntity == entity)
+                selectedEntity = nullptr;
         }
         ImGui::EndPopup();
     }